@@ -0,0 +1,278 @@
+// bench.c - Timing, allocation counting and result output shared by the benchmarks
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <json-c/json.h>
+#include "bench.h"
+
+#define BENCH_MAX_BATCH (1L << 16)
+#define BENCH_MAX_RELEASE_BATCH 256  // Objects alive at once while timing releases
+
+// glibc's own allocator entry points, used by the counting wrappers below
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static long allocation_count = 0;
+static long allocation_bytes = 0;
+static long free_count = 0;
+static long live_bytes = 0;  // Usable size of every block not yet freed
+
+static void count_allocation(size_t size) {
+    __atomic_fetch_add(&allocation_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&allocation_bytes, (long)size, __ATOMIC_RELAXED);
+}
+
+static void count_live(void *ptr, long sign) {
+    if (ptr) {
+        __atomic_fetch_add(&live_bytes, sign * (long)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+}
+
+// Defined in the executable, these also catch allocations and frees made
+// inside libcurl, json-c and libc itself (strdup, etc.)
+void *malloc(size_t size) {
+    count_allocation(size);
+    void *ptr = __libc_malloc(size);
+    count_live(ptr, 1);
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    void *ptr = __libc_calloc(count, size);
+    count_live(ptr, 1);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_allocation(size);
+    long old_size = ptr ? (long)malloc_usable_size(ptr) : 0;
+    void *grown = __libc_realloc(ptr, size);
+
+    // A failed realloc leaves the block alone; realloc(ptr, 0) frees it
+    if (grown) {
+        __atomic_fetch_add(&live_bytes, (long)malloc_usable_size(grown) - old_size, __ATOMIC_RELAXED);
+    } else if (size == 0) {
+        __atomic_fetch_sub(&live_bytes, old_size, __ATOMIC_RELAXED);
+    }
+    return grown;
+}
+
+void free(void *ptr) {
+    if (ptr) {
+        __atomic_fetch_add(&free_count, 1, __ATOMIC_RELAXED);
+    }
+    count_live(ptr, -1);
+    __libc_free(ptr);
+}
+
+// Counter snapshot taken around the timed runs
+typedef struct {
+    long allocations;
+    long bytes;
+    long frees;
+} Counters;
+
+static Counters read_counters() {
+    Counters counters = {
+        __atomic_load_n(&allocation_count, __ATOMIC_RELAXED),
+        __atomic_load_n(&allocation_bytes, __ATOMIC_RELAXED),
+        __atomic_load_n(&free_count, __ATOMIC_RELAXED)
+    };
+    return counters;
+}
+
+static void set_per_op(BenchResult *result, long elapsed, Counters before, Counters after) {
+    result->ns_per_op = (double)elapsed / result->iterations;
+    result->allocs_per_op = (double)(after.allocations - before.allocations) / result->iterations;
+    result->alloc_bytes_per_op = (double)(after.bytes - before.bytes) / result->iterations;
+    result->frees_per_op = (double)(after.frees - before.frees) / result->iterations;
+}
+
+static long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Restart the kernel's peak RSS tracking (Linux 4.0+); harmless elsewhere
+static void reset_peak_rss() {
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+    if (file) {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+static long peak_rss_kb() {
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+        }
+        fclose(file);
+        if (kb >= 0) return kb;
+    }
+
+    // Process-lifetime peak when /proc is unavailable
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void bench_run(const char *name, BenchFn fn, void *ctx, long min_iterations,
+               int min_time_ms, BenchResult *result) {
+    memset(result, 0, sizeof(*result));
+    snprintf(result->name, sizeof(result->name), "%s", name);
+
+    reset_peak_rss();
+    if (!fn(ctx)) {
+        result->failures++;
+    }
+
+    long min_ns = (long)min_time_ms * 1000000L;
+    Counters before = read_counters();
+    long started = now_ns();
+    long elapsed = 0;
+
+    // Batches double until the time budget is met, so clock reads stay out of short ops
+    long batch = 1;
+    for (;;) {
+        for (long i = 0; i < batch; i++) {
+            if (!fn(ctx)) {
+                result->failures++;
+            }
+        }
+        result->iterations += batch;
+        elapsed = now_ns() - started;
+
+        bool enough_time = elapsed >= min_ns;
+        if (enough_time && result->iterations >= min_iterations) break;
+
+        if (enough_time) {
+            batch = min_iterations - result->iterations;
+        } else if (batch < BENCH_MAX_BATCH) {
+            batch *= 2;
+        }
+    }
+
+    set_per_op(result, elapsed, before, read_counters());
+    result->peak_rss_kb = peak_rss_kb();
+}
+
+void bench_run_release(const char *name, BenchBuildFn build, BenchReleaseFn release, void *ctx,
+                       long min_iterations, int min_time_ms, BenchResult *result) {
+    memset(result, 0, sizeof(*result));
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    reset_peak_rss();
+
+    long min_ns = (long)min_time_ms * 1000000L;
+    long elapsed = 0;
+    Counters totals = { 0, 0, 0 };
+    long retained = 0;
+
+    void **objects = NULL;
+    long capacity = 0;
+    long batch = 1;
+    for (;;) {
+        if (batch > capacity) {
+            capacity = batch;
+            objects = realloc(objects, capacity * sizeof(void*));
+            if (!objects) {
+                fprintf(stderr, "Out of memory in %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        long live_before = __atomic_load_n(&live_bytes, __ATOMIC_RELAXED);
+        for (long i = 0; i < batch; i++) {
+            objects[i] = build(ctx);
+            if (!objects[i]) result->failures++;
+        }
+        retained += __atomic_load_n(&live_bytes, __ATOMIC_RELAXED) - live_before;
+
+        Counters before = read_counters();
+        long started = now_ns();
+        for (long i = 0; i < batch; i++) {
+            if (objects[i]) release(objects[i]);
+        }
+        elapsed += now_ns() - started;
+        Counters after = read_counters();
+
+        totals.allocations += after.allocations - before.allocations;
+        totals.bytes += after.bytes - before.bytes;
+        totals.frees += after.frees - before.frees;
+        result->iterations += batch;
+
+        bool enough_time = elapsed >= min_ns;
+        if (enough_time && result->iterations >= min_iterations) break;
+
+        if (enough_time) {
+            batch = min_iterations - result->iterations;
+        } else if (batch < BENCH_MAX_RELEASE_BATCH) {
+            batch *= 2;
+        }
+        if (batch > BENCH_MAX_RELEASE_BATCH) batch = BENCH_MAX_RELEASE_BATCH;
+    }
+    free(objects);
+
+    Counters zero = { 0, 0, 0 };
+    set_per_op(result, elapsed, zero, totals);
+    result->retained_bytes_per_op = (double)retained / result->iterations;
+    result->peak_rss_kb = peak_rss_kb();
+}
+
+void bench_print_header() {
+    printf("%-44s %9s %13s %11s %12s %10s %12s %9s %5s\n", "case", "iters", "ns/op",
+           "allocs/op", "bytes/op", "frees/op", "kept/op", "peak_kb", "fail");
+}
+
+void bench_print(const BenchResult *result) {
+    printf("%-44s %9ld %13.0f %11.1f %12.0f %10.1f %12.0f %9ld %5ld\n", result->name,
+           result->iterations, result->ns_per_op, result->allocs_per_op,
+           result->alloc_bytes_per_op, result->frees_per_op, result->retained_bytes_per_op,
+           result->peak_rss_kb, result->failures);
+    fflush(stdout);
+}
+
+bool bench_write_json(const char *path, const char *suite, const BenchResult *results, int count) {
+    struct json_object *root = json_object_new_object();
+    const char *commit = getenv("BENCH_COMMIT");
+
+    json_object_object_add(root, "suite", json_object_new_string(suite));
+    json_object_object_add(root, "commit", json_object_new_string(commit ? commit : "unknown"));
+    json_object_object_add(root, "timestamp", json_object_new_int64((long long)time(NULL)));
+
+    struct json_object *array = json_object_new_array();
+    for (int i = 0; i < count; i++) {
+        const BenchResult *result = &results[i];
+        struct json_object *entry = json_object_new_object();
+        json_object_object_add(entry, "name", json_object_new_string(result->name));
+        json_object_object_add(entry, "iterations", json_object_new_int64(result->iterations));
+        json_object_object_add(entry, "failures", json_object_new_int64(result->failures));
+        json_object_object_add(entry, "ns_per_op", json_object_new_double(result->ns_per_op));
+        json_object_object_add(entry, "allocs_per_op", json_object_new_double(result->allocs_per_op));
+        json_object_object_add(entry, "alloc_bytes_per_op", json_object_new_double(result->alloc_bytes_per_op));
+        json_object_object_add(entry, "frees_per_op", json_object_new_double(result->frees_per_op));
+        json_object_object_add(entry, "retained_bytes_per_op", json_object_new_double(result->retained_bytes_per_op));
+        json_object_object_add(entry, "peak_rss_kb", json_object_new_int64(result->peak_rss_kb));
+        json_object_object_add(entry, "output_bytes_per_op", json_object_new_double(result->output_bytes_per_op));
+        json_object_array_add(array, entry);
+    }
+    json_object_object_add(root, "results", array);
+
+    bool ok = json_object_to_file_ext(path, root, JSON_C_TO_STRING_PRETTY) == 0;
+    json_object_put(root);
+    if (!ok) {
+        fprintf(stderr, "Failed to write benchmark results to %s\n", path);
+    }
+    return ok;
+}
@@ -0,0 +1,69 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+#define BENCH_NAME_MAX 96
+
+// Measurements of one benchmark case
+typedef struct {
+    char name[BENCH_NAME_MAX];
+    long iterations;
+    long failures;
+    double ns_per_op;
+    double allocs_per_op;
+    double alloc_bytes_per_op;
+    double frees_per_op;
+    long peak_rss_kb;
+    double retained_bytes_per_op; // Heap held by each built object, filled in by release benchmarks
+    double output_bytes_per_op; // Terminal output, filled in by benches that draw
+} BenchResult;
+
+// Operation under test; return false to count the run as failed
+typedef bool (*BenchFn)(void *ctx);
+
+// Builds an object for a release benchmark (NULL counts as a failure)
+typedef void* (*BenchBuildFn)(void *ctx);
+
+// Releases an object made by a BenchBuildFn
+typedef void (*BenchReleaseFn)(void *object);
+
+/**
+ * Measure an operation
+ * Runs it once to warm up, then repeats it until both min_iterations and
+ * min_time_ms are reached. Allocations are counted process-wide through
+ * the bench binary's malloc wrappers. The peak RSS high-water mark is reset
+ * first, so it covers this case plus whatever the allocator kept from earlier ones.
+ * @param name Case name, e.g. "zoro_anime_info/typical/convert"
+ * @param fn Operation to run
+ * @param ctx Passed to fn
+ * @param min_iterations Minimum number of timed runs
+ * @param min_time_ms Minimum total time of the timed runs (0 for a fixed count)
+ * @param result Receives the measurements
+ */
+void bench_run(const char *name, BenchFn fn, void *ctx, long min_iterations,
+               int min_time_ms, BenchResult *result);
+
+/**
+ * Measure only the release of objects
+ * Objects are built in untimed batches; only the release calls are timed.
+ * The heap still in use after each batch is built, less what was in use
+ * before, gives retained_bytes_per_op. Otherwise behaves like bench_run.
+ */
+void bench_run_release(const char *name, BenchBuildFn build, BenchReleaseFn release, void *ctx,
+                       long min_iterations, int min_time_ms, BenchResult *result);
+
+// Print the table header and one row per result to stdout
+void bench_print_header();
+void bench_print(const BenchResult *result);
+
+/**
+ * Write results as JSON so runs can be compared between commits
+ * The commit is taken from $BENCH_COMMIT when set.
+ * @param path Output file
+ * @param suite Suite name stored alongside the results
+ * @return true if the file was written
+ */
+bool bench_write_json(const char *path, const char *suite, const BenchResult *results, int count);
+
+#endif /* BENCH_H */
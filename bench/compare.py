@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Compare two benchmark result files written by the bench binaries.
+
+Cases are matched by name. Exits with status 1 when any case got slower,
+allocates more, keeps more memory alive, or sends more to the terminal, by
+more than --threshold percent.
+
+    python3 bench/compare.py old/parse.json bench-results/parse.json
+"""
+
+import argparse
+import json
+import sys
+
+METRICS = [("ns_per_op", "ns/op"), ("allocs_per_op", "allocs/op"), ("frees_per_op", "frees/op"),
+           ("retained_bytes_per_op", "kept_bytes/op"), ("peak_rss_kb", "peak_kb"),
+           ("output_bytes_per_op", "out_bytes/op")]
+GATED = {"ns_per_op", "allocs_per_op", "retained_bytes_per_op", "output_bytes_per_op"}
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get("commit", "unknown"), {r["name"]: r for r in data["results"]}
+
+
+def change(old, new):
+    if old == 0:
+        return 0.0 if new == 0 else float("inf")
+    return (new - old) * 100.0 / old
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed regression in percent (default 10)")
+    options = parser.parse_args()
+
+    old_commit, old = load(options.baseline)
+    new_commit, new = load(options.current)
+    print("%s -> %s" % (old_commit, new_commit))
+    print("%-40s " % "case" + " ".join("%24s" % label for _, label in METRICS))
+
+    regressions = []
+    for name in sorted(set(old) & set(new)):
+        cells = []
+        for key, label in METRICS:
+            before, after = old[name].get(key, 0), new[name].get(key, 0)
+            delta = change(before, after)
+            cells.append("%12.1f %+10.1f%%" % (after, delta))
+            if key in GATED and delta > options.threshold:
+                regressions.append("%s %s %+.1f%%" % (name, label, delta))
+        print("%-40s " % name + " ".join(cells))
+
+    for name in sorted(set(new) - set(old)):
+        print("%-40s (new)" % name)
+    for name in sorted(set(old) - set(new)):
+        print("%-40s (removed)" % name)
+
+    if regressions:
+        print("\nregressions over %.0f%%:" % options.threshold)
+        for line in regressions:
+            print("  " + line)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
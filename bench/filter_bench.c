@@ -0,0 +1,195 @@
+// filter_bench.c - Microbenchmarks of the selection screens' title matching
+//
+// A federated-size title list is generated in memory and every query is
+// measured four ways: "strstr" scans every title with the old
+// case_insensitive_strstr, "fuzzy-unindexed" folds and masks each title
+// before matching it, "fuzzy" matches against the prepared index the way
+// the filter does after each result arrives, and "typing" feeds the query
+// to a TitleFilter one keystroke at a time (narrowing and ranking included)
+// before clearing it again. "index" measures building the filter's index.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/ui/common/filter.h"
+#include "../src/utils/fuzzy.h"
+#include "../src/utils/string.h"
+
+#define BENCH_DEFAULT_MIN_TIME_MS 200
+#define BENCH_DEFAULT_OUTPUT "bench-filter.json"
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MAX_CASES 32
+#define BENCH_TITLES 20000
+
+// Queries from common to absent; "nrt sppdn" only matches fuzzily
+static const char *queries[] = { "naruto", "shippuden movie", "nrt sppdn", "zzz" };
+
+typedef struct {
+    SearchResult results;
+    char **folded;
+    size_t *lengths;
+    uint64_t *masks;
+    const char *query;
+    TitleFilter *filter;
+} Fixture;
+
+static const char *words[] = {
+    "Naruto", "Shippuden", "One", "Piece", "Attack", "on", "Titan", "Bleach",
+    "Dragon", "Ball", "Super", "Hunter", "x", "Jujutsu", "Kaisen", "Movie",
+    "Season", "The", "Final", "Chapter", "Boruto", "Next", "Generations", "OVA"
+};
+
+static void build_fixture(Fixture *fixture) {
+    int words_count = sizeof(words) / sizeof(words[0]);
+    fixture->results.total_results = BENCH_TITLES;
+    fixture->results.results = calloc(BENCH_TITLES, sizeof(SearchResultItem));
+    fixture->folded = calloc(BENCH_TITLES, sizeof(char*));
+    fixture->lengths = calloc(BENCH_TITLES, sizeof(size_t));
+    fixture->masks = calloc(BENCH_TITLES, sizeof(uint64_t));
+    if (!fixture->results.results || !fixture->folded || !fixture->lengths || !fixture->masks) {
+        fprintf(stderr, "Out of memory building fixture\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Fixed seed so runs compare between commits
+    srand(17);
+    for (int i = 0; i < BENCH_TITLES; i++) {
+        char title[160];
+        int len = 0;
+        int count = 2 + rand() % 4;
+        for (int w = 0; w < count; w++) {
+            len += snprintf(title + len, sizeof(title) - len, "%s%s", w ? " " : "", words[rand() % words_count]);
+        }
+        snprintf(title + len, sizeof(title) - len, " %d", i);
+
+        fixture->results.results[i].title = strdup(title);
+        fixture->lengths[i] = strlen(title);
+        fixture->folded[i] = malloc(fixture->lengths[i] + 1);
+        fuzzy_fold(fixture->folded[i], title, fixture->lengths[i] + 1);
+        fixture->masks[i] = fuzzy_char_mask(fixture->folded[i], fixture->lengths[i]);
+    }
+}
+
+static bool strstr_op(void *ctx) {
+    Fixture *fixture = ctx;
+    volatile int matches = 0;
+    for (int i = 0; i < BENCH_TITLES; i++) {
+        if (case_insensitive_strstr(fixture->results.results[i].title, fixture->query)) {
+            matches++;
+        }
+    }
+    return true;
+}
+
+static bool fuzzy_unindexed_op(void *ctx) {
+    Fixture *fixture = ctx;
+    FuzzyPattern pattern;
+    fuzzy_pattern_init(&pattern, fixture->query);
+
+    char folded[160];
+    volatile int matches = 0;
+    for (int i = 0; i < BENCH_TITLES; i++) {
+        const char *title = fixture->results.results[i].title;
+        size_t len = fixture->lengths[i];
+        fuzzy_fold(folded, title, len);
+        int score;
+        if (fuzzy_match(&pattern, folded, len, fuzzy_char_mask(folded, len), &score)) {
+            matches++;
+        }
+    }
+    return true;
+}
+
+static bool fuzzy_op(void *ctx) {
+    Fixture *fixture = ctx;
+    FuzzyPattern pattern;
+    fuzzy_pattern_init(&pattern, fixture->query);
+
+    volatile int matches = 0;
+    for (int i = 0; i < BENCH_TITLES; i++) {
+        int score;
+        if (fuzzy_match(&pattern, fixture->folded[i], fixture->lengths[i], fixture->masks[i], &score)) {
+            matches++;
+        }
+    }
+    return true;
+}
+
+static bool typing_op(void *ctx) {
+    Fixture *fixture = ctx;
+    for (const char *c = fixture->query; *c; c++) {
+        title_filter_push(fixture->filter, *c);
+    }
+    bool ok = title_filter_count(fixture->filter) >= 0;
+    title_filter_clear(fixture->filter);
+    return ok;
+}
+
+static bool index_op(void *ctx) {
+    Fixture *fixture = ctx;
+    TitleFilter *filter = title_filter_new();
+    title_filter_sync(filter, &fixture->results);
+    bool ok = title_filter_count(filter) == BENCH_TITLES;
+    title_filter_free(filter);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int min_time_ms = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_MIN_TIME_MS;
+    const char *output = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    if (min_time_ms <= 0) {
+        fprintf(stderr, "usage: %s [min_time_ms] [output.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Fixture fixture = { 0 };
+    build_fixture(&fixture);
+    fixture.filter = title_filter_new();
+    title_filter_sync(fixture.filter, &fixture.results);
+
+    static const struct {
+        const char *name;
+        BenchFn fn;
+    } methods[] = {
+        { "strstr", strstr_op },
+        { "fuzzy-unindexed", fuzzy_unindexed_op },
+        { "fuzzy", fuzzy_op },
+        { "typing", typing_op }
+    };
+
+    BenchResult results[BENCH_MAX_CASES];
+    int count = 0;
+    long failures = 0;
+
+    bench_print_header();
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        fixture.query = queries[q];
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+            char name[BENCH_NAME_MAX];
+            snprintf(name, sizeof(name), "filter/%s/%s", methods[m].name, queries[q]);
+            bench_run(name, methods[m].fn, &fixture, BENCH_MIN_ITERATIONS, min_time_ms, &results[count]);
+            bench_print(&results[count]);
+            failures += results[count++].failures;
+        }
+    }
+
+    bench_run("filter/index", index_op, &fixture, BENCH_MIN_ITERATIONS, min_time_ms, &results[count]);
+    bench_print(&results[count]);
+    failures += results[count++].failures;
+
+    title_filter_free(fixture.filter);
+    for (int i = 0; i < BENCH_TITLES; i++) {
+        free(fixture.results.results[i].title);
+        free(fixture.folded[i]);
+    }
+    free(fixture.results.results);
+    free(fixture.folded);
+    free(fixture.lengths);
+    free(fixture.masks);
+
+    if (bench_write_json(output, "filter", results, count)) {
+        printf("results written to %s\n", output);
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
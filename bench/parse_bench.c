@@ -0,0 +1,288 @@
+// parse_bench.c - Microbenchmarks of the providers' JSON-to-struct conversion
+//
+// Fixtures are generated in memory at three sizes: small, typical and
+// pathological (a 1500-episode show, a 5000-chapter manga, a source list
+// with hundreds of subtitle tracks). Each fixture is measured three ways:
+// "convert" runs the provider's conversion and free on an already parsed
+// object, "decode" also includes tokenizing the response text, and
+// "release" times only the provider's free function. Release results are
+// built from the text with the parsed response dropped afterwards, as the
+// providers do, so their retained bytes show what a result keeps alive.
+// Every case runs with strings copied into the result and, suffixed
+// "-view", with Config.zero_copy_strings pointing them into the retained
+// response.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <json-c/json.h>
+#include "bench.h"
+#include "../src/config.h"
+#include "../src/api/providers/aniwatch.h"
+#include "../src/api/providers/zoro.h"
+#include "../src/api/providers/mangadex.h"
+
+#define BENCH_DEFAULT_MIN_TIME_MS 200
+#define BENCH_DEFAULT_OUTPUT "bench-parse.json"
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MAX_CASES 64
+
+typedef enum {
+    FIXTURE_ZORO_INFO,
+    FIXTURE_ANIWATCH_STREAM,
+    FIXTURE_MANGADEX_INFO
+} FixtureKind;
+
+// Sizes of one fixture tier
+typedef struct {
+    const char *name;
+    int episodes;
+    int sources;
+    int tracks;
+    int chapters;
+} FixtureSize;
+
+static const FixtureSize fixture_sizes[] = {
+    { "small", 12, 1, 3, 20 },
+    { "typical", 220, 2, 8, 300 },
+    { "pathological", 1500, 64, 400, 5000 }
+};
+
+typedef struct {
+    FixtureKind kind;
+    char *text;
+    struct json_object *json;
+} Fixture;
+
+// Growable text buffer for building fixtures
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer *buffer, const char *format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer->data + buffer->size, buffer->capacity - buffer->size, format, args);
+        va_end(args);
+
+        if (len >= 0 && buffer->size + len < buffer->capacity) {
+            buffer->size += len;
+            return;
+        }
+
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Out of memory building fixture\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static const char *lorem =
+    "Moments prior to Naruto Uzumaki's birth, a huge demon known as the Kyuubi, "
+    "the Nine-Tailed Fox, attacked Konohagakure, the Hidden Leaf Village, and wreaked havoc. "
+    "In order to put an end to the Kyuubi's rampage, the leader of the village, the Fourth "
+    "Hokage, sacrificed his life and sealed the monstrous beast inside the newborn Naruto.";
+
+static void append_genres(Buffer *buffer) {
+    buffer_append(buffer, "\"genres\":[\"Action\",\"Adventure\",\"Comedy\",\"Fantasy\","
+                          "\"Martial Arts\",\"Shounen\",\"Super Power\",\"Drama\"]");
+}
+
+static char* zoro_info_text(const FixtureSize *size) {
+    Buffer buffer = { 0 };
+    buffer_append(&buffer, "{\"id\":\"naruto-677\",\"title\":\"Naruto\","
+                           "\"url\":\"https://hianime.to/naruto-677\","
+                           "\"image\":\"https://cdn.example/naruto.jpg\","
+                           "\"description\":\"%s\",\"releaseDate\":\"2002\","
+                           "\"status\":\"Completed\",\"type\":\"TV\",", lorem);
+    append_genres(&buffer);
+    buffer_append(&buffer, ",\"episodes\":[");
+    for (int i = 1; i <= size->episodes; i++) {
+        buffer_append(&buffer, "%s{\"id\":\"naruto-677$episode$%d\",\"number\":%d,"
+                               "\"title\":\"Episode %d: The Long Road Home\","
+                               "\"isFiller\":false,\"url\":\"https://hianime.to/watch/naruto-677?ep=%d\"}",
+                      i > 1 ? "," : "", 12000 + i, i, i, 12000 + i);
+    }
+    buffer_append(&buffer, "]}");
+    return buffer.data;
+}
+
+static char* aniwatch_stream_text(const FixtureSize *size) {
+    Buffer buffer = { 0 };
+    buffer_append(&buffer, "{\"success\":true,\"data\":{\"headers\":{\"Referer\":\"https://megacloud.blog/\"},"
+                           "\"tracks\":[");
+    for (int i = 0; i < size->tracks; i++) {
+        buffer_append(&buffer, "%s{\"file\":\"https://cdn.example/subs/%04d.vtt\",\"label\":\"Language %d\","
+                               "\"kind\":\"captions\"}", i > 0 ? "," : "", i, i);
+    }
+    buffer_append(&buffer, ",{\"file\":\"https://cdn.example/thumbnails.vtt\",\"kind\":\"thumbnails\"}],"
+                           "\"intro\":{\"start\":31,\"end\":111},\"outro\":{\"start\":1330,\"end\":1420},"
+                           "\"sources\":[");
+    for (int i = 0; i < size->sources; i++) {
+        buffer_append(&buffer, "%s{\"url\":\"https://cdn.example/hls/%04d/master.m3u8\",\"type\":\"hls\"}",
+                      i > 0 ? "," : "", i);
+    }
+    buffer_append(&buffer, "],\"anilistID\":20,\"malID\":20}}");
+    return buffer.data;
+}
+
+static char* mangadex_info_text(const FixtureSize *size) {
+    Buffer buffer = { 0 };
+    buffer_append(&buffer, "{\"id\":\"a1c7c817-4e59-43b7-9365-09675a149a6f\",\"title\":\"One Piece\","
+                           "\"image\":\"https://cdn.example/one-piece.jpg\","
+                           "\"description\":{\"en\":\"%s\",\"ja\":\"%s\"},"
+                           "\"releaseDate\":1997,\"status\":\"ongoing\",", lorem, lorem);
+    append_genres(&buffer);
+    buffer_append(&buffer, ",\"chapters\":[");
+    for (int i = 1; i <= size->chapters; i++) {
+        // Every fifth chapter is untitled, as in real MangaDex feeds
+        if (i % 5 == 0) {
+            buffer_append(&buffer, "%s{\"id\":\"00000000-0000-4000-8000-%012d\",\"title\":null,"
+                                   "\"chapterNumber\":\"%d\",\"volumeNumber\":\"%d\",\"pages\":20}",
+                          i > 1 ? "," : "", i, i, i / 10 + 1);
+        } else {
+            buffer_append(&buffer, "%s{\"id\":\"00000000-0000-4000-8000-%012d\",\"title\":\"Chapter %d: Romance Dawn\","
+                                   "\"chapterNumber\":\"%d\",\"volumeNumber\":\"%d\",\"pages\":20}",
+                          i > 1 ? "," : "", i, i, i, i / 10 + 1);
+        }
+    }
+    buffer_append(&buffer, "]}");
+    return buffer.data;
+}
+
+static void* build_result(FixtureKind kind, struct json_object *json) {
+    switch (kind) {
+        case FIXTURE_ZORO_INFO:
+            return zoro_parse_anime_info(json);
+        case FIXTURE_ANIWATCH_STREAM:
+            return aniwatch_parse_episode_stream(json);
+        case FIXTURE_MANGADEX_INFO:
+            return mangadex_parse_manga_info(json, "fallback-id");
+    }
+    return NULL;
+}
+
+static void release_result(FixtureKind kind, void *result) {
+    switch (kind) {
+        case FIXTURE_ZORO_INFO:
+            zoro_free_anime_info(result);
+            break;
+        case FIXTURE_ANIWATCH_STREAM:
+            aniwatch_free_stream_info(result);
+            break;
+        case FIXTURE_MANGADEX_INFO:
+            mangadex_free_manga_info(result);
+            break;
+    }
+}
+
+// Run the provider conversion on a parsed body and release the result
+static bool convert(FixtureKind kind, struct json_object *json) {
+    void *result = build_result(kind, json);
+    release_result(kind, result);
+    return result != NULL;
+}
+
+// The release benchmark frees through the fixture currently being measured
+static FixtureKind release_kind;
+
+static void* build_op(void *ctx) {
+    Fixture *fixture = ctx;
+    struct json_object *json = json_tokener_parse(fixture->text);
+    if (!json) return NULL;
+
+    void *result = build_result(fixture->kind, json);
+    json_object_put(json);
+    return result;
+}
+
+static void release_op(void *result) {
+    release_result(release_kind, result);
+}
+
+static bool convert_op(void *ctx) {
+    Fixture *fixture = ctx;
+    return convert(fixture->kind, fixture->json);
+}
+
+static bool decode_op(void *ctx) {
+    Fixture *fixture = ctx;
+    struct json_object *json = json_tokener_parse(fixture->text);
+    if (!json) return false;
+
+    bool ok = convert(fixture->kind, json);
+    json_object_put(json);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int min_time_ms = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_MIN_TIME_MS;
+    const char *output = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    if (min_time_ms <= 0) {
+        fprintf(stderr, "usage: %s [min_time_ms] [output.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static const struct {
+        FixtureKind kind;
+        const char *name;
+        char* (*build)(const FixtureSize *size);
+    } suites[] = {
+        { FIXTURE_ZORO_INFO, "zoro_anime_info", zoro_info_text },
+        { FIXTURE_ANIWATCH_STREAM, "aniwatch_episode_stream", aniwatch_stream_text },
+        { FIXTURE_MANGADEX_INFO, "mangadex_manga_info", mangadex_info_text }
+    };
+
+    BenchResult results[BENCH_MAX_CASES];
+    int count = 0;
+    long failures = 0;
+
+    bench_print_header();
+    for (size_t s = 0; s < sizeof(suites) / sizeof(suites[0]); s++) {
+        for (size_t z = 0; z < sizeof(fixture_sizes) / sizeof(fixture_sizes[0]); z++) {
+            Fixture fixture = { suites[s].kind, suites[s].build(&fixture_sizes[z]), NULL };
+            fixture.json = json_tokener_parse(fixture.text);
+            if (!fixture.json) {
+                fprintf(stderr, "Generated %s fixture is not valid JSON\n", suites[s].name);
+                return EXIT_FAILURE;
+            }
+
+            for (int view = 0; view <= 1; view++) {
+                const char *suffix = view ? "-view" : "";
+                app_config.zero_copy_strings = view;
+
+                char name[BENCH_NAME_MAX];
+                snprintf(name, sizeof(name), "%s/%s/convert%s", suites[s].name, fixture_sizes[z].name, suffix);
+                bench_run(name, convert_op, &fixture, BENCH_MIN_ITERATIONS, min_time_ms, &results[count]);
+                bench_print(&results[count]);
+                failures += results[count++].failures;
+
+                snprintf(name, sizeof(name), "%s/%s/decode%s", suites[s].name, fixture_sizes[z].name, suffix);
+                bench_run(name, decode_op, &fixture, BENCH_MIN_ITERATIONS, min_time_ms, &results[count]);
+                bench_print(&results[count]);
+                failures += results[count++].failures;
+
+                release_kind = fixture.kind;
+                snprintf(name, sizeof(name), "%s/%s/release%s", suites[s].name, fixture_sizes[z].name, suffix);
+                bench_run_release(name, build_op, release_op, &fixture, BENCH_MIN_ITERATIONS,
+                                  min_time_ms, &results[count]);
+                bench_print(&results[count]);
+                failures += results[count++].failures;
+            }
+
+            json_object_put(fixture.json);
+            free(fixture.text);
+        }
+    }
+
+    if (bench_write_json(output, "parse", results, count)) {
+        printf("results written to %s\n", output);
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+// provider_bench.c - Drive the real provider code against the mock server
+//
+// Run through `make bench`, which starts tests/mock/mock_server.py and points
+// the *_API_BASE_URL variables at it. Each end-to-end flow is timed as one
+// operation; per-request network metrics are dumped alongside.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../src/config.h"
+#include "../src/api/api.h"
+#include "../src/api/anime.h"
+#include "../src/api/manga.h"
+#include "../src/api/http.h"
+#include "../src/api/metrics.h"
+#include "bench.h"
+
+#define BENCH_DEFAULT_ITERATIONS 20
+#define BENCH_DEFAULT_OUTPUT "bench-flows.json"
+#define BENCH_DEFAULT_METRICS "bench-metrics.json"
+#define BENCH_SERVER_WAIT_MS 5000
+#define BENCH_MAX_SOURCES 8
+
+// Wait until the mock server answers its health check
+static bool wait_for_server() {
+    const char *base = getenv("ANIWATCH_API_BASE_URL");
+    if (!base) {
+        fprintf(stderr, "ANIWATCH_API_BASE_URL is not set; run through `make bench`\n");
+        return false;
+    }
+
+    char url[512];
+    snprintf(url, sizeof(url), "%s/health", base);
+
+    for (int waited = 0; waited < BENCH_SERVER_WAIT_MS; waited += 100) {
+        HttpResponse response;
+        bool ok = http_get(url, &response);
+        long status = response.status_code;
+        http_response_free(&response);
+        if (ok && status == 200) {
+            return true;
+        }
+
+        struct timespec ts = { 0, 100 * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+
+    fprintf(stderr, "Mock server at %s did not come up\n", base);
+    return false;
+}
+
+// Search, open the first result and resolve its first episode
+static bool anime_flow(void *ctx) {
+    set_current_provider(*(ProviderType *)ctx);
+
+    SearchResult *results = anime_search("naruto");
+    if (!results || results->total_results == 0) {
+        anime_free_search_results(results);
+        return false;
+    }
+
+    AnimeInfo *info = anime_get_info(results->results[0].id);
+    anime_free_search_results(results);
+    if (!info || info->total_episodes == 0) {
+        anime_free_info(info);
+        return false;
+    }
+
+    StreamInfo *stream = anime_get_episode_stream(info->episodes[0].id, NULL);
+    bool ok = stream && stream->sources_count > 0;
+    anime_free_stream_info(stream);
+    anime_free_info(info);
+    return ok;
+}
+
+// Search, open the first result and list its first chapter's pages
+static bool manga_flow(void *ctx) {
+    set_current_provider(*(ProviderType *)ctx);
+
+    SearchResult *results = manga_search("one piece");
+    if (!results || results->total_results == 0) {
+        manga_free_search_results(results);
+        return false;
+    }
+
+    MangaInfo *info = manga_get_info(results->results[0].id);
+    manga_free_search_results(results);
+    if (!info || info->total_chapters == 0) {
+        manga_free_info(info);
+        return false;
+    }
+
+    ChapterPages *pages = manga_get_chapter_pages(info->chapters[0].id);
+    bool ok = pages && pages->page_count > 0;
+    manga_free_chapter_pages(pages);
+    manga_free_info(info);
+    return ok;
+}
+
+static void print_summaries() {
+    MetricsSummary summaries[BENCH_MAX_SOURCES];
+    int count = metrics_summarize(summaries, BENCH_MAX_SOURCES);
+
+    printf("%-10s %5s %5s %8s %8s %8s %8s %8s %9s %10s\n", "source", "req", "fail",
+           "p50_ms", "p95_ms", "ttfb_ms", "parse_ms", "call_p50", "call_p95", "allocs/call");
+    for (int i = 0; i < count; i++) {
+        MetricsSummary *s = &summaries[i];
+        printf("%-10s %5d %5d %8.2f %8.2f %8.2f %8.3f %8.2f %9.2f %10.1f\n", s->source,
+               s->requests, s->failures, s->total_p50, s->total_p95, s->starttransfer_p50,
+               s->parse_p50, s->call_p50, s->call_p95, s->allocations_per_call);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_ITERATIONS;
+    const char *output = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    const char *metrics_output = argc > 3 ? argv[3] : BENCH_DEFAULT_METRICS;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations] [flows.json] [metrics.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Every iteration must reach the server, not the response cache
+    config_init();
+    app_config.cache_enabled = false;
+    api_init();
+
+    if (!wait_for_server()) {
+        api_cleanup();
+        config_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    static ProviderType aniwatch = PROVIDER_ANIWATCH;
+    static ProviderType zoro = PROVIDER_ZORO;
+    static ProviderType mangadex = PROVIDER_MANGADEX;
+    static const struct {
+        const char *name;
+        BenchFn flow;
+        ProviderType *provider;
+    } flows[] = {
+        { "aniwatch/search-info-stream", anime_flow, &aniwatch },
+        { "zoro/search-info-stream", anime_flow, &zoro },
+        { "mangadex/search-info-pages", manga_flow, &mangadex }
+    };
+    int count = sizeof(flows) / sizeof(flows[0]);
+
+    BenchResult results[sizeof(flows) / sizeof(flows[0])];
+    long failures = 0;
+
+    bench_print_header();
+    for (int i = 0; i < count; i++) {
+        bench_run(flows[i].name, flows[i].flow, flows[i].provider, iterations, 0, &results[i]);
+        bench_print(&results[i]);
+        failures += results[i].failures;
+    }
+
+    printf("\n");
+    print_summaries();
+
+    if (bench_write_json(output, "flows", results, count)) {
+        printf("results written to %s\n", output);
+    }
+    if (metrics_dump_json(metrics_output)) {
+        printf("request metrics written to %s\n", metrics_output);
+    }
+
+    api_cleanup();
+    config_cleanup();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,209 @@
+// render_bench.c - Cost of redrawing a selection list per arrow press
+//
+// Each operation moves the highlight one row, down to the end of a long
+// list and back up, and redraws the screen the way the list screens do.
+// Three ways are measured: "clear" is the original clear() before every
+// frame, which makes curses resend the whole screen; "erase" blanks the
+// virtual screen and lets curses work out the difference; "list_view"
+// states the rows to a ListView, which repaints the changed rows and
+// scrolls the list region. Terminal output goes to a temporary file whose
+// growth gives the bytes sent per frame.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <ncurses.h>
+#include "bench.h"
+#include "../src/ui/common/list_view.h"
+
+#define BENCH_DEFAULT_MIN_TIME_MS 200
+#define BENCH_DEFAULT_OUTPUT "bench-render.json"
+#define BENCH_MIN_ITERATIONS 50
+#define BENCH_ITEMS 500
+#define BENCH_LINES "40"
+#define BENCH_COLUMNS "120"
+
+typedef struct {
+    char *titles[BENCH_ITEMS];
+    int choice;
+    int step;           // +1 moving down, -1 moving up
+    int scroll_offset;
+    long frames;
+    ListView *view;
+} Fixture;
+
+// Move the highlight like KEY_DOWN / KEY_UP in the list screens
+static void advance(Fixture *fixture, int max_display) {
+    if (fixture->choice + fixture->step < 0 || fixture->choice + fixture->step >= BENCH_ITEMS) {
+        fixture->step = -fixture->step;
+    }
+    fixture->choice += fixture->step;
+    if (fixture->choice < fixture->scroll_offset) fixture->scroll_offset = fixture->choice;
+    if (fixture->choice >= fixture->scroll_offset + max_display) {
+        fixture->scroll_offset = fixture->choice - max_display + 1;
+    }
+    fixture->frames++;
+}
+
+// The select screens before ListView: every call positions and prints every row
+static void draw_direct(Fixture *fixture, int max_display) {
+    int line = 1;
+    attron(COLOR_PAIR(1) | A_BOLD);
+    mvprintw(line++, 1, "Select anime:");
+    attroff(COLOR_PAIR(1) | A_BOLD);
+    line++;
+
+    int displayed = 0;
+    for (int i = fixture->scroll_offset; i < BENCH_ITEMS && displayed < max_display; i++) {
+        if (i == fixture->choice) {
+            attron(A_REVERSE | COLOR_PAIR(2));
+            mvprintw(line++, 1, "> %s (%d episodes)", fixture->titles[i], 12 + i % 500);
+            attroff(A_REVERSE | COLOR_PAIR(2));
+        } else {
+            mvprintw(line++, 3, "%s (%d episodes)", fixture->titles[i], 12 + i % 500);
+        }
+        displayed++;
+    }
+
+    line = LINES - 2;
+    attron(COLOR_PAIR(1));
+    mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
+    mvprintw(line, 1, "Type to filter results, ESC to clear filter, Ctrl+C to quit");
+    attroff(COLOR_PAIR(1));
+    refresh();
+}
+
+static bool clear_op(void *ctx) {
+    Fixture *fixture = ctx;
+    advance(fixture, LINES - 5);
+    clear();
+    draw_direct(fixture, LINES - 5);
+    return true;
+}
+
+static bool erase_op(void *ctx) {
+    Fixture *fixture = ctx;
+    advance(fixture, LINES - 5);
+    erase();
+    draw_direct(fixture, LINES - 5);
+    return true;
+}
+
+static bool list_view_op(void *ctx) {
+    Fixture *fixture = ctx;
+    int max_display = LINES - 5;
+    advance(fixture, max_display);
+
+    ListView *view = fixture->view;
+    list_view_begin(view);
+    int line = 1;
+    list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Select anime:");
+    line++;
+
+    list_view_scroll(view, line, max_display, fixture->scroll_offset);
+    int displayed = 0;
+    for (int i = fixture->scroll_offset; i < BENCH_ITEMS && displayed < max_display; i++) {
+        if (i == fixture->choice) {
+            list_view_print(view, line++, 1, A_REVERSE | COLOR_PAIR(2), "> %s (%d episodes)",
+                            fixture->titles[i], 12 + i % 500);
+        } else {
+            list_view_print(view, line++, 3, A_NORMAL, "%s (%d episodes)",
+                            fixture->titles[i], 12 + i % 500);
+        }
+        displayed++;
+    }
+
+    line = LINES - 2;
+    list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
+    list_view_print(view, line, 1, COLOR_PAIR(1), "Type to filter results, ESC to clear filter, Ctrl+C to quit");
+    list_view_end(view);
+    return true;
+}
+
+static long output_size(FILE *output) {
+    struct stat st;
+    fflush(output);
+    return fstat(fileno(output), &st) == 0 ? (long)st.st_size : 0;
+}
+
+int main(int argc, char *argv[]) {
+    int min_time_ms = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_MIN_TIME_MS;
+    const char *output = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    if (min_time_ms <= 0) {
+        fprintf(stderr, "usage: %s [min_time_ms] [output.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // A fixed-size xterm drawing into a file, so runs compare between machines
+    setenv("LINES", BENCH_LINES, 1);
+    setenv("COLUMNS", BENCH_COLUMNS, 1);
+    FILE *screen_out = tmpfile();
+    FILE *screen_in = fopen("/dev/null", "r");
+    SCREEN *screen = screen_out && screen_in ? newterm("xterm", screen_out, screen_in) : NULL;
+    if (!screen) {
+        fprintf(stderr, "Failed to open a curses screen for the benchmark\n");
+        return EXIT_FAILURE;
+    }
+    start_color();
+    init_pair(1, COLOR_CYAN, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    idlok(stdscr, TRUE);
+
+    Fixture fixture = { 0 };
+    for (int i = 0; i < BENCH_ITEMS; i++) {
+        char title[96];
+        snprintf(title, sizeof(title), "Naruto Shippuden Movie %d: The Will of Fire Still Burns", i);
+        fixture.titles[i] = strdup(title);
+    }
+
+    static const struct {
+        const char *name;
+        BenchFn fn;
+    } methods[] = {
+        { "render/clear", clear_op },
+        { "render/erase", erase_op },
+        { "render/list_view", list_view_op }
+    };
+    int count = sizeof(methods) / sizeof(methods[0]);
+
+    BenchResult results[sizeof(methods) / sizeof(methods[0])];
+    long failures = 0;
+
+    for (int m = 0; m < count; m++) {
+        // Every method starts from the top of the list on a screen it painted itself
+        fixture.choice = fixture.scroll_offset = 0;
+        fixture.step = 1;
+        fixture.view = list_view_new();
+        clear();
+        refresh();
+
+        long before = output_size(screen_out);
+        fixture.frames = 0;
+        bench_run(methods[m].name, methods[m].fn, &fixture, BENCH_MIN_ITERATIONS, min_time_ms, &results[m]);
+        results[m].output_bytes_per_op = (double)(output_size(screen_out) - before) / fixture.frames;
+        failures += results[m].failures;
+        list_view_free(fixture.view);
+    }
+
+    endwin();
+    delscreen(screen);
+    fclose(screen_out);
+    fclose(screen_in);
+
+    // The table goes out after curses is done with the terminal
+    bench_print_header();
+    for (int m = 0; m < count; m++) {
+        bench_print(&results[m]);
+        printf("%-44s %9s %13.1f out bytes/frame\n", "", "", results[m].output_bytes_per_op);
+    }
+
+    for (int i = 0; i < BENCH_ITEMS; i++) {
+        free(fixture.titles[i]);
+    }
+
+    if (bench_write_json(output, "render", results, count)) {
+        printf("results written to %s\n", output);
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,38 +2,142 @@
 #include <stdlib.h>
 #include <string.h>
 #include "anime.h"
+#include "metrics.h"
+#include "stream_race.h"
+#include "lazy_list.h"
 #include "../config.h"
 
+// Each call reads the current provider once, so a switch made meanwhile
+// on another thread cannot mix two providers in one result
+
 SearchResult* anime_search(const char *query) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->search) {
         return NULL;
     }
     
-    return api->search(query);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    SearchResult *results = api->search(query);
+    metrics_call_end(&call);
+    if (results) results->provider = provider;
+    return results;
 }
 
-AnimeInfo* anime_get_info(const char *id) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+AnimeInfo* anime_get_info_from(ProviderType provider, const char *id) {
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->get_anime_info) {
         return NULL;
     }
     
-    return (AnimeInfo*)api->get_anime_info(id);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    AnimeInfo *info = (AnimeInfo*)api->get_anime_info(id);
+    metrics_call_end(&call);
+    if (info) info->provider = provider;
+    return info;
+}
+
+AnimeInfo* anime_get_info(const char *id) {
+    return anime_get_info_from(get_current_provider(), id);
+}
+
+AnimeInfo* anime_open_info(const char *id) {
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
+    if (!api || !api->open_anime_info) {
+        return anime_get_info_from(provider, id);
+    }
+    
+    AnimeInfo *info = (AnimeInfo*)api->open_anime_info(id);
+    if (info) info->provider = provider;
+    return info;
+}
+
+// Details the provider only knows once the whole response is in
+static void merge_details(AnimeInfo *info, const AnimeInfo *details) {
+    if (details->title) info->title = details->title;
+    if (details->url) info->url = details->url;
+    if (details->image) info->image = details->image;
+    if (details->description) info->description = details->description;
+    if (details->release_date) info->release_date = details->release_date;
+    if (details->status) info->status = details->status;
+    if (details->sub_or_dub) info->sub_or_dub = details->sub_or_dub;
+    if (details->sub_episodes) info->sub_episodes = details->sub_episodes;
+    if (details->dub_episodes) info->dub_episodes = details->dub_episodes;
+    if (details->genres) {
+        info->genres = details->genres;
+        info->genres_count = details->genres_count;
+    }
+}
+
+bool anime_info_update(AnimeInfo *info) {
+    if (!info || !lazy_list_update(info->episode_list)) {
+        return false;
+    }
+    
+    info->episodes = lazy_list_items(info->episode_list);
+    info->total_episodes = lazy_list_count(info->episode_list);
+    
+    // The details live with the list, which the info holds until it is freed
+    const AnimeInfo *details = lazy_list_summary(info->episode_list);
+    if (details) {
+        merge_details(info, details);
+    }
+    return true;
+}
+
+bool anime_info_loading(const AnimeInfo *info) {
+    return info && !lazy_list_done(info->episode_list);
+}
+
+int anime_info_fd(const AnimeInfo *info) {
+    return anime_info_loading(info) ? lazy_list_fd(info->episode_list) : -1;
+}
+
+void anime_info_request(AnimeInfo *info, int end) {
+    if (info) {
+        lazy_list_request(info->episode_list, end);
+    }
 }
 
 StreamInfo* anime_get_episode_stream(const char *episode_id, const char *server) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->get_episode_stream) {
         return NULL;
     }
     
-    return (StreamInfo*)api->get_episode_stream(episode_id, server);
+    // Time to playable: the whole race when no server is given
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    StreamInfo *stream;
+    if (!server) {
+        stream = stream_race_resolve(provider, episode_id);
+    } else {
+        stream = (StreamInfo*)api->get_episode_stream(episode_id, server, NULL);
+        if (stream) stream->provider = provider;
+    }
+    metrics_call_end(&call);
+    return stream;
+}
+
+const char* anime_stream_missing_category(const StreamInfo *stream) {
+    const ProviderAPI *api = stream ? get_provider_api(stream->provider) : NULL;
+    if (!api || !stream->category || !api->stream_categories || !api->stream_categories[0]) {
+        return NULL;
+    }
+    
+    const char *preferred = api->stream_categories[0];
+    return strcmp(stream->category, preferred) != 0 ? preferred : NULL;
 }
 
 void anime_free_search_results(SearchResult *results) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_search_results || !results) {
+    if (!results) return;
+    
+    const ProviderAPI *api = get_provider_api(results->provider);
+    if (!api || !api->free_search_results) {
         return;
     }
     
@@ -41,8 +145,10 @@ void anime_free_search_results(SearchResult *results) {
 }
 
 void anime_free_info(AnimeInfo *info) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_anime_info || !info) {
+    if (!info) return;
+    
+    const ProviderAPI *api = get_provider_api(info->provider);
+    if (!api || !api->free_anime_info) {
         return;
     }
     
@@ -50,8 +156,10 @@ void anime_free_info(AnimeInfo *info) {
 }
 
 void anime_free_stream_info(StreamInfo *info) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_stream_info || !info) {
+    if (!info) return;
+    
+    const ProviderAPI *api = get_provider_api(info->provider);
+    if (!api || !api->free_stream_info) {
         return;
     }
     
@@ -23,8 +23,13 @@ typedef struct {
     char **genres;
     int genres_count;
     char *sub_or_dub;
+    int sub_episodes;  // Episodes out subbed, 0 when the provider does not say
+    int dub_episodes;  // Episodes out dubbed, 0 when the provider does not say
     int total_episodes;
     Episode *episodes;
+    struct LazyList *episode_list;  // Episodes still arriving, merged by anime_info_update (NULL when loaded whole)
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Provider that created it
 } AnimeInfo;
 
 // Structure to hold streaming source information
@@ -48,6 +53,8 @@ typedef struct {
     int sources_count;
     Subtitle *subtitles;
     int subtitles_count;
+    ProviderType provider;  // Provider that created it
+    const char *category;   // Category it was resolved for ("sub", "dub", ...), NULL for the provider default
 } StreamInfo;
 
 // Search for anime with the current provider
@@ -56,10 +63,51 @@ SearchResult* anime_search(const char *query);
 // Get detailed anime information
 AnimeInfo* anime_get_info(const char *id);
 
-// Get streaming information for an episode
+/**
+ * Get detailed anime information from a given provider
+ * Unlike anime_get_info this leaves the current provider alone, so
+ * background fetches for federated results use the provider that found them.
+ * @param provider Provider to ask
+ * @param id Anime ID on that provider
+ * @return Anime information (free with anime_free_info) or NULL on error
+ */
+AnimeInfo* anime_get_info_from(ProviderType provider, const char *id);
+
+/**
+ * Get anime information for display
+ * With providers that support it this returns at once and the episode list
+ * keeps arriving in the background (see anime_info_update); otherwise it
+ * loads everything first, like anime_get_info.
+ * @param id The anime ID
+ * @return Anime information (free with anime_free_info) or NULL on error
+ */
+AnimeInfo* anime_open_info(const char *id);
+
+/**
+ * Merge the episodes that arrived since the last call
+ * Grows episodes and total_episodes (the array may move) and fills in the
+ * remaining details once the whole list is in. Call it on the thread that
+ * displays the info.
+ * @return true if the info changed
+ */
+bool anime_info_update(AnimeInfo *info);
+
+// Check whether episodes are still arriving
+bool anime_info_loading(const AnimeInfo *info);
+
+// Descriptor that becomes readable when anime_info_update has work, -1 once loaded
+int anime_info_fd(const AnimeInfo *info);
+
+// Tell the loader which episodes are on screen (indexes below end)
+void anime_info_request(AnimeInfo *info, int end);
+
+// Get streaming information for an episode (NULL server races all known servers)
 StreamInfo* anime_get_episode_stream(const char *episode_id, const char *server);
 
-// Free resources
+// Preferred category of the stream's provider when the stream is in another one, otherwise NULL
+const char* anime_stream_missing_category(const StreamInfo *stream);
+
+// Free resources with the provider that created them, whichever is current now
 void anime_free_search_results(SearchResult *results);
 void anime_free_info(AnimeInfo *info);
 void anime_free_stream_info(StreamInfo *info);
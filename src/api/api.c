@@ -2,6 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include "api.h"
+#include "http.h"
+#include "cache.h"
+#include "worker_pool.h"
+#include "stream_race.h"
+#include "episode_download.h"
+#include "../config.h"
 #include "providers/aniwatch.h"
 #include "providers/zoro.h"
 #include "providers/mangadex.h"
@@ -31,15 +37,28 @@ static const char* content_type_names[2] = {
 };
 
 void api_init() {
+    // Set up the shared HTTP client used by every provider
+    http_init();
+    cache_init(app_config.cache_enabled);
+    
     // Initialize provider APIs
     provider_apis[PROVIDER_ANIWATCH] = aniwatch_get_api();
     provider_apis[PROVIDER_ZORO] = zoro_get_api();
     provider_apis[PROVIDER_MANGADEX] = mangadex_get_api();
     // Add more providers as they are implemented
+
+    worker_pool_init(WORKER_POOL_SIZE);
 }
 
 void api_cleanup() {
-    // Any API cleanup needed
+    // A download would hold a worker until its last episode; stop it first
+    download_queue_shutdown();
+
+    // Workers finish their requests before the handles they use go away
+    worker_pool_shutdown();
+    stream_race_shutdown();
+    cache_cleanup();
+    http_cleanup();
 }
 
 const ProviderAPI* get_provider_api(ProviderType provider) {
@@ -49,18 +68,23 @@ const ProviderAPI* get_provider_api(ProviderType provider) {
     return provider_apis[provider];
 }
 
-const char** get_available_providers(ContentType content_type, int *count) {
-    static const char* available[PROVIDER_COUNT];
-    int available_count = 0;
+bool provider_supports_content(ProviderType provider, ContentType content_type) {
+    if (provider < 0 || provider >= PROVIDER_COUNT) {
+        return false;
+    }
+    return provider_content_support[provider][content_type];
+}
+
+int get_available_providers(ContentType content_type, const char *providers[PROVIDER_COUNT]) {
+    int count = 0;
     
     for (int i = 0; i < PROVIDER_COUNT; i++) {
         if (provider_content_support[i][content_type]) {
-            available[available_count++] = provider_names[i];
+            providers[count++] = provider_names[i];
         }
     }
     
-    *count = available_count;
-    return available;
+    return count;
 }
 
 const char* content_type_to_string(ContentType type) {
@@ -75,4 +99,9 @@ const char* provider_type_to_string(ProviderType provider) {
         return "Unknown";
     }
     return provider_names[provider];
+}
+
+const char* provider_base_url(const char *env_name, const char *fallback) {
+    const char *url = getenv(env_name);
+    return url && *url ? url : fallback;
 }
\ No newline at end of file
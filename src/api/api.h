@@ -26,10 +26,15 @@ typedef struct {
     ContentType content_type;
 } SearchResultItem;
 
+struct Arena;
+struct LazyList;
+
 // Search results
 typedef struct {
     int total_results;
     SearchResultItem *results;
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Provider that created it; its free function releases it
 } SearchResult;
 
 // Provider API functions
@@ -40,12 +45,20 @@ typedef struct {
     
     // Anime specific functions
     void *(*get_anime_info)(const char *id);
-    void *(*get_episode_stream)(const char *episode_id, const char *server);
+    // Returns at once; the episode list streams in behind it (NULL if unsupported)
+    void *(*open_anime_info)(const char *id);
+    void *(*get_episode_stream)(const char *episode_id, const char *server, const char *category);
     void (*free_anime_info)(void *info);
     void (*free_stream_info)(void *info);
     
+    // Servers and categories raced when no server is requested (NULL-terminated, preferred first)
+    const char *const *stream_servers;
+    const char *const *stream_categories;
+    
     // Manga specific functions
     void *(*get_manga_info)(const char *id);
+    // Returns at once; the chapter list streams in behind it (NULL if unsupported)
+    void *(*open_manga_info)(const char *id);
     void *(*get_chapter_pages)(const char *chapter_id);
     void (*free_manga_info)(void *info);
     void (*free_chapter_info)(void *info);
@@ -60,8 +73,17 @@ void api_cleanup();
 // Get API interface for a specific provider
 const ProviderAPI* get_provider_api(ProviderType provider);
 
-// Get list of available providers for a content type
-const char** get_available_providers(ContentType content_type, int *count);
+// Check whether a provider supports a content type
+bool provider_supports_content(ProviderType provider, ContentType content_type);
+
+/**
+ * List the providers of a content type
+ * Fills the caller's array, so concurrent callers do not share a buffer.
+ * @param content_type Content type
+ * @param providers Receives up to PROVIDER_COUNT provider names
+ * @return Number of names written
+ */
+int get_available_providers(ContentType content_type, const char *providers[PROVIDER_COUNT]);
 
 // Convert content type to string
 const char* content_type_to_string(ContentType type);
@@ -69,4 +91,14 @@ const char* content_type_to_string(ContentType type);
 // Convert provider type to string
 const char* provider_type_to_string(ProviderType provider);
 
+/**
+ * Base URL of a provider's API
+ * An environment variable of the given name overrides the built-in host,
+ * e.g. to point the providers at a local mock server.
+ * @param env_name Name of the overriding environment variable
+ * @param fallback Built-in base URL
+ * @return The base URL to use (never freed)
+ */
+const char* provider_base_url(const char *env_name, const char *fallback);
+
 #endif /* API_H */
\ No newline at end of file
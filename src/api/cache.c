@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "../utils/memory.h"
+#include "../utils/fs.h"
+#include "../utils/string.h"
+
+#define CACHE_MAGIC "ANIMECLI-CACHE 2"
+#define CACHE_SUFFIX ".entry"
+#define CACHE_MAX_BYTES (64L * 1024 * 1024)
+#define CACHE_EVICT_TARGET (CACHE_MAX_BYTES * 3 / 4)
+
+static bool cache_enabled = false;
+static char cache_dir[1024];
+static long cache_total_bytes = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// An entry being streamed to a temporary file
+struct CacheWriter {
+    FILE *file;
+    char path[1400];
+    char tmp_path[1450];
+    bool failed;
+};
+
+// Used to sort entries by last use during eviction
+typedef struct {
+    char name[64];
+    time_t last_used;
+    long size;
+} CacheFile;
+
+static bool has_suffix(const char *name, const char *suffix) {
+    size_t len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    return len > suffix_len && strcmp(name + len - suffix_len, suffix) == 0;
+}
+
+// Named after the hash of the normalised URL
+static void entry_path(const char *key, char *path, size_t size) {
+    snprintf(path, size, "%s/%016llx%s", cache_dir,
+             (unsigned long long)string_hash(key), CACHE_SUFFIX);
+}
+
+static int compare_params(const void *a, const void *b) {
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static int compare_last_used(const void *a, const void *b) {
+    const CacheFile *fa = a;
+    const CacheFile *fb = b;
+    if (fa->last_used < fb->last_used) return -1;
+    if (fa->last_used > fb->last_used) return 1;
+    return 0;
+}
+
+// Sum the size of every entry currently on disk
+static long scan_total_bytes() {
+    DIR *dir = opendir(cache_dir);
+    if (!dir) return 0;
+
+    long total = 0;
+    struct dirent *ent;
+    char path[1400];
+    struct stat st;
+
+    while ((ent = readdir(dir))) {
+        if (!has_suffix(ent->d_name, CACHE_SUFFIX)) continue;
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, ent->d_name);
+        if (stat(path, &st) == 0) {
+            total += st.st_size;
+        }
+    }
+
+    closedir(dir);
+    return total;
+}
+
+// Remove least recently used entries until the cache is under its target size
+static void evict_entries() {
+    DIR *dir = opendir(cache_dir);
+    if (!dir) return;
+
+    int capacity = 64;
+    int count = 0;
+    CacheFile *files = malloc(capacity * sizeof(CacheFile));
+    struct dirent *ent;
+    char path[1400];
+    struct stat st;
+
+    while (files && (ent = readdir(dir))) {
+        if (!has_suffix(ent->d_name, CACHE_SUFFIX)) continue;
+        if (strlen(ent->d_name) >= sizeof(files[0].name)) continue;
+
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, ent->d_name);
+        if (stat(path, &st) != 0) continue;
+
+        if (count == capacity) {
+            capacity *= 2;
+            CacheFile *grown = realloc(files, capacity * sizeof(CacheFile));
+            if (!grown) break;
+            files = grown;
+        }
+
+        strcpy(files[count].name, ent->d_name);
+        files[count].last_used = st.st_mtime;
+        files[count].size = st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (!files) return;
+
+    qsort(files, count, sizeof(CacheFile), compare_last_used);
+
+    long total = 0;
+    for (int i = 0; i < count; i++) {
+        total += files[i].size;
+    }
+
+    for (int i = 0; i < count && total > CACHE_EVICT_TARGET; i++) {
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, files[i].name);
+        if (unlink(path) == 0) {
+            total -= files[i].size;
+        }
+    }
+
+    cache_total_bytes = total;
+    free(files);
+}
+
+bool cache_init(bool enabled) {
+    cache_enabled = false;
+    if (!enabled) {
+        return false;
+    }
+
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+
+    if (xdg && *xdg) {
+        snprintf(cache_dir, sizeof(cache_dir), "%s/anime-cli", xdg);
+    } else if (home && *home) {
+        snprintf(cache_dir, sizeof(cache_dir), "%s/.cache/anime-cli", home);
+    } else {
+        return false;
+    }
+
+    if (!make_dirs(cache_dir)) {
+        fprintf(stderr, "Failed to create cache directory %s\n", cache_dir);
+        return false;
+    }
+
+    cache_total_bytes = scan_total_bytes();
+    cache_enabled = true;
+    return true;
+}
+
+void cache_cleanup() {
+    cache_enabled = false;
+}
+
+bool cache_is_enabled() {
+    return cache_enabled;
+}
+
+char* cache_normalize_url(const char *url) {
+    if (!url) return NULL;
+
+    char *copy = safe_strdup(url);
+
+    // Drop the fragment, it never reaches the server
+    char *fragment = strchr(copy, '#');
+    if (fragment) *fragment = '\0';
+
+    // Lowercase scheme and host
+    char *host_start = strstr(copy, "://");
+    char *path_start = host_start ? strchr(host_start + 3, '/') : NULL;
+    char *host_end = path_start ? path_start : copy + strlen(copy);
+    for (char *p = copy; p < host_end; p++) {
+        *p = tolower((unsigned char)*p);
+    }
+
+    // Sort query parameters so equivalent requests share a key
+    char *query = strchr(copy, '?');
+    if (!query) {
+        return copy;
+    }
+    *query++ = '\0';
+
+    // Every parameter stays in the key, or URLs differing only in a dropped one would share an entry
+    int max_params = 1;
+    for (const char *p = query; *p; p++) {
+        if (*p == '&') max_params++;
+    }
+    char **params = safe_malloc(max_params * sizeof(char *));
+    int param_count = 0;
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(query, "&", &saveptr); tok; tok = strtok_r(NULL, "&", &saveptr)) {
+        if (*tok) params[param_count++] = tok;
+    }
+    qsort(params, param_count, sizeof(char *), compare_params);
+
+    size_t len = strlen(copy) + strlen(url) + 2;
+    char *normalized = safe_malloc(len);
+    strcpy(normalized, copy);
+    for (int i = 0; i < param_count; i++) {
+        strcat(normalized, i == 0 ? "?" : "&");
+        strcat(normalized, params[i]);
+    }
+
+    free(params);
+    free(copy);
+    return normalized;
+}
+
+// Read the header of an entry file, leaving the stream at the body
+static bool read_header(FILE *file, const char *key, CacheEntry *entry) {
+    char line[2048];
+    bool valid = fgets(line, sizeof(line), file) && strncmp(line, CACHE_MAGIC, strlen(CACHE_MAGIC)) == 0;
+    bool key_matches = false;
+
+    // Header lines up to the blank separator
+    while (valid && fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0') break;
+
+        if (strncmp(line, "url=", 4) == 0) {
+            // Guard against hash collisions
+            key_matches = strcmp(line + 4, key) == 0;
+        } else if (strncmp(line, "stored=", 7) == 0) {
+            entry->stored_at = (time_t)atoll(line + 7);
+        } else if (strncmp(line, "etag=", 5) == 0) {
+            entry->etag = safe_strdup(line + 5);
+        } else if (strncmp(line, "last_modified=", 14) == 0) {
+            entry->last_modified = safe_strdup(line + 14);
+        }
+    }
+
+    return valid && key_matches;
+}
+
+FILE* cache_open(const char *url, CacheEntry *entry) {
+    memset(entry, 0, sizeof(CacheEntry));
+    if (!cache_enabled || !url) {
+        return NULL;
+    }
+
+    char *key = cache_normalize_url(url);
+    char path[1400];
+    entry_path(key, path, sizeof(path));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        free(key);
+        return NULL;
+    }
+
+    if (!read_header(file, key, entry)) {
+        fclose(file);
+        cache_entry_free(entry);
+        free(key);
+        return NULL;
+    }
+
+    // Touch the file so eviction sees it as recently used
+    utime(path, NULL);
+
+    free(key);
+    return file;
+}
+
+void cache_refresh(const char *url) {
+    if (!cache_enabled || !url) {
+        return;
+    }
+
+    char *key = cache_normalize_url(url);
+    char path[1400];
+    entry_path(key, path, sizeof(path));
+
+    FILE *file = fopen(path, "r+b");
+    if (!file) {
+        free(key);
+        return;
+    }
+
+    // The stored= line has a fixed width, so it can be rewritten in place
+    char line[2048];
+    if (fgets(line, sizeof(line), file) && fgets(line, sizeof(line), file)) {
+        long offset = ftell(file);
+        if (fgets(line, sizeof(line), file) && strncmp(line, "stored=", 7) == 0) {
+            fseek(file, offset, SEEK_SET);
+            fprintf(file, "stored=%020lld", (long long)time(NULL));
+        }
+    }
+
+    fclose(file);
+    free(key);
+}
+
+CacheWriter* cache_writer_open(const char *url, const char *etag, const char *last_modified) {
+    if (!cache_enabled || !url) {
+        return NULL;
+    }
+
+    CacheWriter *writer = calloc(1, sizeof(CacheWriter));
+    if (!writer) {
+        return NULL;
+    }
+
+    char *key = cache_normalize_url(url);
+    entry_path(key, writer->path, sizeof(writer->path));
+    snprintf(writer->tmp_path, sizeof(writer->tmp_path), "%s.XXXXXX", writer->path);
+
+    int fd = mkstemp(writer->tmp_path);
+    writer->file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!writer->file) {
+        if (fd >= 0) {
+            close(fd);
+            unlink(writer->tmp_path);
+        }
+        free(writer);
+        free(key);
+        return NULL;
+    }
+
+    fprintf(writer->file, "%s\n", CACHE_MAGIC);
+    fprintf(writer->file, "url=%s\n", key);
+    fprintf(writer->file, "stored=%020lld\n", (long long)time(NULL));
+    if (etag) fprintf(writer->file, "etag=%s\n", etag);
+    if (last_modified) fprintf(writer->file, "last_modified=%s\n", last_modified);
+    fprintf(writer->file, "\n");
+
+    free(key);
+    return writer;
+}
+
+bool cache_writer_write(CacheWriter *writer, const void *data, size_t size) {
+    if (!writer || writer->failed) {
+        return false;
+    }
+
+    if (fwrite(data, 1, size, writer->file) != size) {
+        writer->failed = true;
+        return false;
+    }
+    return true;
+}
+
+void cache_writer_commit(CacheWriter *writer) {
+    if (!writer) return;
+
+    bool ok = !writer->failed;
+    ok = (fclose(writer->file) == 0) && ok;
+
+    struct stat old_st;
+    long old_size = stat(writer->path, &old_st) == 0 ? old_st.st_size : 0;
+
+    // Rename is atomic, readers never see a half-written entry
+    if (!ok || rename(writer->tmp_path, writer->path) != 0) {
+        unlink(writer->tmp_path);
+        free(writer);
+        return;
+    }
+
+    struct stat st;
+    pthread_mutex_lock(&cache_lock);
+    if (stat(writer->path, &st) == 0) {
+        cache_total_bytes += st.st_size - old_size;
+    }
+    if (cache_total_bytes > CACHE_MAX_BYTES) {
+        evict_entries();
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    free(writer);
+}
+
+void cache_writer_abort(CacheWriter *writer) {
+    if (!writer) return;
+
+    fclose(writer->file);
+    unlink(writer->tmp_path);
+    free(writer);
+}
+
+void cache_entry_free(CacheEntry *entry) {
+    if (!entry) return;
+
+    free(entry->etag);
+    free(entry->last_modified);
+    memset(entry, 0, sizeof(CacheEntry));
+}
@@ -0,0 +1,75 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#include <stdio.h>
+
+// Metadata of a response stored on disk
+typedef struct {
+    char *etag;
+    char *last_modified;
+    time_t stored_at;
+} CacheEntry;
+
+// Streams a response body into the cache while it downloads
+typedef struct CacheWriter CacheWriter;
+
+/**
+ * Initialize the on-disk response cache
+ * Entries live in $XDG_CACHE_HOME/anime-cli (or ~/.cache/anime-cli).
+ * @param enabled Value of Config.cache_enabled; false turns every call into a no-op
+ * @return true if the cache is usable
+ */
+bool cache_init(bool enabled);
+
+// Release cache resources
+void cache_cleanup();
+
+// Check whether lookups and stores are active
+bool cache_is_enabled();
+
+/**
+ * Open the entry stored for a URL
+ * A hit marks the entry as recently used for LRU eviction.
+ * @param url Request URL (normalised internally)
+ * @param entry Receives the entry metadata (release with cache_entry_free)
+ * @return Stream positioned at the start of the body (fclose it) or NULL on a miss
+ */
+FILE* cache_open(const char *url, CacheEntry *entry);
+
+// Restart the freshness lifetime of an entry after a 304 revalidation
+void cache_refresh(const char *url);
+
+/**
+ * Start streaming a new entry for a URL
+ * Nothing becomes visible to readers until cache_writer_commit.
+ * @return Writer handle or NULL if the cache is disabled
+ */
+CacheWriter* cache_writer_open(const char *url, const char *etag, const char *last_modified);
+
+// Append body bytes to an entry being written
+bool cache_writer_write(CacheWriter *writer, const void *data, size_t size);
+
+/**
+ * Publish a fully written entry
+ * Evicts least recently used entries when the cache grows past its size limit.
+ */
+void cache_writer_commit(CacheWriter *writer);
+
+// Discard a partially written entry
+void cache_writer_abort(CacheWriter *writer);
+
+// Free the memory held by an entry
+void cache_entry_free(CacheEntry *entry);
+
+/**
+ * Normalise a URL into a cache key
+ * Lowercases scheme and host, drops the fragment and sorts query parameters.
+ * @return Newly allocated key (must be freed)
+ */
+char* cache_normalize_url(const char *url);
+
+#endif /* CACHE_H */
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "cancel.h"
+
+struct CancelToken {
+    atomic_int refs;
+    atomic_bool cancelled;  // Read from curl's progress callback, so no lock
+};
+
+CancelToken* cancel_token_new() {
+    CancelToken *token = malloc(sizeof(CancelToken));
+    if (!token) {
+        fprintf(stderr, "Failed to allocate memory for cancel token\n");
+        return NULL;
+    }
+
+    atomic_init(&token->refs, 1);
+    atomic_init(&token->cancelled, false);
+    return token;
+}
+
+CancelToken* cancel_token_ref(CancelToken *token) {
+    if (token) {
+        atomic_fetch_add(&token->refs, 1);
+    }
+    return token;
+}
+
+void cancel_token_cancel(CancelToken *token) {
+    if (token) {
+        atomic_store(&token->cancelled, true);
+    }
+}
+
+bool cancel_token_cancelled(const CancelToken *token) {
+    return token && atomic_load(&token->cancelled);
+}
+
+void cancel_token_free(CancelToken *token) {
+    if (token && atomic_fetch_sub(&token->refs, 1) == 1) {
+        free(token);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef CANCEL_H
+#define CANCEL_H
+
+#include <stdbool.h>
+
+// Shared flag asking the requests of one operation to stop
+// Held by the owner and by every thread working for it. Requests started
+// while a token is attached to their thread (see http_set_cancel_token)
+// abort from curl's progress callback as soon as it is cancelled.
+typedef struct CancelToken CancelToken;
+
+// Create a token that is not cancelled, with one reference for the caller
+CancelToken* cancel_token_new();
+
+// Take another reference (e.g. for a worker thread)
+CancelToken* cancel_token_ref(CancelToken *token);
+
+// Cancel the operation; cannot be undone
+void cancel_token_cancel(CancelToken *token);
+
+// Check whether the operation was cancelled (false for NULL)
+bool cancel_token_cancelled(const CancelToken *token);
+
+// Drop a reference; the token is freed with the last one
+void cancel_token_free(CancelToken *token);
+
+#endif /* CANCEL_H */
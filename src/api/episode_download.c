@@ -0,0 +1,562 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "episode_download.h"
+#include "anime.h"
+#include "hls.h"
+#include "http.h"
+#include "cancel.h"
+#include "metrics.h"
+#include "stream_race.h"
+#include "worker_pool.h"
+#include "../config.h"
+#include "../utils/memory.h"
+#include "../utils/fs.h"
+
+#define DOWNLOAD_TICK_MS 100
+#define DOWNLOAD_PATH_MAX 1200
+#define DOWNLOAD_SEGMENT_PATH_MAX (DOWNLOAD_PATH_MAX + 16)  // Segments directory, '/' and any int
+#define DOWNLOAD_COPY_CHUNK 65536
+
+// Segments fetched past the first one not yet appended; bounds the files waiting on disk
+#define DOWNLOAD_SEGMENT_WINDOW 32
+
+typedef struct DownloadJob {
+    ProviderType provider;
+    char *episode_id;
+    char *series;
+    int number;
+    struct DownloadJob *next;
+} DownloadJob;
+
+typedef enum {
+    SEGMENT_WAITING,
+    SEGMENT_RUNNING,
+    SEGMENT_DONE
+} SegmentState;
+
+// Where one episode's download lives on disk
+typedef struct {
+    char output[DOWNLOAD_PATH_MAX];    // Finished file
+    char part[DOWNLOAD_PATH_MAX];      // Segments appended so far
+    char journal[DOWNLOAD_PATH_MAX];   // How much of the part file is valid
+    char segments[DOWNLOAD_PATH_MAX];  // Directory of segments fetched but not appended yet
+} EpisodePaths;
+
+// Everything below is guarded by queue_lock
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static DownloadJob *queue_head = NULL;
+static DownloadJob *queue_tail = NULL;
+static DownloadJob *current = NULL;
+static CancelToken *queue_cancel = NULL;  // Cancelled at shutdown; the drain task holds a reference
+static bool draining = false;             // A drain task is queued or running
+static bool stopped = false;
+static DownloadStatus status;
+
+static void free_job(DownloadJob *job) {
+    if (!job) return;
+
+    free(job->episode_id);
+    free(job->series);
+    free(job);
+}
+
+// Series titles come from the API; never let them escape the directory
+static void series_directory(const DownloadJob *job, char *dir, size_t size) {
+    int len = snprintf(dir, size, "%s/",
+                       app_config.download_directory ? app_config.download_directory : ".");
+    const char *name = job->series && *job->series ? job->series : job->episode_id;
+
+    for (const char *p = name; *p && len < (int)size - 1; p++) {
+        dir[len++] = (isalnum((unsigned char)*p) || *p == '-' || *p == '_') ? *p : '_';
+    }
+    dir[len] = '\0';
+}
+
+static void episode_paths(const DownloadJob *job, const char *extension, EpisodePaths *paths) {
+    char dir[DOWNLOAD_PATH_MAX - 64];
+    series_directory(job, dir, sizeof(dir));
+
+    snprintf(paths->output, sizeof(paths->output), "%s/episode-%03d%s", dir, job->number, extension);
+    snprintf(paths->part, sizeof(paths->part), "%s/episode-%03d%s.part", dir, job->number, extension);
+    snprintf(paths->journal, sizeof(paths->journal), "%s/episode-%03d%s.journal", dir, job->number, extension);
+    snprintf(paths->segments, sizeof(paths->segments), "%s/episode-%03d%s.segments", dir, job->number, extension);
+}
+
+static void segment_path(const EpisodePaths *paths, int index, char *path, size_t size) {
+    snprintf(path, size, "%s/%05d", paths->segments, index);
+}
+
+// Read how far an earlier attempt got; false when there is nothing to resume
+static bool read_journal(const EpisodePaths *paths, int segments, int *committed, long long *bytes) {
+    FILE *file = fopen(paths->journal, "r");
+    if (!file) return false;
+
+    int journal_segments = -1;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        sscanf(line, "segments=%d", &journal_segments);
+        sscanf(line, "committed=%d", committed);
+        sscanf(line, "bytes=%lld", bytes);
+    }
+    fclose(file);
+
+    // A different playlist means different segments: start over
+    return journal_segments == segments && *committed > 0 && *committed <= segments && *bytes >= 0;
+}
+
+// Replaced in one rename, so a crash leaves either the old or the new journal
+static bool write_journal(const EpisodePaths *paths, int segments, int committed, long long bytes) {
+    char tmp[DOWNLOAD_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", paths->journal);
+
+    FILE *file = fopen(tmp, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to write %s\n", tmp);
+        return false;
+    }
+    fprintf(file, "segments=%d\ncommitted=%d\nbytes=%lld\n", segments, committed, bytes);
+    if (fclose(file) != 0 || rename(tmp, paths->journal) != 0) {
+        fprintf(stderr, "Failed to write %s\n", paths->journal);
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
+
+// Open the part file positioned after the segments the journal vouches for
+static FILE* open_part(const EpisodePaths *paths, int segments, int *committed, long long *bytes) {
+    *committed = 0;
+    *bytes = 0;
+
+    struct stat st;
+    if (read_journal(paths, segments, committed, bytes) &&
+        stat(paths->part, &st) == 0 && st.st_size >= *bytes &&
+        truncate(paths->part, *bytes) == 0) {
+        FILE *file = fopen(paths->part, "ab");
+        if (file) return file;
+    }
+
+    *committed = 0;
+    *bytes = 0;
+    unlink(paths->journal);
+    FILE *file = fopen(paths->part, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to create %s\n", paths->part);
+    }
+    return file;
+}
+
+static long long append_file(FILE *out, const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (!in) return -1;
+
+    char buffer[DOWNLOAD_COPY_CHUNK];
+    long long total = 0;
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, n, out) != n) {
+            total = -1;
+            break;
+        }
+        total += n;
+    }
+    if (ferror(in)) total = -1;
+
+    fclose(in);
+    return total;
+}
+
+static void publish_progress(int done, int total, long long bytes, double bytes_per_second) {
+    pthread_mutex_lock(&queue_lock);
+    status.segments_done = done;
+    status.segments_total = total;
+    status.bytes = bytes;
+    status.bytes_per_second = bytes_per_second;
+    pthread_mutex_unlock(&queue_lock);
+}
+
+static HlsPlaylist* fetch_playlist(const char *url, const StreamInfo *stream) {
+    HttpResponse response;
+    if (!http_get_as(url, stream->referer, stream->user_agent, &response) ||
+        response.status_code >= 400 || !response.data) {
+        fprintf(stderr, "Failed to fetch playlist %s\n", url);
+        http_response_free(&response);
+        return NULL;
+    }
+
+    HlsPlaylist *playlist = hls_parse(response.data, url);
+    http_response_free(&response);
+    return playlist;
+}
+
+// Follow a master playlist to its best variant
+static HlsPlaylist* fetch_media_playlist(const char *url, const StreamInfo *stream) {
+    HlsPlaylist *playlist = fetch_playlist(url, stream);
+    if (!playlist || !playlist->is_master) {
+        return playlist;
+    }
+
+    HlsPlaylist *media = fetch_playlist(hls_best_variant(playlist)->uri, stream);
+    hls_free(playlist);
+    if (media && media->is_master) {
+        fprintf(stderr, "Master playlist %s lists another master playlist\n", url);
+        hls_free(media);
+        return NULL;
+    }
+    return media;
+}
+
+static const StreamSource* hls_source(const StreamInfo *stream) {
+    for (int i = 0; i < stream->sources_count; i++) {
+        const StreamSource *source = &stream->sources[i];
+        if (source->url && (source->is_m3u8 || strstr(source->url, ".m3u8"))) {
+            return source;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Fetch segments in parallel and append them to the part file in order
+ * After each round the journal records the appended prefix before the
+ * appended segment files go, so a crash at any point loses at most the
+ * segments still in flight.
+ * @return true once every segment is in the part file
+ */
+static bool download_segments(const EpisodePaths *paths, const char *const *urls, int count,
+                              const StreamInfo *stream, CancelToken *cancel) {
+    int committed;
+    long long bytes;
+    FILE *part = open_part(paths, count, &committed, &bytes);
+    if (!part) return false;
+
+    SegmentState *states = calloc(count, sizeof(SegmentState));
+    int *attempts = calloc(count, sizeof(int));
+    HttpRequest **requests = calloc(count, sizeof(HttpRequest*));
+    if (!states || !attempts || !requests) {
+        fprintf(stderr, "Failed to allocate memory for segment downloads\n");
+        free(states);
+        free(attempts);
+        free(requests);
+        fclose(part);
+        return false;
+    }
+
+    char path[DOWNLOAD_SEGMENT_PATH_MAX];
+    for (int i = 0; i < committed; i++) {
+        // Appended before an interruption that came before their removal
+        states[i] = SEGMENT_DONE;
+        segment_path(paths, i, path, sizeof(path));
+        unlink(path);
+    }
+
+    bool ok = true;
+    int running = 0;
+    long long fetched = 0;
+    double started = metrics_now_ms();
+
+    while (ok && committed < count && !cancel_token_cancelled(cancel)) {
+        // Step aside while someone waits on a search or a stream
+        int limit = http_foreground_pending() > 0 ? DOWNLOAD_YIELD_CONCURRENCY : DOWNLOAD_SEGMENT_CONCURRENCY;
+        int end = committed + DOWNLOAD_SEGMENT_WINDOW < count ? committed + DOWNLOAD_SEGMENT_WINDOW : count;
+
+        for (int i = committed; i < end && running < limit && ok; i++) {
+            if (states[i] != SEGMENT_WAITING) continue;
+
+            segment_path(paths, i, path, sizeof(path));
+            if (access(path, F_OK) == 0) {
+                states[i] = SEGMENT_DONE; // Fetched by an earlier attempt
+                continue;
+            }
+
+            requests[i] = http_download_start(urls[i], stream->referer, stream->user_agent, path, NULL, NULL);
+            if (!requests[i]) {
+                ok = false;
+                break;
+            }
+            attempts[i]++;
+            states[i] = SEGMENT_RUNNING;
+            running++;
+        }
+
+        if (running > 0) {
+            http_poll(DOWNLOAD_TICK_MS, -1);
+        }
+
+        for (int i = committed; i < end; i++) {
+            if (!requests[i] || !http_request_done(requests[i])) continue;
+
+            struct stat st;
+            segment_path(paths, i, path, sizeof(path));
+            if (http_request_succeeded(requests[i])) {
+                states[i] = SEGMENT_DONE;
+                if (stat(path, &st) == 0) fetched += st.st_size;
+            } else if (attempts[i] < DOWNLOAD_SEGMENT_ATTEMPTS) {
+                states[i] = SEGMENT_WAITING;
+            } else if (!cancel_token_cancelled(cancel)) {
+                fprintf(stderr, "Failed to download segment %d of %s\n", i, paths->output);
+                ok = false;
+            }
+            http_request_free(requests[i]);
+            requests[i] = NULL;
+            running--;
+        }
+
+        // Append the finished prefix, record it, then drop the appended files
+        int appended = committed;
+        while (ok && committed < count && states[committed] == SEGMENT_DONE) {
+            segment_path(paths, committed, path, sizeof(path));
+            long long size = append_file(part, path);
+            if (size < 0) {
+                fprintf(stderr, "Failed to append %s\n", path);
+                ok = false;
+                break;
+            }
+            bytes += size;
+            committed++;
+        }
+
+        if (committed > appended) {
+            if (fflush(part) != 0 || !write_journal(paths, count, committed, bytes)) {
+                ok = false;
+            }
+            for (int i = appended; ok && i < committed; i++) {
+                segment_path(paths, i, path, sizeof(path));
+                unlink(path);
+            }
+        }
+
+        double elapsed = metrics_now_ms() - started;
+        publish_progress(committed, count, bytes, elapsed > 0 ? fetched * 1000.0 / elapsed : 0);
+    }
+
+    // Segments still in flight after a cancel or failure start over next time
+    for (int i = 0; i < count; i++) {
+        http_request_free(requests[i]);
+    }
+    free(requests);
+    free(attempts);
+    free(states);
+
+    if (fclose(part) != 0) {
+        ok = false;
+    }
+    return ok && committed == count;
+}
+
+// Download a media playlist's segments into the episode's file
+static bool download_playlist(const DownloadJob *job, const char *url, const HlsPlaylist *playlist,
+                              const StreamInfo *stream, CancelToken *cancel) {
+    if (playlist->encrypted || playlist->byte_ranges || playlist->segment_count == 0) {
+        fprintf(stderr, "Playlist %s uses %s; it cannot be downloaded\n", url,
+                playlist->encrypted ? "encryption" :
+                playlist->byte_ranges ? "byte ranges" : "no segments");
+        return false;
+    }
+
+    // fMP4 segments only play behind their initialisation section
+    int count = playlist->segment_count + (playlist->map_uri ? 1 : 0);
+    const char **urls = calloc(count, sizeof(char*));
+    if (!urls) {
+        fprintf(stderr, "Failed to allocate memory for segment list\n");
+        return false;
+    }
+    int n = 0;
+    if (playlist->map_uri) urls[n++] = playlist->map_uri;
+    for (int i = 0; i < playlist->segment_count; i++) {
+        urls[n++] = playlist->segments[i].uri;
+    }
+
+    EpisodePaths paths;
+    episode_paths(job, playlist->map_uri ? ".mp4" : ".ts", &paths);
+
+    bool ok = make_dirs(paths.segments);
+    if (!ok) {
+        fprintf(stderr, "Failed to create download directory %s\n", paths.segments);
+    }
+    ok = ok && download_segments(&paths, urls, count, stream, cancel);
+    free(urls);
+
+    if (ok && rename(paths.part, paths.output) != 0) {
+        fprintf(stderr, "Failed to move %s into place\n", paths.output);
+        return false;
+    }
+    if (ok) {
+        unlink(paths.journal);
+        rmdir(paths.segments);
+    }
+    return ok;
+}
+
+static bool download_episode(const DownloadJob *job, CancelToken *cancel) {
+    EpisodePaths paths;
+    const char *extensions[] = { ".ts", ".mp4" };
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++) {
+        episode_paths(job, extensions[i], &paths);
+        if (access(paths.output, F_OK) == 0) {
+            return true; // Downloaded before
+        }
+    }
+
+    StreamInfo *stream = stream_race_resolve(job->provider, job->episode_id);
+    if (!stream) {
+        return false;
+    }
+    
+    // Say so in the status line when the preferred category had no stream
+    if (anime_stream_missing_category(stream)) {
+        pthread_mutex_lock(&queue_lock);
+        size_t len = strlen(status.current);
+        snprintf(status.current + len, sizeof(status.current) - len, " (%s)", stream->category);
+        pthread_mutex_unlock(&queue_lock);
+    }
+
+    bool ok = false;
+    const StreamSource *source = hls_source(stream);
+    if (!source) {
+        fprintf(stderr, "Episode %s has no HLS stream to download\n", job->episode_id);
+    } else {
+        HlsPlaylist *playlist = fetch_media_playlist(source->url, stream);
+        ok = playlist && download_playlist(job, source->url, playlist, stream, cancel);
+        hls_free(playlist);
+    }
+
+    anime_free_stream_info(stream);
+    return ok;
+}
+
+static void drain_queue(void *ctx) {
+    CancelToken *cancel = ctx;
+
+    // Stream lookups and segments stop at shutdown and stay out of the way of the UI's requests
+    http_set_cancel_token(cancel);
+    http_set_background(true);
+
+    while (!cancel_token_cancelled(cancel)) {
+        pthread_mutex_lock(&queue_lock);
+        DownloadJob *job = queue_head;
+        if (job) {
+            queue_head = job->next;
+            if (!queue_head) queue_tail = NULL;
+            current = job;
+            status.queued--;
+            status.active = true;
+            status.segments_done = status.segments_total = 0;
+            status.bytes = 0;
+            status.bytes_per_second = 0;
+            snprintf(status.current, sizeof(status.current), "%s episode %d",
+                     job->series ? job->series : job->episode_id, job->number);
+        } else {
+            draining = false;
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        if (!job) break;
+
+        bool ok = download_episode(job, cancel);
+
+        pthread_mutex_lock(&queue_lock);
+        current = NULL;
+        status.active = false;
+        status.current[0] = '\0';
+        if (ok) {
+            status.completed++;
+        } else if (!cancel_token_cancelled(cancel)) {
+            status.failed++;
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        free_job(job);
+    }
+
+    cancel_token_free(cancel);
+}
+
+// Caller holds queue_lock
+static bool is_queued(ProviderType provider, const char *episode_id) {
+    if (current && current->provider == provider && strcmp(current->episode_id, episode_id) == 0) {
+        return true;
+    }
+    for (DownloadJob *job = queue_head; job; job = job->next) {
+        if (job->provider == provider && strcmp(job->episode_id, episode_id) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool download_queue_add(ProviderType provider, const char *episode_id, const char *series, int number) {
+    if (!episode_id) return false;
+
+    DownloadJob *job = calloc(1, sizeof(DownloadJob));
+    if (!job) {
+        fprintf(stderr, "Failed to allocate memory for download\n");
+        return false;
+    }
+    job->provider = provider;
+    job->episode_id = safe_strdup(episode_id);
+    job->series = series ? safe_strdup(series) : NULL;
+    job->number = number;
+
+    pthread_mutex_lock(&queue_lock);
+    if (stopped || is_queued(provider, episode_id)) {
+        bool queued = !stopped;
+        pthread_mutex_unlock(&queue_lock);
+        free_job(job);
+        return queued;
+    }
+
+    if (!queue_cancel) {
+        queue_cancel = cancel_token_new();
+    }
+
+    if (!draining) {
+        // The queue is empty whenever no drain task is around
+        CancelToken *cancel = cancel_token_ref(queue_cancel);
+        if (!cancel || !worker_pool_submit(drain_queue, NULL, cancel)) {
+            pthread_mutex_unlock(&queue_lock);
+            fprintf(stderr, "Failed to start episode download\n");
+            cancel_token_free(cancel);
+            free_job(job);
+            return false;
+        }
+        draining = true;
+    }
+
+    if (queue_tail) queue_tail->next = job;
+    else queue_head = job;
+    queue_tail = job;
+    status.queued++;
+    pthread_mutex_unlock(&queue_lock);
+    return true;
+}
+
+void download_queue_status(DownloadStatus *out) {
+    pthread_mutex_lock(&queue_lock);
+    *out = status;
+    pthread_mutex_unlock(&queue_lock);
+}
+
+void download_queue_shutdown() {
+    pthread_mutex_lock(&queue_lock);
+    stopped = true;
+    cancel_token_cancel(queue_cancel);
+    cancel_token_free(queue_cancel);
+    queue_cancel = NULL;
+
+    DownloadJob *job = queue_head;
+    queue_head = queue_tail = NULL;
+    status.queued = 0;
+    pthread_mutex_unlock(&queue_lock);
+
+    while (job) {
+        DownloadJob *next = job->next;
+        free_job(job);
+        job = next;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef EPISODE_DOWNLOAD_H
+#define EPISODE_DOWNLOAD_H
+
+#include <stdbool.h>
+#include "api.h"
+
+// Segments fetched at once while nothing else is using the network
+#define DOWNLOAD_SEGMENT_CONCURRENCY 6
+
+// Segments fetched at once while interactive requests are in flight
+#define DOWNLOAD_YIELD_CONCURRENCY 1
+
+// Attempts per segment before the episode fails
+#define DOWNLOAD_SEGMENT_ATTEMPTS 3
+
+#define DOWNLOAD_LABEL_MAX 128
+
+// Snapshot of the download queue
+typedef struct {
+    int queued;                 // Episodes waiting behind the current one
+    int completed;              // Episodes written since startup
+    int failed;                 // Episodes given up on since startup
+    bool active;                // An episode is downloading
+    char current[DOWNLOAD_LABEL_MAX];  // "<series> episode <n>" while active
+    int segments_done;          // Segments of the current episode written to its file
+    int segments_total;         // 0 until the playlist is known
+    long long bytes;            // Size of the current episode's file so far
+    double bytes_per_second;    // Segment bytes received per second for the current episode
+} DownloadStatus;
+
+/**
+ * Queue an episode for download
+ * Episodes download one after another on a pool worker. The stream is
+ * resolved like for playback, the best HLS variant is picked and its
+ * segments are fetched in parallel, then appended in order to
+ * Config.download_directory/<series>/episode-<n>.ts. A journal next to
+ * the partial file lets a later download of the same episode resume
+ * where it stopped; finished episodes are skipped.
+ * @param provider Provider the episode comes from
+ * @param episode_id Episode to download
+ * @param series Series title, used for the directory
+ * @param number Episode number, used for the file name
+ * @return false if the episode could not be queued
+ */
+bool download_queue_add(ProviderType provider, const char *episode_id, const char *series, int number);
+
+// Fill status with the queue's current state
+void download_queue_status(DownloadStatus *status);
+
+// Stop the download in progress (its journal stays for a resume) and drop the queue
+void download_queue_shutdown();
+
+#endif /* EPISODE_DOWNLOAD_H */
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "federated.h"
+#include "http.h"
+#include "metrics.h"
+#include "worker_pool.h"
+#include "../utils/memory.h"
+#include "../utils/string.h"
+
+// State shared by the owner and the provider threads
+typedef struct {
+    pthread_mutex_t lock;
+    int refs;
+    bool cancelled;
+    int pending;
+    int pipe_fds[2];
+
+    // Answers waiting to be merged on the owner's thread
+    SearchResult *answers[PROVIDER_COUNT];
+} SharedState;
+
+// One provider query running on a pool worker
+typedef struct {
+    SharedState *shared;
+    ProviderType provider;
+    char *query;
+} ProviderTask;
+
+struct FederatedSearch {
+    SharedState *shared;
+    SearchResult merged;
+    int capacity;
+    char **keys;
+    ProviderType *providers;
+    unsigned *sources;
+
+    // Normalized title -> merged indexes, open addressing; -1 marks a free slot.
+    // A title appears once per entry carrying it, and untitled entries are left out.
+    int *slots;
+    int slot_count;   // Power of two, kept at least twice the number of titles
+};
+
+#define FEDERATED_MIN_SLOTS 64
+
+static void release_shared(SharedState *shared) {
+    pthread_mutex_lock(&shared->lock);
+    bool last = --shared->refs == 0;
+    pthread_mutex_unlock(&shared->lock);
+
+    if (!last) return;
+
+    // Answers that arrived after the owner stopped listening
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        if (shared->answers[i]) {
+            get_provider_api(i)->free_search_results(shared->answers[i]);
+        }
+    }
+
+    close(shared->pipe_fds[0]);
+    close(shared->pipe_fds[1]);
+    pthread_mutex_destroy(&shared->lock);
+    free(shared);
+}
+
+// Abort the provider's requests once the owner has gone away
+static bool task_wait_tick(void *ctx) {
+    SharedState *shared = ctx;
+
+    pthread_mutex_lock(&shared->lock);
+    bool cancelled = shared->cancelled;
+    pthread_mutex_unlock(&shared->lock);
+
+    return !cancelled;
+}
+
+static void provider_task(void *arg) {
+    ProviderTask *task = arg;
+    SharedState *shared = task->shared;
+    const ProviderAPI *api = get_provider_api(task->provider);
+
+    http_set_wait_hook(task_wait_tick, -1, shared);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(task->provider));
+    SearchResult *results = api->search(task->query);
+    metrics_call_end(&call);
+
+    pthread_mutex_lock(&shared->lock);
+    if (!shared->cancelled) {
+        shared->answers[task->provider] = results;
+        results = NULL;
+    }
+    shared->pending--;
+    pthread_mutex_unlock(&shared->lock);
+
+    if (results) {
+        api->free_search_results(results);
+    }
+
+    // Wake the owner; if the pipe is full a wake-up is already queued
+    char byte = 1;
+    ssize_t written = write(shared->pipe_fds[1], &byte, 1);
+    (void)written;
+
+    release_shared(shared);
+    free(task->query);
+    free(task);
+}
+
+static bool start_provider(SharedState *shared, ProviderType provider, const char *query) {
+    ProviderTask *task = malloc(sizeof(ProviderTask));
+    if (!task) {
+        return false;
+    }
+
+    task->shared = shared;
+    task->provider = provider;
+    task->query = safe_strdup(query);
+
+    if (!worker_pool_submit(provider_task, NULL, task)) {
+        fprintf(stderr, "Failed to start search for %s\n", provider_type_to_string(provider));
+        free(task->query);
+        free(task);
+        return false;
+    }
+
+    return true;
+}
+
+FederatedSearch* federated_search_start(ContentType content_type, const char *query) {
+    if (!query) return NULL;
+
+    FederatedSearch *search = calloc(1, sizeof(FederatedSearch));
+    SharedState *shared = calloc(1, sizeof(SharedState));
+    if (!search || !shared) {
+        fprintf(stderr, "Failed to allocate memory for federated search\n");
+        free(search);
+        free(shared);
+        return NULL;
+    }
+
+    if (pipe(shared->pipe_fds) != 0) {
+        fprintf(stderr, "Failed to create federated search pipe\n");
+        free(search);
+        free(shared);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(shared->pipe_fds[i], F_SETFL, O_NONBLOCK);
+        fcntl(shared->pipe_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    pthread_mutex_init(&shared->lock, NULL);
+    shared->refs = 1;
+    search->shared = shared;
+
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        const ProviderAPI *api = get_provider_api(i);
+        if (!provider_supports_content(i, content_type) || !api || !api->search) {
+            continue;
+        }
+
+        // Count the reference before the thread can drop it
+        pthread_mutex_lock(&shared->lock);
+        shared->refs++;
+        shared->pending++;
+        pthread_mutex_unlock(&shared->lock);
+
+        if (!start_provider(shared, i, query)) {
+            pthread_mutex_lock(&shared->lock);
+            shared->refs--;
+            shared->pending--;
+            pthread_mutex_unlock(&shared->lock);
+        }
+    }
+
+    return search;
+}
+
+int federated_search_fd(const FederatedSearch *search) {
+    return search ? search->shared->pipe_fds[0] : -1;
+}
+
+// Append a copy of an item that no other provider returned yet
+static bool append_item(FederatedSearch *search, const SearchResultItem *item,
+                        char *key, ProviderType provider) {
+    if (search->merged.total_results == search->capacity) {
+        int capacity = search->capacity ? search->capacity * 2 : 32;
+        SearchResultItem *results = realloc(search->merged.results, capacity * sizeof(SearchResultItem));
+        char **keys = realloc(search->keys, capacity * sizeof(char*));
+        ProviderType *providers = realloc(search->providers, capacity * sizeof(ProviderType));
+        unsigned *sources = realloc(search->sources, capacity * sizeof(unsigned));
+
+        // Keep whichever blocks did grow so nothing leaks
+        if (results) search->merged.results = results;
+        if (keys) search->keys = keys;
+        if (providers) search->providers = providers;
+        if (sources) search->sources = sources;
+        if (!results || !keys || !providers || !sources) {
+            return false;
+        }
+        search->capacity = capacity;
+    }
+
+    int index = search->merged.total_results++;
+    SearchResultItem *copy = &search->merged.results[index];
+    copy->id = item->id ? safe_strdup(item->id) : NULL;
+    copy->title = safe_strdup(item->title);
+    copy->image = item->image ? safe_strdup(item->image) : NULL;
+    copy->episodes_or_chapters = item->episodes_or_chapters;
+    copy->content_type = item->content_type;
+
+    search->keys[index] = key;
+    search->providers[index] = provider;
+    search->sources[index] = 1u << provider;
+    return true;
+}
+
+// Slot of an entry titled key that provider has not answered yet, or the
+// free slot a new entry would go into
+static int find_slot(const FederatedSearch *search, const char *key, ProviderType provider) {
+    int mask = search->slot_count - 1;
+    for (int slot = (int)(string_hash(key) & mask);; slot = (slot + 1) & mask) {
+        int index = search->slots[slot];
+        if (index < 0) {
+            return slot;
+        }
+        if (!(search->sources[index] & (1u << provider)) && strcmp(search->keys[index], key) == 0) {
+            return slot;
+        }
+    }
+}
+
+// Free slot for an entry that is already in the merged list
+static int free_slot(const FederatedSearch *search, const char *key) {
+    int mask = search->slot_count - 1;
+    int slot = (int)(string_hash(key) & mask);
+    while (search->slots[slot] >= 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Grow the title index so it stays at most half full with count titles
+static bool reserve_slots(FederatedSearch *search, int count) {
+    if (count * 2 <= search->slot_count) return true;
+
+    int slot_count = search->slot_count ? search->slot_count : FEDERATED_MIN_SLOTS;
+    while (count * 2 > slot_count) slot_count *= 2;
+
+    int *slots = malloc(slot_count * sizeof(int));
+    if (!slots) {
+        fprintf(stderr, "Failed to grow federated title index\n");
+        return false;
+    }
+    memset(slots, 0xff, slot_count * sizeof(int));
+
+    free(search->slots);
+    search->slots = slots;
+    search->slot_count = slot_count;
+    for (int i = 0; i < search->merged.total_results; i++) {
+        if (search->keys[i][0]) {
+            search->slots[free_slot(search, search->keys[i])] = i;
+        }
+    }
+    return true;
+}
+
+static void merge_answer(FederatedSearch *search, ProviderType provider, const SearchResult *answer) {
+    for (int i = 0; i < answer->total_results; i++) {
+        const SearchResultItem *item = &answer->results[i];
+        if (!item->title || !item->id) continue;
+
+        if (!reserve_slots(search, search->merged.total_results + 1)) return;
+
+        // Entries of one provider are all distinct (remakes, TV and movie
+        // entries), and a title with nothing left to compare never merges
+        char *key = normalize_title(item->title);
+        int slot = key[0] ? find_slot(search, key, provider) : -1;
+        int existing = slot >= 0 ? search->slots[slot] : -1;
+
+        if (existing >= 0) {
+            // Same title from another provider: merge into the first entry
+            SearchResultItem *merged = &search->merged.results[existing];
+            search->sources[existing] |= 1u << provider;
+            if (item->episodes_or_chapters > merged->episodes_or_chapters) {
+                merged->episodes_or_chapters = item->episodes_or_chapters;
+            }
+            free(key);
+        } else if (append_item(search, item, key, provider)) {
+            if (slot >= 0) search->slots[slot] = search->merged.total_results - 1;
+        } else {
+            free(key);
+        }
+    }
+}
+
+bool federated_search_update(FederatedSearch *search) {
+    if (!search) return false;
+
+    SharedState *shared = search->shared;
+    char buffer[64];
+    while (read(shared->pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+        // Drain wake-ups
+    }
+
+    SearchResult *answers[PROVIDER_COUNT];
+    pthread_mutex_lock(&shared->lock);
+    memcpy(answers, shared->answers, sizeof(answers));
+    memset(shared->answers, 0, sizeof(shared->answers));
+    pthread_mutex_unlock(&shared->lock);
+
+    int before = search->merged.total_results;
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        if (!answers[i]) continue;
+
+        merge_answer(search, i, answers[i]);
+        get_provider_api(i)->free_search_results(answers[i]);
+    }
+
+    return search->merged.total_results != before;
+}
+
+const SearchResult* federated_search_results(const FederatedSearch *search) {
+    return search ? &search->merged : NULL;
+}
+
+ProviderType federated_search_provider(const FederatedSearch *search, int index) {
+    return search->providers[index];
+}
+
+unsigned federated_search_sources(const FederatedSearch *search, int index) {
+    return search->sources[index];
+}
+
+int federated_search_pending(const FederatedSearch *search) {
+    if (!search) return 0;
+
+    pthread_mutex_lock(&search->shared->lock);
+    int pending = search->shared->pending;
+    pthread_mutex_unlock(&search->shared->lock);
+    return pending;
+}
+
+void federated_search_free(FederatedSearch *search) {
+    if (!search) return;
+
+    // Providers still running notice this on their next wait tick
+    pthread_mutex_lock(&search->shared->lock);
+    search->shared->cancelled = true;
+    pthread_mutex_unlock(&search->shared->lock);
+    release_shared(search->shared);
+
+    for (int i = 0; i < search->merged.total_results; i++) {
+        free(search->merged.results[i].id);
+        free(search->merged.results[i].title);
+        free(search->merged.results[i].image);
+        free(search->keys[i]);
+    }
+    free(search->merged.results);
+    free(search->keys);
+    free(search->providers);
+    free(search->sources);
+    free(search->slots);
+    free(search);
+}
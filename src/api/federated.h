@@ -0,0 +1,52 @@
+#ifndef FEDERATED_H
+#define FEDERATED_H
+
+#include <stdbool.h>
+#include "api.h"
+
+// Search running concurrently on every provider of a content type
+typedef struct FederatedSearch FederatedSearch;
+
+/**
+ * Start searching every provider that supports a content type
+ * Each provider runs on its own pool worker, so the total wait is bounded by
+ * the slowest provider rather than the sum of all of them.
+ * @param content_type Content type whose providers are queried
+ * @param query Search query
+ * @return Search handle (release with federated_search_free) or NULL on error
+ */
+FederatedSearch* federated_search_start(ContentType content_type, const char *query);
+
+/**
+ * Descriptor that becomes readable whenever a provider has answered
+ * Poll it together with stdin and call federated_search_update when it fires.
+ */
+int federated_search_fd(const FederatedSearch *search);
+
+/**
+ * Merge the answers received so far into the result list
+ * Titles are deduplicated by normalised name; items keep the position of
+ * the first provider that returned them.
+ * @return true if the result list changed
+ */
+bool federated_search_update(FederatedSearch *search);
+
+// Merged results so far (owned by the search)
+const SearchResult* federated_search_results(const FederatedSearch *search);
+
+// Provider that should serve a merged item (the first one that returned it)
+ProviderType federated_search_provider(const FederatedSearch *search, int index);
+
+// Bitmask of (1 << ProviderType) for every provider that returned a merged item
+unsigned federated_search_sources(const FederatedSearch *search, int index);
+
+// Number of providers that have not answered yet
+int federated_search_pending(const FederatedSearch *search);
+
+/**
+ * Stop waiting for providers and release the search
+ * Providers still running finish in the background and their answers are dropped.
+ */
+void federated_search_free(FederatedSearch *search);
+
+#endif /* FEDERATED_H */
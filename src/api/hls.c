@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "hls.h"
+#include "../utils/memory.h"
+
+#define HLS_LINE_MAX 4096
+
+// Find ATTR=value in a tag's attribute list; quoted values lose their quotes
+static bool attribute(const char *list, const char *name, char *value, size_t size) {
+    size_t name_len = strlen(name);
+    const char *p = list;
+
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        const char *key = p;
+        while (*p && *p != '=' && *p != ',') p++;
+        bool match = (size_t)(p - key) == name_len && strncasecmp(key, name, name_len) == 0;
+        if (*p != '=') continue;
+        p++;
+
+        const char *start = p;
+        const char *end;
+        if (*p == '"') {
+            start = ++p;
+            while (*p && *p != '"') p++;
+            end = p;
+            if (*p) p++;
+        } else {
+            while (*p && *p != ',') p++;
+            end = p;
+        }
+
+        if (match) {
+            snprintf(value, size, "%.*s", (int)(end - start), start);
+            return true;
+        }
+    }
+    return false;
+}
+
+char* hls_resolve_url(const char *base_url, const char *uri) {
+    if (!uri) return NULL;
+    if (strstr(uri, "://") || !base_url) {
+        return safe_strdup(uri);
+    }
+
+    const char *scheme_end = strstr(base_url, "://");
+    if (!scheme_end) {
+        return safe_strdup(uri);
+    }
+    const char *host = scheme_end + 3;
+    const char *path = host + strcspn(host, "/?#");
+
+    size_t prefix;
+    if (uri[0] == '/' && uri[1] == '/') {
+        prefix = scheme_end + 1 - base_url;    // "https:"
+    } else if (uri[0] == '/') {
+        prefix = path - base_url;               // "https://host"
+    } else {
+        // Directory of the playlist, without its query
+        const char *end = path + strcspn(path, "?#");
+        const char *slash = end;
+        while (slash > path && slash[-1] != '/') slash--;
+        prefix = slash - base_url;
+        if (slash == path) {
+            // "https://host" with no path: the root directory
+            char *url = safe_malloc(prefix + strlen(uri) + 2);
+            sprintf(url, "%.*s/%s", (int)prefix, base_url, uri);
+            return url;
+        }
+    }
+
+    char *url = safe_malloc(prefix + strlen(uri) + 1);
+    sprintf(url, "%.*s%s", (int)prefix, base_url, uri);
+    return url;
+}
+
+static char* resolve_into(Arena *arena, const char *base_url, const char *uri) {
+    char *url = hls_resolve_url(base_url, uri);
+    char *copy = arena_strdup(arena, url);
+    free(url);
+    return copy;
+}
+
+// Copy the next line of text into line, moving *text past it
+static bool next_line(const char **text, char *line, size_t size) {
+    const char *p = *text;
+    if (!*p) return false;
+
+    size_t len = strcspn(p, "\r\n");
+    snprintf(line, size, "%.*s", (int)len, p);
+    p += len;
+    if (*p == '\r') p++;
+    if (*p == '\n') p++;
+    *text = p;
+
+    // Trailing blanks are not part of URIs or attribute lists
+    len = strlen(line);
+    while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t')) line[--len] = '\0';
+    return true;
+}
+
+HlsPlaylist* hls_parse(const char *text, const char *base_url) {
+    if (!text) return NULL;
+    while (*text == ' ' || *text == '\n' || *text == '\r' || *text == '\t') text++;
+    if (strncmp(text, "#EXTM3U", 7) != 0) {
+        fprintf(stderr, "Not an HLS playlist\n");
+        return NULL;
+    }
+
+    // Every variant or segment has a tag line, so tags bound both counts
+    int tags = 0;
+    for (const char *p = text; (p = strstr(p, "#EXT")); p++) tags++;
+
+    Arena *arena = arena_create(0);
+    HlsPlaylist *playlist = arena_calloc(arena, 1, sizeof(HlsPlaylist));
+    playlist->arena = arena;
+    playlist->variants = arena_calloc(arena, tags, sizeof(HlsVariant));
+    playlist->segments = arena_calloc(arena, tags, sizeof(HlsSegment));
+
+    char line[HLS_LINE_MAX];
+    char value[HLS_LINE_MAX];
+    HlsVariant *variant = NULL;     // EXT-X-STREAM-INF waiting for its URI
+    double duration = -1;           // EXTINF waiting for its URI
+
+    while (next_line(&text, line, sizeof(line))) {
+        if (line[0] == '\0') continue;
+
+        if (strncmp(line, "#EXT-X-STREAM-INF:", 18) == 0) {
+            variant = &playlist->variants[playlist->variant_count];
+            memset(variant, 0, sizeof(HlsVariant));
+            if (attribute(line + 18, "BANDWIDTH", value, sizeof(value))) {
+                variant->bandwidth = atol(value);
+            }
+            if (attribute(line + 18, "RESOLUTION", value, sizeof(value))) {
+                sscanf(value, "%dx%d", &variant->width, &variant->height);
+            }
+        } else if (strncmp(line, "#EXTINF:", 8) == 0) {
+            duration = atof(line + 8);
+        } else if (strncmp(line, "#EXT-X-KEY:", 11) == 0) {
+            if (!attribute(line + 11, "METHOD", value, sizeof(value)) || strcasecmp(value, "NONE") != 0) {
+                playlist->encrypted = true;
+            }
+        } else if (strncmp(line, "#EXT-X-MAP:", 11) == 0) {
+            if (attribute(line + 11, "URI", value, sizeof(value))) {
+                playlist->map_uri = resolve_into(arena, base_url, value);
+            }
+            if (attribute(line + 11, "BYTERANGE", value, sizeof(value))) {
+                playlist->byte_ranges = true;
+            }
+        } else if (strncmp(line, "#EXT-X-BYTERANGE:", 17) == 0) {
+            playlist->byte_ranges = true;
+        } else if (line[0] == '#') {
+            continue; // Comments and tags that do not change what gets downloaded
+        } else if (variant) {
+            variant->uri = resolve_into(arena, base_url, line);
+            playlist->variant_count++;
+            variant = NULL;
+        } else if (duration >= 0) {
+            HlsSegment *segment = &playlist->segments[playlist->segment_count++];
+            segment->uri = resolve_into(arena, base_url, line);
+            segment->duration = duration;
+            duration = -1;
+        }
+    }
+
+    playlist->is_master = playlist->variant_count > 0;
+    return playlist;
+}
+
+const HlsVariant* hls_best_variant(const HlsPlaylist *playlist) {
+    if (!playlist || playlist->variant_count == 0) return NULL;
+
+    const HlsVariant *best = &playlist->variants[0];
+    for (int i = 1; i < playlist->variant_count; i++) {
+        const HlsVariant *variant = &playlist->variants[i];
+        if (variant->bandwidth > best->bandwidth ||
+            (variant->bandwidth == best->bandwidth &&
+             variant->width * variant->height > best->width * best->height)) {
+            best = variant;
+        }
+    }
+    return best;
+}
+
+void hls_free(HlsPlaylist *playlist) {
+    if (!playlist) return;
+
+    // Releases the structure along with every string it points to
+    arena_destroy(playlist->arena);
+}
@@ -0,0 +1,54 @@
+#ifndef HLS_H
+#define HLS_H
+
+#include <stdbool.h>
+
+// One rendition listed by a master playlist
+typedef struct {
+    char *uri;          // Absolute URL of its media playlist
+    long bandwidth;     // Peak bits per second, 0 when not given
+    int width;
+    int height;
+} HlsVariant;
+
+// One piece of a media playlist
+typedef struct {
+    char *uri;          // Absolute URL
+    double duration;    // Seconds
+} HlsSegment;
+
+// Parsed HLS playlist: either a master (variants) or a media playlist (segments)
+typedef struct {
+    bool is_master;
+    HlsVariant *variants;
+    int variant_count;
+    HlsSegment *segments;
+    int segment_count;
+    char *map_uri;      // EXT-X-MAP initialisation section to put before the segments, or NULL
+    bool encrypted;     // Segments are encrypted (EXT-X-KEY other than METHOD=NONE)
+    bool byte_ranges;   // Segments are byte ranges of shared files (EXT-X-BYTERANGE)
+    struct Arena *arena;  // Owns the structure and everything it points to
+} HlsPlaylist;
+
+/**
+ * Parse a playlist
+ * @param text Playlist body
+ * @param base_url URL the playlist was fetched from, to resolve relative URIs against
+ * @return The playlist (free with hls_free) or NULL if text is not an HLS playlist
+ */
+HlsPlaylist* hls_parse(const char *text, const char *base_url);
+
+// Variant with the highest bandwidth (largest picture on ties), or NULL without variants
+const HlsVariant* hls_best_variant(const HlsPlaylist *playlist);
+
+/**
+ * Resolve a URI found in a playlist
+ * @param base_url URL of the playlist
+ * @param uri Absolute, scheme-relative, host-relative or path-relative reference
+ * @return Newly allocated absolute URL (must be freed) or NULL on error
+ */
+char* hls_resolve_url(const char *base_url, const char *uri);
+
+void hls_free(HlsPlaylist *playlist);
+
+#endif /* HLS_H */
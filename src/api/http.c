@@ -0,0 +1,1079 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <curl/curl.h>
+#include <json-c/json.h>
+#include "http.h"
+#include "cache.h"
+#include "cancel.h"
+#include "json_stream.h"
+#include "metrics.h"
+#include "../utils/memory.h"
+
+#define HTTP_POOL_SIZE 8
+#define HTTP_USER_AGENT "Mozilla/5.0"
+#define HTTP_TIMEOUT_SECONDS 15L
+#define HTTP_CONNECT_TIMEOUT_SECONDS 10L
+#define HTTP_WAIT_TICK_MS 100
+#define HTTP_READ_CHUNK 16384
+#define HTTP_MAX_HOST_CONNECTIONS 6
+
+struct HttpRequest {
+    CURL *curl;
+    HttpResponse response;
+    CURLcode result;
+    bool done;
+    HttpCompleteCallback on_complete;
+    void *userdata;
+    struct curl_slist *headers;
+    char *etag;
+    char *last_modified;
+
+    // Incremental JSON parsing of the body (NULL for plain requests)
+    struct json_tokener *tokener;
+    struct json_object *json;
+    bool parse_failed;
+    JsonSplitter *splitter;  // Hands out the elements of one array as they arrive (not owned)
+
+    // Body streamed to the response cache on a 200 (NULL when not caching)
+    char *cache_url;
+    CacheWriter *cache_writer;
+
+    // Body written straight to disk (NULL for in-memory requests)
+    FILE *file;
+    char *path;
+    char *part_path;
+
+    // Source the request is attributed to and time spent parsing its body
+    const char *metrics_source;
+    double parse_ms;
+
+    // Token of the operation the request belongs to (NULL if it cannot be cancelled)
+    CancelToken *cancel;
+
+    // Entry in the list of transfers in flight (guarded by progress_lock)
+    bool tracked;
+    bool background;
+    char *url;
+    struct HttpRequest *progress_prev;
+    struct HttpRequest *progress_next;
+    double started_ms;
+    long long downloaded;
+    long long total;
+};
+
+// Shared DNS cache and TLS session cache
+// Connections stay with the thread's multi handle: a transfer queued behind
+// the per-host limit is only restarted when a connection of its own multi
+// frees up, so a shared connection pool left it waiting forever once other
+// threads held the host's connections. Pool workers live as long as the
+// process and keep their connections alive across tasks instead.
+static CURLSH *share = NULL;
+static pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+
+// Idle easy handles ready for reuse
+static CURL *handle_pool[HTTP_POOL_SIZE];
+static int pool_count = 0;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Multi handle driving the calling thread's in-flight transfers
+static __thread CURLM *multi = NULL;
+static __thread int running_count = 0;
+
+// Hook run while the calling thread's blocking calls wait
+static __thread HttpWaitHook wait_hook = NULL;
+static __thread int wait_fd = -1;
+static __thread void *wait_ctx = NULL;
+
+// Token attached to the requests this thread starts
+static __thread CancelToken *cancel_token = NULL;
+
+// The requests this thread starts are bulk transfers nobody is waiting on
+static __thread bool background = false;
+
+static bool initialized = false;
+
+// Transfers in flight on every thread, oldest first
+static HttpRequest *progress_head = NULL;
+static HttpRequest *progress_tail = NULL;
+static int foreground_count = 0;
+static pthread_mutex_t progress_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp) {
+    (void)handle;
+    (void)access;
+    (void)userp;
+    pthread_mutex_lock(&share_locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userp) {
+    (void)handle;
+    (void)userp;
+    pthread_mutex_unlock(&share_locks[data]);
+}
+
+static size_t append_body(HttpResponse *mem, const void *contents, size_t realsize) {
+    char *ptr = realloc(mem->data, mem->size + realsize + 1);
+    if (!ptr) {
+        fprintf(stderr, "Not enough memory (realloc returned NULL)\n");
+        return 0;
+    }
+
+    mem->data = ptr;
+    memcpy(&(mem->data[mem->size]), contents, realsize);
+    mem->size += realsize;
+    mem->data[mem->size] = 0;
+
+    return realsize;
+}
+
+// Feed one chunk to a tokener; false once the input cannot be valid JSON
+static bool feed_json(struct json_tokener *tokener, struct json_object **json,
+                      const char *data, size_t len) {
+    // Anything after the complete value is trailing whitespace
+    if (*json) {
+        return true;
+    }
+
+    *json = json_tokener_parse_ex(tokener, data, (int)len);
+    return *json || json_tokener_get_error(tokener) == json_tokener_continue;
+}
+
+// Parse a cached body in chunks, closing the file
+static struct json_object* parse_json_file(FILE *file, JsonSplitter *splitter) {
+    struct json_tokener *tokener = json_tokener_new();
+    struct json_object *json = NULL;
+    char buffer[HTTP_READ_CHUNK];
+    size_t n;
+
+    while (tokener && !json && (n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bool valid = splitter ? json_splitter_feed(splitter, tokener, &json, buffer, n)
+                              : feed_json(tokener, &json, buffer, n);
+        if (!valid) break;
+    }
+
+    json_tokener_free(tokener);
+    fclose(file);
+    return json;
+}
+
+static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    HttpRequest *request = (HttpRequest *)userp;
+
+    // Only complete 200 bodies are worth caching; decide on the first chunk
+    if (request->cache_url && !request->cache_writer) {
+        long status = 0;
+        curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &status);
+        if (status == 200) {
+            request->cache_writer = cache_writer_open(request->cache_url,
+                                                      request->etag, request->last_modified);
+        }
+        if (!request->cache_writer) {
+            free(request->cache_url);
+            request->cache_url = NULL;
+        }
+    }
+    if (request->cache_writer) {
+        cache_writer_write(request->cache_writer, contents, realsize);
+    }
+
+    if (request->file) {
+        return fwrite(contents, 1, realsize, request->file);
+    }
+
+    if (!request->tokener) {
+        return append_body(&request->response, contents, realsize);
+    }
+
+    // Parse while the transfer runs instead of buffering the whole body
+    double started = metrics_now_ms();
+    bool valid = request->splitter
+        ? json_splitter_feed(request->splitter, request->tokener, &request->json, contents, realsize)
+        : feed_json(request->tokener, &request->json, contents, realsize);
+    request->parse_ms += metrics_now_ms() - started;
+    if (!valid) {
+        request->parse_failed = true;
+        return 0;
+    }
+    request->response.size += realsize;
+    return realsize;
+}
+
+// Copy a header value without the trailing CRLF
+static char* header_value(const char *line, size_t len, size_t name_len) {
+    const char *start = line + name_len;
+    const char *end = line + len;
+
+    while (start < end && isspace((unsigned char)*start)) start++;
+    while (end > start && isspace((unsigned char)end[-1])) end--;
+
+    char *value = safe_malloc(end - start + 1);
+    memcpy(value, start, end - start);
+    value[end - start] = '\0';
+    return value;
+}
+
+// Capture the validators the response cache needs
+static size_t HeaderCallback(char *buffer, size_t size, size_t nitems, void *userp) {
+    size_t len = size * nitems;
+    HttpRequest *request = (HttpRequest *)userp;
+
+    if (len > 5 && strncasecmp(buffer, "ETag:", 5) == 0) {
+        free(request->etag);
+        request->etag = header_value(buffer, len, 5);
+    } else if (len > 14 && strncasecmp(buffer, "Last-Modified:", 14) == 0) {
+        free(request->last_modified);
+        request->last_modified = header_value(buffer, len, 14);
+    }
+
+    return len;
+}
+
+// Record how far a transfer got; curl calls this on the request's own thread
+static int ProgressCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow,
+                            curl_off_t ultotal, curl_off_t ulnow) {
+    (void)ultotal;
+    (void)ulnow;
+    HttpRequest *request = (HttpRequest *)clientp;
+
+    pthread_mutex_lock(&progress_lock);
+    request->downloaded = (long long)dlnow;
+    request->total = (long long)dltotal;
+    pthread_mutex_unlock(&progress_lock);
+
+    // Non-zero makes curl drop the transfer and its connection right away
+    return cancel_token_cancelled(request->cancel) ? 1 : 0;
+}
+
+static void track_progress(HttpRequest *request, const char *url) {
+    request->url = strdup(url);
+    if (!request->url) return;  // Runs untracked
+    request->started_ms = metrics_now_ms();
+
+    pthread_mutex_lock(&progress_lock);
+    request->progress_prev = progress_tail;
+    request->progress_next = NULL;
+    if (progress_tail) progress_tail->progress_next = request;
+    else progress_head = request;
+    progress_tail = request;
+    request->tracked = true;
+    if (!request->background) foreground_count++;
+    pthread_mutex_unlock(&progress_lock);
+}
+
+static void untrack_progress(HttpRequest *request) {
+    if (!request->tracked) return;
+
+    pthread_mutex_lock(&progress_lock);
+    if (request->progress_prev) request->progress_prev->progress_next = request->progress_next;
+    else progress_head = request->progress_next;
+    if (request->progress_next) request->progress_next->progress_prev = request->progress_prev;
+    else progress_tail = request->progress_prev;
+    request->tracked = false;
+    if (!request->background) foreground_count--;
+    pthread_mutex_unlock(&progress_lock);
+}
+
+// Apply the options every request shares
+static void configure_handle(CURL *curl) {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, HTTP_USER_AGENT);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, HTTP_TIMEOUT_SECONDS);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, HTTP_CONNECT_TIMEOUT_SECONDS);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+}
+
+static CURL* acquire_handle() {
+    CURL *curl = NULL;
+
+    pthread_mutex_lock(&pool_lock);
+    if (pool_count > 0) {
+        curl = handle_pool[--pool_count];
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (!curl) {
+        curl = curl_easy_init();
+        if (!curl) {
+            fprintf(stderr, "Failed to initialize curl\n");
+            return NULL;
+        }
+    }
+
+    configure_handle(curl);
+    return curl;
+}
+
+static void release_handle(CURL *curl) {
+    // Reset per-request options; the handle keeps its live connections
+    curl_easy_reset(curl);
+
+    pthread_mutex_lock(&pool_lock);
+    if (pool_count < HTTP_POOL_SIZE) {
+        handle_pool[pool_count++] = curl;
+        curl = NULL;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (curl) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+// curl_global_init is not thread-safe: it runs here once, under this lock,
+// and never per request
+static pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool init_locked() {
+    if (initialized) {
+        return true;
+    }
+
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        fprintf(stderr, "Failed to initialize libcurl\n");
+        return false;
+    }
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&share_locks[i], NULL);
+    }
+
+    share = curl_share_init();
+    if (!share) {
+        fprintf(stderr, "Failed to initialize curl share\n");
+        curl_global_cleanup();
+        return false;
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    initialized = true;
+    return true;
+}
+
+bool http_init() {
+    pthread_mutex_lock(&init_lock);
+    bool ok = init_locked();
+    pthread_mutex_unlock(&init_lock);
+    return ok;
+}
+
+// Create the calling thread's multi handle on first use
+static CURLM* thread_multi() {
+    if (!multi) {
+        multi = curl_multi_init();
+        if (!multi) {
+            fprintf(stderr, "Failed to initialize curl multi handle\n");
+            return NULL;
+        }
+
+        // Extra transfers to one host queue in the order they were started
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)HTTP_MAX_HOST_CONNECTIONS);
+    }
+    return multi;
+}
+
+void http_thread_cleanup() {
+    if (multi) {
+        curl_multi_cleanup(multi);
+        multi = NULL;
+    }
+    running_count = 0;
+}
+
+void http_cleanup() {
+    pthread_mutex_lock(&init_lock);
+    if (!initialized) {
+        pthread_mutex_unlock(&init_lock);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    for (int i = 0; i < pool_count; i++) {
+        curl_easy_cleanup(handle_pool[i]);
+    }
+    pool_count = 0;
+    pthread_mutex_unlock(&pool_lock);
+
+    http_thread_cleanup();
+
+    curl_share_cleanup(share);
+    share = NULL;
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&share_locks[i]);
+    }
+
+    curl_global_cleanup();
+    initialized = false;
+    pthread_mutex_unlock(&init_lock);
+}
+
+// Queue a request with optional extra request headers (ownership is taken)
+static HttpRequest* start_request(const char *url, struct curl_slist *headers,
+                                  HttpCompleteCallback on_complete, void *userdata) {
+    if (!initialized || !thread_multi() || cancel_token_cancelled(cancel_token)) {
+        curl_slist_free_all(headers);
+        return NULL;
+    }
+
+    HttpRequest *request = calloc(1, sizeof(HttpRequest));
+    if (!request) {
+        fprintf(stderr, "Failed to allocate memory for HTTP request\n");
+        curl_slist_free_all(headers);
+        return NULL;
+    }
+
+    request->curl = acquire_handle();
+    if (!request->curl) {
+        curl_slist_free_all(headers);
+        free(request);
+        return NULL;
+    }
+
+    request->on_complete = on_complete;
+    request->userdata = userdata;
+    request->headers = headers;
+    request->metrics_source = metrics_current_source();
+    request->cancel = cancel_token_ref(cancel_token);
+    request->background = background;
+
+    curl_easy_setopt(request->curl, CURLOPT_URL, url);
+    curl_easy_setopt(request->curl, CURLOPT_WRITEDATA, (void *)request);
+    curl_easy_setopt(request->curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(request->curl, CURLOPT_HEADERDATA, (void *)request);
+    curl_easy_setopt(request->curl, CURLOPT_PRIVATE, (void *)request);
+    curl_easy_setopt(request->curl, CURLOPT_XFERINFODATA, (void *)request);
+    if (headers) {
+        curl_easy_setopt(request->curl, CURLOPT_HTTPHEADER, headers);
+    }
+
+    if (curl_multi_add_handle(multi, request->curl) != CURLM_OK) {
+        fprintf(stderr, "Failed to queue HTTP request\n");
+        release_handle(request->curl);
+        curl_slist_free_all(headers);
+        cancel_token_free(request->cancel);
+        free(request);
+        return NULL;
+    }
+    running_count++;
+    track_progress(request, url);
+
+    return request;
+}
+
+HttpRequest* http_request_start(const char *url, HttpCompleteCallback on_complete, void *userdata) {
+    return start_request(url, NULL, on_complete, userdata);
+}
+
+// Wait for a set of requests, running the wait hook between polls
+static bool wait_for_requests(HttpRequest **requests, int count) {
+    while (1) {
+        // Transfers aborted by a cancel complete too, but their results are moot
+        if (cancel_token_cancelled(cancel_token)) {
+            return false;
+        }
+
+        bool all_done = true;
+        for (int i = 0; i < count; i++) {
+            if (requests[i] && !requests[i]->done) {
+                all_done = false;
+                break;
+            }
+        }
+        if (all_done) {
+            return true;
+        }
+
+        http_poll(HTTP_WAIT_TICK_MS, wait_fd);
+
+        if (wait_hook && !wait_hook(wait_ctx)) {
+            return false;
+        }
+    }
+}
+
+// Headers for hosts that only answer the client a stream was resolved for
+static struct curl_slist* client_headers(const char *referer, const char *user_agent) {
+    struct curl_slist *headers = NULL;
+    char header[1024];
+    if (referer) {
+        snprintf(header, sizeof(header), "Referer: %s", referer);
+        headers = curl_slist_append(headers, header);
+    }
+    if (user_agent) {
+        snprintf(header, sizeof(header), "User-Agent: %s", user_agent);
+        headers = curl_slist_append(headers, header);
+    }
+    return headers;
+}
+
+HttpRequest* http_download_start(const char *url, const char *referer, const char *user_agent, const char *path,
+                                 HttpCompleteCallback on_complete, void *userdata) {
+    char *part_path = safe_malloc(strlen(path) + sizeof(".part"));
+    sprintf(part_path, "%s.part", path);
+
+    FILE *file = fopen(part_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to create %s\n", part_path);
+        free(part_path);
+        return NULL;
+    }
+
+    HttpRequest *request = start_request(url, client_headers(referer, user_agent), on_complete, userdata);
+    if (!request) {
+        fclose(file);
+        unlink(part_path);
+        free(part_path);
+        return NULL;
+    }
+
+    // Error pages must not end up on disk as images
+    curl_easy_setopt(request->curl, CURLOPT_FAILONERROR, 1L);
+
+    // Big files take long on slow links: give up on a stalled transfer instead
+    curl_easy_setopt(request->curl, CURLOPT_TIMEOUT, 0L);
+    curl_easy_setopt(request->curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(request->curl, CURLOPT_LOW_SPEED_TIME, HTTP_TIMEOUT_SECONDS);
+    request->file = file;
+    request->path = safe_strdup(path);
+    request->part_path = part_path;
+    return request;
+}
+
+// Publish a finished download, or drop the partial file
+static void finish_download(HttpRequest *request) {
+    bool ok = fclose(request->file) == 0 && request->result == CURLE_OK;
+    request->file = NULL;
+
+    if (ok && rename(request->part_path, request->path) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        unlink(request->part_path);
+        if (request->result == CURLE_OK) {
+            request->result = CURLE_WRITE_ERROR;
+        }
+    }
+}
+
+bool http_get(const char *url, HttpResponse *response) {
+    return http_get_as(url, NULL, NULL, response);
+}
+
+bool http_get_as(const char *url, const char *referer, const char *user_agent, HttpResponse *response) {
+    response->data = NULL;
+    response->size = 0;
+    response->status_code = 0;
+
+    HttpRequest *request = start_request(url, client_headers(referer, user_agent), NULL, NULL);
+    if (!request) {
+        return false;
+    }
+
+    if (!wait_for_requests(&request, 1)) {
+        http_request_free(request);
+        return false;
+    }
+
+    bool ok = http_request_succeeded(request);
+    if (ok) {
+        http_request_take_response(request, response);
+    } else {
+        fprintf(stderr, "curl request failed: %s\n", curl_easy_strerror(request->result));
+    }
+    http_request_free(request);
+
+    return ok;
+}
+
+static double info_ms(CURL *curl, CURLINFO info) {
+    curl_off_t us = 0;
+    curl_easy_getinfo(curl, info, &us);
+    return us / 1000.0;
+}
+
+// Record the timings of a finished transfer
+static void record_request(HttpRequest *request) {
+    RequestMetrics sample = {0};
+    sample.namelookup_ms = info_ms(request->curl, CURLINFO_NAMELOOKUP_TIME_T);
+    sample.connect_ms = info_ms(request->curl, CURLINFO_CONNECT_TIME_T);
+    sample.appconnect_ms = info_ms(request->curl, CURLINFO_APPCONNECT_TIME_T);
+    sample.starttransfer_ms = info_ms(request->curl, CURLINFO_STARTTRANSFER_TIME_T);
+    sample.total_ms = info_ms(request->curl, CURLINFO_TOTAL_TIME_T);
+    sample.parse_ms = request->parse_ms;
+
+    curl_off_t bytes = 0;
+    curl_easy_getinfo(request->curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    sample.bytes = bytes;
+    sample.status = request->response.status_code;
+    sample.failed = request->result != CURLE_OK || sample.status >= 400;
+
+    metrics_record_request(request->metrics_source, &sample);
+}
+
+// Parse a stored body, timing it for the metrics
+static struct json_object* parse_cached(FILE *file, HttpRequest *request, JsonSplitter *splitter) {
+    double started = metrics_now_ms();
+    struct json_object *json = parse_json_file(file, splitter);
+    double elapsed = metrics_now_ms() - started;
+
+    // A revalidated entry counts as that request's parse time
+    if (request) {
+        request->parse_ms += elapsed;
+    } else {
+        RequestMetrics sample = {0};
+        sample.parse_ms = elapsed;
+        sample.cached = true;
+        metrics_record_request(metrics_current_source(), &sample);
+    }
+    return json;
+}
+
+// Start a request whose body is parsed as JSON while it downloads
+static HttpRequest* start_json_request(const char *url, struct curl_slist *headers, bool cache,
+                                       JsonSplitter *splitter) {
+    HttpRequest *request = start_request(url, headers, NULL, NULL);
+    if (!request) {
+        return NULL;
+    }
+
+    // Nothing has been transferred yet, the write callback only runs in http_poll
+    request->tokener = json_tokener_new();
+    request->splitter = splitter;
+    if (cache) {
+        request->cache_url = safe_strdup(url);
+    }
+    return request;
+}
+
+// One JSON document being fetched through the response cache
+typedef struct {
+    const char *url;
+    JsonSplitter *splitter;
+    CacheEntry entry;
+    FILE *cached;
+    bool use_cache;
+    HttpRequest *request;       // NULL when answered from the cache or failed to start
+    struct json_object *json;
+    bool ok;
+} JsonFetch;
+
+// Answer from a fresh cache entry, or start the request (revalidating a stale one)
+static void json_fetch_begin(JsonFetch *fetch, const char *url, int ttl_seconds, JsonSplitter *splitter) {
+    memset(fetch, 0, sizeof(JsonFetch));
+    fetch->url = url;
+    fetch->splitter = splitter;
+
+    fetch->use_cache = ttl_seconds > 0 && cache_is_enabled();
+    fetch->cached = fetch->use_cache ? cache_open(url, &fetch->entry) : NULL;
+
+    // Fresh entries never touch the network
+    if (fetch->cached && time(NULL) - fetch->entry.stored_at < ttl_seconds) {
+        fetch->json = parse_cached(fetch->cached, NULL, splitter);
+        fetch->cached = NULL;
+        fetch->ok = true;
+        return;
+    }
+
+    // Stale entries are revalidated with their validators
+    struct curl_slist *headers = NULL;
+    char header[1024];
+    if (fetch->cached && fetch->entry.etag) {
+        snprintf(header, sizeof(header), "If-None-Match: %s", fetch->entry.etag);
+        headers = curl_slist_append(headers, header);
+    }
+    if (fetch->cached && fetch->entry.last_modified) {
+        snprintf(header, sizeof(header), "If-Modified-Since: %s", fetch->entry.last_modified);
+        headers = curl_slist_append(headers, header);
+    }
+
+    fetch->request = start_json_request(url, headers, fetch->use_cache, splitter);
+    if (fetch->request && !fetch->request->tokener) {
+        http_request_free(fetch->request);
+        fetch->request = NULL;
+    }
+}
+
+// Why a finished JSON request gave no usable answer
+static void report_json_failure(const HttpRequest *request, const char *url, const char *consequence) {
+    if (request->result != CURLE_OK && !request->parse_failed) {
+        fprintf(stderr, "curl request failed%s: %s\n", consequence, curl_easy_strerror(request->result));
+    } else {
+        fprintf(stderr, "HTTP %ld from %s%s\n", request->response.status_code, url, consequence);
+    }
+}
+
+// Take the outcome of a finished (or, when !completed, abandoned) request
+// and release the fetch; one answered from the cache keeps its result
+static void json_fetch_finish(JsonFetch *fetch, bool completed) {
+    HttpRequest *request = fetch->request;
+
+    if (request && completed) {
+        long status = request->response.status_code;
+        bool transferred = http_request_succeeded(request) || request->parse_failed;
+
+        // A server error, or an error page that is not JSON, is no answer
+        bool ok = transferred && status < 500 &&
+                  !(request->parse_failed && (status < 200 || status >= 300));
+
+        if (ok && status == 304 && fetch->cached) {
+            // Still valid: restart the TTL and parse the stored body
+            cache_refresh(fetch->url);
+            fetch->json = parse_cached(fetch->cached, request, fetch->splitter);
+            fetch->cached = NULL;
+        } else if (ok) {
+            fetch->json = request->json;
+            request->json = NULL;
+
+            // Publish the streamed copy only if it parsed completely
+            if (fetch->json && request->cache_writer) {
+                cache_writer_commit(request->cache_writer);
+                request->cache_writer = NULL;
+            }
+        } else if (fetch->cached) {
+            // Offline or server error: a stale answer beats none
+            report_json_failure(request, fetch->url, ", serving stale cache");
+            if (fetch->splitter) json_splitter_restart(fetch->splitter);
+            fetch->json = parse_cached(fetch->cached, request, fetch->splitter);
+            fetch->cached = NULL;
+            ok = true;
+        } else {
+            report_json_failure(request, fetch->url, "");
+        }
+
+        fetch->ok = ok;
+        record_request(request);
+    }
+
+    http_request_free(request);
+    fetch->request = NULL;
+    if (fetch->cached) fclose(fetch->cached);
+    fetch->cached = NULL;
+    cache_entry_free(&fetch->entry);
+}
+
+// Shared by http_get_json and http_get_json_split (splitter may be NULL)
+static bool get_json(const char *url, int ttl_seconds, JsonSplitter *splitter, struct json_object **json) {
+    JsonFetch fetch;
+    json_fetch_begin(&fetch, url, ttl_seconds, splitter);
+
+    bool completed = fetch.request && wait_for_requests(&fetch.request, 1);
+    json_fetch_finish(&fetch, completed);
+
+    *json = fetch.json;
+    return fetch.ok;
+}
+
+bool http_get_json(const char *url, int ttl_seconds, struct json_object **json) {
+    return get_json(url, ttl_seconds, NULL, json);
+}
+
+bool http_get_json_split(const char *url, int ttl_seconds, const char *const *array_path,
+                         JsonElementCallback on_element, void *ctx, struct json_object **json) {
+    *json = NULL;
+
+    JsonSplitter *splitter = json_splitter_new(array_path, on_element, ctx);
+    if (!splitter) {
+        return false;
+    }
+
+    bool ok = get_json(url, ttl_seconds, splitter, json);
+    json_splitter_free(splitter);
+    return ok;
+}
+
+bool http_get_json_many(const char *const *urls, const int *ttl_seconds, const HttpJsonSplit *splits,
+                        struct json_object **json, bool *ok, int count) {
+    JsonFetch *fetches = calloc(count, sizeof(JsonFetch));
+    HttpRequest **requests = calloc(count, sizeof(HttpRequest*));
+    JsonSplitter **splitters = calloc(count, sizeof(JsonSplitter*));
+    if (!fetches || !requests || !splitters) {
+        free(fetches);
+        free(requests);
+        free(splitters);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (splits && splits[i].array_path) {
+            splitters[i] = json_splitter_new(splits[i].array_path, splits[i].on_element, splits[i].ctx);
+            if (!splitters[i]) continue; // Left failed
+        }
+        json_fetch_begin(&fetches[i], urls[i], ttl_seconds[i], splitters[i]);
+        requests[i] = fetches[i].request;
+
+        // Over TLS, ALPN tells during the handshake whether the host multiplexes
+        // (HTTP/2): the others wait to share that connection instead of racing
+        // handshakes of their own. Plain HTTP only learns it from the response,
+        // so waiting there would put the requests back in sequence.
+        if (requests[i] && strncmp(urls[i], "https://", 8) == 0) {
+            curl_easy_setopt(requests[i]->curl, CURLOPT_PIPEWAIT, 1L);
+        }
+    }
+
+    bool completed = wait_for_requests(requests, count);
+
+    for (int i = 0; i < count; i++) {
+        json_fetch_finish(&fetches[i], completed);
+        json[i] = fetches[i].json;
+        ok[i] = fetches[i].ok;
+        if (!completed && json[i]) {
+            // An aborted wait hands out nothing, like the single calls
+            json_object_put(json[i]);
+            json[i] = NULL;
+            ok[i] = false;
+        }
+        json_splitter_free(splitters[i]);
+    }
+
+    free(fetches);
+    free(requests);
+    free(splitters);
+    return completed;
+}
+
+bool http_get_many(const char **urls, HttpResponse *responses, bool *ok, int count) {
+    HttpRequest **requests = calloc(count, sizeof(HttpRequest*));
+    if (!requests) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        responses[i].data = NULL;
+        responses[i].size = 0;
+        responses[i].status_code = 0;
+        ok[i] = false;
+        requests[i] = http_request_start(urls[i], NULL, NULL);
+    }
+
+    bool completed = wait_for_requests(requests, count);
+
+    for (int i = 0; i < count; i++) {
+        if (!requests[i]) continue;
+
+        if (completed && http_request_succeeded(requests[i])) {
+            http_request_take_response(requests[i], &responses[i]);
+            ok[i] = true;
+        }
+        http_request_free(requests[i]);
+    }
+
+    free(requests);
+    return completed;
+}
+
+bool http_request_done(const HttpRequest *request) {
+    return request && request->done;
+}
+
+bool http_request_succeeded(const HttpRequest *request) {
+    return request && request->done && request->result == CURLE_OK;
+}
+
+void http_request_take_response(HttpRequest *request, HttpResponse *response) {
+    *response = request->response;
+
+    // Keep callers that parse the body safe on empty responses
+    if (!response->data) {
+        response->data = safe_strdup("");
+    }
+
+    request->response.data = NULL;
+    request->response.size = 0;
+}
+
+void http_request_free(HttpRequest *request) {
+    if (!request) return;
+
+    untrack_progress(request);
+
+    if (request->curl) {
+        if (!request->done) {
+            curl_multi_remove_handle(multi, request->curl);
+            running_count--;
+        }
+        release_handle(request->curl);
+    }
+
+    http_response_free(&request->response);
+    curl_slist_free_all(request->headers);
+    if (request->tokener) json_tokener_free(request->tokener);
+    if (request->json) json_object_put(request->json);
+    cache_writer_abort(request->cache_writer);
+    free(request->cache_url);
+    if (request->file) {
+        fclose(request->file);
+        unlink(request->part_path);
+    }
+    free(request->path);
+    free(request->part_path);
+    free(request->etag);
+    free(request->last_modified);
+    free(request->url);
+    cancel_token_free(request->cancel);
+    free(request);
+}
+
+// Collect finished transfers and notify their owners
+static void process_completions() {
+    CURLMsg *msg;
+    int queued;
+
+    while ((msg = curl_multi_info_read(multi, &queued))) {
+        if (msg->msg != CURLMSG_DONE) continue;
+
+        HttpRequest *request = NULL;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&request);
+        if (!request) continue;
+
+        request->result = msg->data.result;
+        curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &request->response.status_code);
+        curl_multi_remove_handle(multi, request->curl);
+        running_count--;
+        request->done = true;
+        untrack_progress(request);
+
+        if (request->file) {
+            finish_download(request);
+        }
+
+        // JSON requests are recorded once their body has been parsed
+        if (!request->tokener) {
+            record_request(request);
+        }
+
+        if (request->on_complete) {
+            request->on_complete(request, request->userdata);
+        }
+    }
+}
+
+int http_poll(int timeout_ms, int extra_fd) {
+    if (!initialized || running_count == 0) {
+        return 0;
+    }
+
+    int still_running = 0;
+    curl_multi_perform(multi, &still_running);
+    process_completions();
+
+    if (running_count > 0) {
+        struct curl_waitfd extra;
+        extra.fd = extra_fd;
+        extra.events = CURL_WAIT_POLLIN;
+        extra.revents = 0;
+
+        curl_multi_poll(multi, extra_fd >= 0 ? &extra : NULL, extra_fd >= 0 ? 1 : 0,
+                        timeout_ms, NULL);
+        curl_multi_perform(multi, &still_running);
+        process_completions();
+    }
+
+    return running_count;
+}
+
+int http_pending() {
+    return running_count;
+}
+
+void http_set_cancel_token(CancelToken *token) {
+    cancel_token = token;
+}
+
+void http_set_background(bool enabled) {
+    background = enabled;
+}
+
+int http_foreground_pending() {
+    pthread_mutex_lock(&progress_lock);
+    int count = foreground_count;
+    pthread_mutex_unlock(&progress_lock);
+    return count;
+}
+
+void http_set_wait_hook(HttpWaitHook hook, int wake_fd, void *ctx) {
+    wait_hook = hook;
+    wait_fd = wake_fd;
+    wait_ctx = ctx;
+}
+
+int http_progress_snapshot(HttpTransferProgress *transfers, int max) {
+    double now = metrics_now_ms();
+    int count = 0;
+
+    pthread_mutex_lock(&progress_lock);
+    for (HttpRequest *request = progress_head; request && count < max; request = request->progress_next) {
+        if (request->background) continue;
+
+        HttpTransferProgress *transfer = &transfers[count++];
+        snprintf(transfer->url, sizeof(transfer->url), "%s", request->url);
+        transfer->downloaded = request->downloaded;
+        transfer->total = request->total;
+        transfer->elapsed_ms = now - request->started_ms;
+        transfer->bytes_per_second = transfer->elapsed_ms > 0 ?
+                                     request->downloaded * 1000.0 / transfer->elapsed_ms : 0;
+    }
+    pthread_mutex_unlock(&progress_lock);
+    return count;
+}
+
+bool http_wait_fd(int fd, int timeout_ms) {
+    if (running_count > 0) {
+        http_poll(timeout_ms, fd);
+    } else {
+        struct pollfd pfds[2] = {
+            { .fd = fd, .events = POLLIN, .revents = 0 },
+            { .fd = wait_fd, .events = POLLIN, .revents = 0 }
+        };
+        poll(pfds, wait_fd >= 0 ? 2 : 1, timeout_ms);
+    }
+
+    if (cancel_token_cancelled(cancel_token)) {
+        return false;
+    }
+    return !wait_hook || wait_hook(wait_ctx);
+}
+
+char* http_escape(const char *str) {
+    if (!str) return NULL;
+
+    CURL *curl = acquire_handle();
+    if (!curl) {
+        return NULL;
+    }
+
+    char *escaped = curl_easy_escape(curl, str, 0);
+    release_handle(curl);
+
+    if (!escaped) {
+        return NULL;
+    }
+
+    char *result = safe_strdup(escaped);
+    curl_free(escaped);
+    return result;
+}
+
+void http_response_free(HttpResponse *response) {
+    if (!response) return;
+
+    free(response->data);
+    response->data = NULL;
+    response->size = 0;
+}
@@ -0,0 +1,266 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "json_stream.h"
+#include "cancel.h"
+
+struct json_object;
+
+// Response body accumulated by the HTTP client
+typedef struct {
+    char *data;
+    size_t size;
+    long status_code;
+} HttpResponse;
+
+// Non-blocking request running on the shared multi handle
+typedef struct HttpRequest HttpRequest;
+
+// Called from http_poll when a request finishes (successfully or not)
+typedef void (*HttpCompleteCallback)(HttpRequest *request, void *userdata);
+
+// Called while a blocking request waits; return false to abort it
+typedef bool (*HttpWaitHook)(void *ctx);
+
+#define HTTP_PROGRESS_URL_MAX 256
+
+// How far one in-flight transfer has got
+typedef struct {
+    char url[HTTP_PROGRESS_URL_MAX];
+    long long downloaded;    // Body bytes received so far (as sent, before decompression)
+    long long total;         // Announced length, 0 when the server did not send one
+    double elapsed_ms;       // Time since the request was started
+    double bytes_per_second; // Average rate since the start
+} HttpTransferProgress;
+
+/**
+ * Initialize the process-wide HTTP client
+ * Sets up libcurl once, the DNS and TLS session caches shared by every
+ * thread and the pool of reusable easy handles. Connections are not shared:
+ * each thread keeps its own in its multi handle.
+ * @return true on success
+ */
+bool http_init();
+
+/**
+ * Release all pooled handles and the shared cache
+ */
+void http_cleanup();
+
+/**
+ * Release the calling thread's multi handle
+ * Requests are driven per thread, so each worker thread that made requests
+ * calls this before exiting. Requests must be freed on the thread that started them.
+ */
+void http_thread_cleanup();
+
+/**
+ * Perform a GET request on a pooled handle
+ * Connections are kept alive and reused across calls to the same host.
+ * @param url The absolute URL to fetch
+ * @param response Receives the response body (release with http_response_free)
+ * @return true if the transfer completed, false on transport errors
+ */
+bool http_get(const char *url, HttpResponse *response);
+
+/**
+ * Perform a GET request as a given client
+ * Like http_get, for hosts that only answer the page and player a stream
+ * was resolved for.
+ * @param url The absolute URL to fetch
+ * @param referer Referer header, or NULL for none
+ * @param user_agent User-Agent header, or NULL for the default
+ * @param response Receives the response body (release with http_response_free)
+ * @return true if the transfer completed, false on transport errors
+ */
+bool http_get_as(const char *url, const char *referer, const char *user_agent, HttpResponse *response);
+
+// Cache lifetimes for provider endpoints, in seconds
+#define HTTP_CACHE_TTL_SEARCH (6 * 60 * 60)
+#define HTTP_CACHE_TTL_INFO (24 * 60 * 60)
+#define HTTP_CACHE_TTL_EPISODES (12 * 60 * 60)
+
+/**
+ * Perform a GET request and parse the body as JSON while it downloads
+ * Each received chunk is fed to an incremental tokener, so the body is never
+ * buffered in full. With a positive ttl_seconds the request goes through the
+ * on-disk response cache: fresh entries are parsed straight from disk, stale
+ * ones are revalidated with ETag/Last-Modified. Pass 0 for short-lived
+ * stream URLs.
+ *
+ * A request gets no answer when the transfer fails, the server answers
+ * 5xx, or a non-2xx response has a body that is not JSON. Then a stored
+ * response for the URL, however stale, is parsed and returned as if it
+ * had just arrived. Other statuses with a JSON body (a 404 with an error
+ * object, say) are answers: the body is returned as is, it is not cached,
+ * and the caller has to recognise it as an error.
+ * @param url The absolute URL to fetch
+ * @param ttl_seconds How long a stored response stays fresh, or 0 to bypass the cache
+ * @param json Receives the parsed object (release with json_object_put), NULL if the body is not valid JSON
+ * @return true if there is an answer or a stored one was served, false otherwise
+ */
+bool http_get_json(const char *url, int ttl_seconds, struct json_object **json);
+
+/**
+ * Perform a JSON GET request, handing out the elements of one array as they arrive
+ * Like http_get_json, but the array at array_path is not part of the returned
+ * document: each element is parsed on its own and passed to on_element the
+ * moment its last byte is received, so the first items of a long list can be
+ * shown while the rest is still downloading. Element indexes never repeat,
+ * even when a failed transfer falls back to the cached body.
+ * @param url The absolute URL to fetch
+ * @param ttl_seconds How long a stored response stays fresh, or 0 to bypass the cache
+ * @param array_path NULL-terminated chain of object keys leading to the array
+ * @param on_element Called with every element in order; returning false aborts the transfer
+ * @param ctx Passed to on_element
+ * @param json Receives the rest of the document (the array left empty), NULL if invalid or aborted
+ * @return As for http_get_json, including the fallback to a stale stored response
+ */
+bool http_get_json_split(const char *url, int ttl_seconds, const char *const *array_path,
+                         JsonElementCallback on_element, void *ctx, struct json_object **json);
+
+// Array of a document handed out element by element, as by http_get_json_split
+typedef struct {
+    const char *const *array_path;
+    JsonElementCallback on_element;
+    void *ctx;
+} HttpJsonSplit;
+
+/**
+ * Fetch several JSON documents concurrently, each like http_get_json
+ * Transfers to one host wait to share its connection when it multiplexes,
+ * so the documents cost one round trip together rather than one each.
+ * @param urls Array of absolute URLs
+ * @param ttl_seconds Cache lifetime per URL, 0 to bypass the cache
+ * @param splits Optional array of how to split each document (array_path NULL for a whole one)
+ * @param json Array receiving one parsed object per URL (release with json_object_put), NULL on failure
+ * @param ok Array receiving per URL what http_get_json would return
+ * @param count Number of URLs
+ * @return false if the wait was aborted by the wait hook or cancelled
+ */
+bool http_get_json_many(const char *const *urls, const int *ttl_seconds, const HttpJsonSplit *splits,
+                        struct json_object **json, bool *ok, int count);
+
+/**
+ * URL-encode a string
+ * @param str The string to encode
+ * @return Newly allocated encoded string (must be freed) or NULL on error
+ */
+char* http_escape(const char *str);
+
+// Free the body held by a response
+void http_response_free(HttpResponse *response);
+
+/**
+ * Fetch several URLs concurrently and wait for all of them
+ * @param urls Array of absolute URLs
+ * @param responses Array receiving one response per URL
+ * @param ok Array receiving the transfer result per URL
+ * @param count Number of URLs
+ * @return false if the wait was aborted by the wait hook
+ */
+bool http_get_many(const char **urls, HttpResponse *responses, bool *ok, int count);
+
+/**
+ * Start a non-blocking GET request
+ * The transfer makes progress whenever http_poll is called.
+ * @param url The absolute URL to fetch
+ * @param on_complete Optional completion callback
+ * @param userdata Passed to the callback
+ * @return The request handle (release with http_request_free) or NULL
+ */
+HttpRequest* http_request_start(const char *url, HttpCompleteCallback on_complete, void *userdata);
+
+/**
+ * Start a non-blocking download straight to a file
+ * The body goes to "<path>.part" and is renamed to path only once the
+ * transfer completed with a success status, so readers never see partial files.
+ * There is no overall time limit; a transfer stalled for the request timeout fails.
+ * @param url The absolute URL to fetch
+ * @param referer Optional Referer header (NULL for none)
+ * @param user_agent Optional User-Agent header (NULL for the default)
+ * @param path Destination file
+ * @param on_complete Optional completion callback
+ * @param userdata Passed to the callback
+ * @return The request handle (release with http_request_free) or NULL
+ */
+HttpRequest* http_download_start(const char *url, const char *referer, const char *user_agent, const char *path,
+                                 HttpCompleteCallback on_complete, void *userdata);
+
+// Check whether a request has finished
+bool http_request_done(const HttpRequest *request);
+
+// Check whether a finished request completed its transfer
+bool http_request_succeeded(const HttpRequest *request);
+
+// Move the response body out of a finished request
+void http_request_take_response(HttpRequest *request, HttpResponse *response);
+
+// Abort (if still running) and release a request
+void http_request_free(HttpRequest *request);
+
+/**
+ * Drive all in-flight requests of the calling thread
+ * Waits up to timeout_ms for socket activity or for extra_fd to become readable.
+ * @param timeout_ms Maximum time to wait
+ * @param extra_fd Additional descriptor to wake up on (e.g. stdin), or -1
+ * @return Number of requests still running
+ */
+int http_poll(int timeout_ms, int extra_fd);
+
+// Number of requests the calling thread has in flight
+int http_pending();
+
+/**
+ * Report the progress of the transfers in flight on every thread
+ * Counts come from libcurl's transfer callback, so they move while a
+ * blocking call is still waiting. Cache hits and background transfers
+ * never show up here.
+ * @param transfers Array receiving one entry per transfer, oldest first
+ * @param max Size of the array
+ * @return Number of entries written
+ */
+int http_progress_snapshot(HttpTransferProgress *transfers, int max);
+
+/**
+ * Install the hook run while the calling thread's blocking calls wait for the network
+ * @param hook Called on every wake-up; returning false aborts the wait
+ * @param wake_fd Descriptor that should wake the wait loop (e.g. stdin), or -1
+ * @param ctx Passed to the hook
+ */
+void http_set_wait_hook(HttpWaitHook hook, int wake_fd, void *ctx);
+
+/**
+ * Attach a cancellation token to the requests the calling thread starts
+ * Each request keeps a reference. Once the token is cancelled, running
+ * transfers abort from curl's progress callback (freeing their connection
+ * slot), blocking calls return false and new requests fail to start.
+ * @param token Token of the operation now running on this thread, or NULL to detach
+ */
+void http_set_cancel_token(CancelToken *token);
+
+/**
+ * Mark the requests the calling thread starts as background transfers
+ * They stay off the loading screen's transfer list and do not count in
+ * http_foreground_pending, which bulk downloads watch to make way for
+ * requests someone is waiting on.
+ * @param enabled true for bulk work such as episode downloads
+ */
+void http_set_background(bool enabled);
+
+// Number of requests in flight on every thread that are not background transfers
+int http_foreground_pending();
+
+/**
+ * Wait for a descriptor as if it were one of the calling thread's requests
+ * Keeps the thread's own requests moving and runs its wait hook, so waiting
+ * on work done by other threads stays abortable.
+ * @param fd Descriptor to wait for
+ * @param timeout_ms Maximum time to wait
+ * @return false if the wait hook asked to abort or the thread's token was cancelled
+ */
+bool http_wait_fd(int fd, int timeout_ms);
+
+#endif /* HTTP_H */
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "info_prefetch.h"
+#include "cancel.h"
+#include "http.h"
+#include "worker_pool.h"
+#include "../utils/memory.h"
+
+typedef struct PrefetchEntry PrefetchEntry;
+
+// One fetch on the pool; outlives its entry when that is evicted meanwhile
+typedef struct {
+    PrefetchEntry *entry;      // NULL once orphaned; the completion then drops the result
+    ProviderType provider;
+    char *id;                  // Shared with the entry, which takes it over on completion
+    InfoFetchFn fetch;
+    InfoReleaseFn release;
+    CancelToken *cancel;
+    void *result;
+} PrefetchJob;
+
+struct PrefetchEntry {
+    bool used;
+    ProviderType provider;
+    char *id;
+    void *info;
+    bool failed;
+    PrefetchJob *job;          // Fetch still running
+    unsigned long touched;     // Recency stamp for eviction
+};
+
+struct InfoPrefetch {
+    PrefetchEntry *entries;
+    int capacity;
+    unsigned long clock;
+    InfoFetchFn fetch;
+    InfoReleaseFn release;
+};
+
+static void run_fetch(void *ctx) {
+    PrefetchJob *job = ctx;
+    http_set_cancel_token(job->cancel);
+    if (!cancel_token_cancelled(job->cancel)) {
+        job->result = job->fetch(job->provider, job->id);
+    }
+}
+
+static void finish_fetch(void *ctx) {
+    PrefetchJob *job = ctx;
+    PrefetchEntry *entry = job->entry;
+
+    if (entry) {
+        entry->info = job->result;
+        entry->failed = !job->result;
+        entry->job = NULL;
+    } else {
+        if (job->result) job->release(job->result);
+        free(job->id);
+    }
+
+    cancel_token_free(job->cancel);
+    free(job);
+}
+
+// Empty an entry; a running fetch is cancelled and finishes on its own, keeping the id
+static void clear_entry(InfoPrefetch *prefetch, PrefetchEntry *entry) {
+    if (entry->job) {
+        entry->job->entry = NULL;
+        cancel_token_cancel(entry->job->cancel);
+    } else {
+        free(entry->id);
+    }
+    if (entry->info) {
+        prefetch->release(entry->info);
+    }
+    memset(entry, 0, sizeof(PrefetchEntry));
+}
+
+static PrefetchEntry* find_entry(const InfoPrefetch *prefetch, ProviderType provider, const char *id) {
+    if (!prefetch || !id) return NULL;
+
+    for (int i = 0; i < prefetch->capacity; i++) {
+        PrefetchEntry *entry = &prefetch->entries[i];
+        if (entry->used && entry->provider == provider && strcmp(entry->id, id) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// A free entry, or the least recently used one emptied
+static PrefetchEntry* claim_entry(InfoPrefetch *prefetch) {
+    PrefetchEntry *oldest = &prefetch->entries[0];
+    for (int i = 0; i < prefetch->capacity; i++) {
+        PrefetchEntry *entry = &prefetch->entries[i];
+        if (!entry->used) return entry;
+        if (entry->touched < oldest->touched) oldest = entry;
+    }
+
+    clear_entry(prefetch, oldest);
+    return oldest;
+}
+
+InfoPrefetch* info_prefetch_new(int capacity, InfoFetchFn fetch, InfoReleaseFn release) {
+    if (!fetch || !release) return NULL;
+    if (capacity <= 0) capacity = INFO_PREFETCH_CAPACITY;
+
+    InfoPrefetch *prefetch = calloc(1, sizeof(InfoPrefetch));
+    if (!prefetch) {
+        fprintf(stderr, "Failed to allocate memory for info prefetch\n");
+        return NULL;
+    }
+
+    prefetch->entries = calloc(capacity, sizeof(PrefetchEntry));
+    if (!prefetch->entries) {
+        fprintf(stderr, "Failed to allocate memory for info prefetch entries\n");
+        free(prefetch);
+        return NULL;
+    }
+
+    prefetch->capacity = capacity;
+    prefetch->fetch = fetch;
+    prefetch->release = release;
+    return prefetch;
+}
+
+void info_prefetch_request(InfoPrefetch *prefetch, ProviderType provider, const char *id) {
+    if (!prefetch || !id) return;
+
+    PrefetchEntry *entry = find_entry(prefetch, provider, id);
+    if (entry && !entry->failed) {
+        entry->touched = ++prefetch->clock;
+        return;
+    }
+    if (entry) {
+        clear_entry(prefetch, entry); // Failed before: try again
+    } else {
+        entry = claim_entry(prefetch);
+    }
+
+    PrefetchJob *job = calloc(1, sizeof(PrefetchJob));
+    if (!job) {
+        fprintf(stderr, "Failed to allocate memory for info prefetch job\n");
+        return;
+    }
+    job->entry = entry;
+    job->provider = provider;
+    job->id = safe_strdup(id);
+    job->fetch = prefetch->fetch;
+    job->release = prefetch->release;
+    job->cancel = cancel_token_new();
+
+    if (!job->cancel || !worker_pool_submit(run_fetch, finish_fetch, job)) {
+        free(job->id);
+        cancel_token_free(job->cancel);
+        free(job);
+        return;
+    }
+
+    entry->used = true;
+    entry->provider = provider;
+    entry->id = job->id;
+    entry->job = job;
+    entry->touched = ++prefetch->clock;
+}
+
+const void* info_prefetch_peek(InfoPrefetch *prefetch, ProviderType provider, const char *id) {
+    PrefetchEntry *entry = find_entry(prefetch, provider, id);
+    if (!entry || !entry->info) return NULL;
+
+    entry->touched = ++prefetch->clock;
+    return entry->info;
+}
+
+bool info_prefetch_loading(const InfoPrefetch *prefetch, ProviderType provider, const char *id) {
+    const PrefetchEntry *entry = find_entry(prefetch, provider, id);
+    return entry && entry->job;
+}
+
+void* info_prefetch_take(InfoPrefetch *prefetch, ProviderType provider, const char *id) {
+    PrefetchEntry *entry = find_entry(prefetch, provider, id);
+    if (!entry || !entry->info) return NULL;
+
+    void *info = entry->info;
+    entry->info = NULL;
+    clear_entry(prefetch, entry);
+    return info;
+}
+
+void info_prefetch_free(InfoPrefetch *prefetch) {
+    if (!prefetch) return;
+
+    for (int i = 0; i < prefetch->capacity; i++) {
+        clear_entry(prefetch, &prefetch->entries[i]);
+    }
+    free(prefetch->entries);
+    free(prefetch);
+}
@@ -0,0 +1,58 @@
+#ifndef INFO_PREFETCH_H
+#define INFO_PREFETCH_H
+
+#include <stdbool.h>
+#include "api.h"
+
+// Infos kept for the results the highlight rested on
+#define INFO_PREFETCH_CAPACITY 8
+
+// Fetch an info from a given provider on a pool worker (e.g. anime_get_info_from)
+typedef void* (*InfoFetchFn)(ProviderType provider, const char *id);
+
+// Release an info the prefetcher owns (e.g. anime_free_info)
+typedef void (*InfoReleaseFn)(void *info);
+
+// Small LRU of infos fetched ahead of the user opening them
+// Every call, like the completions it relies on, belongs to the UI thread;
+// fetches run on the worker pool and land through worker_pool_dispatch.
+typedef struct InfoPrefetch InfoPrefetch;
+
+/**
+ * Create an empty prefetcher
+ * @param capacity Most infos kept, fetched or in flight (INFO_PREFETCH_CAPACITY when not positive)
+ * @param fetch Loads one info
+ * @param release Frees one info
+ * @return The prefetcher (release with info_prefetch_free) or NULL on error
+ */
+InfoPrefetch* info_prefetch_new(int capacity, InfoFetchFn fetch, InfoReleaseFn release);
+
+/**
+ * Start fetching an info unless it is kept or already on its way
+ * The least recently used entry makes room; its fetch is cancelled.
+ * @param prefetch The prefetcher
+ * @param provider Provider that returned the result
+ * @param id Result ID on that provider
+ */
+void info_prefetch_request(InfoPrefetch *prefetch, ProviderType provider, const char *id);
+
+/**
+ * Look at a fetched info without taking it
+ * @return The info (still owned by the prefetcher), or NULL if it is not
+ *         fetched yet, failed or was never requested
+ */
+const void* info_prefetch_peek(InfoPrefetch *prefetch, ProviderType provider, const char *id);
+
+// Check whether the info was requested and its fetch is still running
+bool info_prefetch_loading(const InfoPrefetch *prefetch, ProviderType provider, const char *id);
+
+/**
+ * Take a fetched info out of the prefetcher
+ * @return The info (now owned by the caller), or NULL if it is not ready
+ */
+void* info_prefetch_take(InfoPrefetch *prefetch, ProviderType provider, const char *id);
+
+// Cancel the fetches still running and release every kept info
+void info_prefetch_free(InfoPrefetch *prefetch);
+
+#endif /* INFO_PREFETCH_H */
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <json-c/json.h>
+#include "json_stream.h"
+
+// json-c refuses deeper documents anyway
+#define JSON_SPLITTER_MAX_DEPTH 64
+#define JSON_SPLITTER_KEY_MAX 64
+
+struct JsonSplitter {
+    const char *const *path;
+    int path_len;
+    JsonElementCallback on_element;
+    void *ctx;
+    struct json_tokener *element_tokener;
+
+    // Just enough lexing to follow strings, nesting and object keys
+    int depth;
+    char kinds[JSON_SPLITTER_MAX_DEPTH + 1];    // '{' or '[' per open container
+    bool on_path[JSON_SPLITTER_MAX_DEPTH + 1];  // Reached through the leading keys of path
+    bool in_string;
+    bool escaped;
+    bool expect_key;   // Inside an object, before the next member's key
+    bool reading_key;  // The current string is a key on the path's level
+    bool key_hit;      // The last key continued the path; applies to the following value
+    char key[JSON_SPLITTER_KEY_MAX];
+    size_t key_len;
+
+    // Position inside the split array
+    int array_depth;   // Depth of the array while inside it, 0 otherwise
+    bool in_element;
+    bool scalar_element;
+
+    int index;         // Elements seen in the current pass
+    int delivered;     // Elements handed to the callback over all passes
+};
+
+JsonSplitter* json_splitter_new(const char *const *path, JsonElementCallback on_element, void *ctx) {
+    JsonSplitter *splitter = calloc(1, sizeof(JsonSplitter));
+    if (!splitter) {
+        fprintf(stderr, "Failed to allocate JSON splitter\n");
+        return NULL;
+    }
+
+    splitter->element_tokener = json_tokener_new();
+    if (!splitter->element_tokener) {
+        free(splitter);
+        return NULL;
+    }
+
+    splitter->path = path;
+    while (path[splitter->path_len]) {
+        splitter->path_len++;
+    }
+    splitter->on_element = on_element;
+    splitter->ctx = ctx;
+    return splitter;
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Pass a span outside the split array to the document's tokener
+static bool feed_outer(struct json_tokener *tokener, struct json_object **json,
+                       const char *data, size_t len) {
+    // Anything after the complete value is trailing whitespace
+    if (*json || len == 0) {
+        return true;
+    }
+
+    *json = json_tokener_parse_ex(tokener, data, (int)len);
+    return *json || json_tokener_get_error(tokener) == json_tokener_continue;
+}
+
+// Pass the start of an element that continues in the next chunk
+static bool feed_element(JsonSplitter *splitter, const char *data, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+
+    json_tokener_parse_ex(splitter->element_tokener, data, (int)len);
+    return json_tokener_get_error(splitter->element_tokener) == json_tokener_continue;
+}
+
+// Parse the last span of an element and hand the element out
+static bool finish_element(JsonSplitter *splitter, const char *data, size_t len) {
+    struct json_tokener *tokener = splitter->element_tokener;
+    struct json_object *element = json_tokener_parse_ex(tokener, data, (int)len);
+
+    // Numbers and literals only end at a delimiter, which belongs to the array
+    if (!element && splitter->scalar_element && json_tokener_get_error(tokener) == json_tokener_continue) {
+        element = json_tokener_parse_ex(tokener, " ", 1);
+    }
+
+    // A null element parses to NULL without an error
+    bool valid = element || json_tokener_get_error(tokener) == json_tokener_success;
+    json_tokener_reset(tokener);
+    splitter->in_element = false;
+    if (!valid) {
+        return false;
+    }
+
+    bool keep_going = true;
+    if (splitter->index >= splitter->delivered) {
+        keep_going = splitter->on_element(element, splitter->index, splitter->ctx);
+        splitter->delivered++;
+    }
+    splitter->index++;
+    json_object_put(element);
+    return keep_going;
+}
+
+static void finish_key(JsonSplitter *splitter) {
+    const char *expected = splitter->path[splitter->depth - 1];
+    splitter->reading_key = false;
+    splitter->key_hit = splitter->key_len < JSON_SPLITTER_KEY_MAX &&
+                        strlen(expected) == splitter->key_len &&
+                        memcmp(expected, splitter->key, splitter->key_len) == 0;
+}
+
+bool json_splitter_feed(JsonSplitter *splitter, struct json_tokener *tokener,
+                        struct json_object **json, const char *data, size_t len) {
+    // Start of the bytes not yet passed on; where they go depends on the position
+    size_t span = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+
+        if (splitter->in_string) {
+            if (splitter->escaped) {
+                splitter->escaped = false;
+            } else if (c == '\\') {
+                splitter->escaped = true;
+            } else if (c == '"') {
+                splitter->in_string = false;
+                if (splitter->reading_key) {
+                    finish_key(splitter);
+                } else if (splitter->in_element && splitter->depth == splitter->array_depth) {
+                    // A string element
+                    if (!finish_element(splitter, data + span, i + 1 - span)) return false;
+                    span = i + 1;
+                }
+                continue;
+            }
+
+            if (splitter->reading_key) {
+                if (splitter->key_len < JSON_SPLITTER_KEY_MAX) {
+                    splitter->key[splitter->key_len] = c;
+                }
+                splitter->key_len++;
+            }
+            continue;
+        }
+
+        if (splitter->in_element && splitter->scalar_element) {
+            if (!is_space(c) && c != ',' && c != ']') continue;
+
+            if (!finish_element(splitter, data + span, i - span)) return false;
+            span = i;
+        }
+
+        if (splitter->array_depth && !splitter->in_element && splitter->depth == splitter->array_depth) {
+            // Between elements: separators are dropped, the closing bracket goes back to the document
+            if (is_space(c) || c == ',') {
+                span = i + 1;
+                continue;
+            }
+            if (c == ']') {
+                splitter->depth--;
+                splitter->array_depth = 0;
+                span = i;
+                continue;
+            }
+
+            splitter->in_element = true;
+            splitter->scalar_element = c != '{' && c != '[' && c != '"';
+            span = i;
+            if (splitter->scalar_element) continue;
+        }
+
+        switch (c) {
+            case '"':
+                splitter->in_string = true;
+                if (splitter->depth > 0 && splitter->kinds[splitter->depth] == '{' && splitter->expect_key) {
+                    splitter->expect_key = false;
+                    splitter->reading_key = splitter->on_path[splitter->depth] &&
+                                            splitter->depth <= splitter->path_len;
+                    splitter->key_len = 0;
+                } else {
+                    splitter->key_hit = false;
+                }
+                break;
+            case '{':
+            case '[': {
+                if (splitter->depth == JSON_SPLITTER_MAX_DEPTH) {
+                    return false;
+                }
+
+                bool value_on_path = splitter->depth == 0 || splitter->key_hit;
+                bool at_array = value_on_path && splitter->depth == splitter->path_len;
+                splitter->key_hit = false;
+                splitter->depth++;
+                splitter->kinds[splitter->depth] = c;
+                splitter->on_path[splitter->depth] = false;
+                splitter->expect_key = c == '{';
+
+                if (at_array && c == '[' && !splitter->array_depth && !splitter->in_element) {
+                    // Up to and including the bracket the document sees an ordinary array
+                    if (!feed_outer(tokener, json, data + span, i + 1 - span)) return false;
+                    splitter->array_depth = splitter->depth;
+                    span = i + 1;
+                } else if (value_on_path && c == '{' && splitter->depth <= splitter->path_len) {
+                    splitter->on_path[splitter->depth] = true;
+                }
+                break;
+            }
+            case '}':
+            case ']':
+                if (splitter->depth == 0) {
+                    return false;
+                }
+                splitter->depth--;
+                splitter->expect_key = false;
+                splitter->key_hit = false;
+
+                if (splitter->in_element && splitter->depth == splitter->array_depth) {
+                    if (!finish_element(splitter, data + span, i + 1 - span)) return false;
+                    span = i + 1;
+                }
+                break;
+            case ',':
+                if (splitter->depth > 0 && splitter->kinds[splitter->depth] == '{') {
+                    splitter->expect_key = true;
+                }
+                break;
+            case ':':
+                break;
+            default:
+                if (!is_space(c)) {
+                    splitter->key_hit = false;
+                }
+                break;
+        }
+    }
+
+    // Hand the rest of the chunk to whoever owns the current position
+    if (splitter->in_element) {
+        return feed_element(splitter, data + span, len - span);
+    }
+    if (!splitter->array_depth) {
+        return feed_outer(tokener, json, data + span, len - span);
+    }
+    return true;
+}
+
+void json_splitter_restart(JsonSplitter *splitter) {
+    int delivered = splitter->delivered;
+    struct json_tokener *element_tokener = splitter->element_tokener;
+    const char *const *path = splitter->path;
+    int path_len = splitter->path_len;
+    JsonElementCallback on_element = splitter->on_element;
+    void *ctx = splitter->ctx;
+
+    memset(splitter, 0, sizeof(JsonSplitter));
+    json_tokener_reset(element_tokener);
+    splitter->element_tokener = element_tokener;
+    splitter->path = path;
+    splitter->path_len = path_len;
+    splitter->on_element = on_element;
+    splitter->ctx = ctx;
+    splitter->delivered = delivered;
+}
+
+int json_splitter_count(const JsonSplitter *splitter) {
+    return splitter ? splitter->delivered : 0;
+}
+
+void json_splitter_free(JsonSplitter *splitter) {
+    if (!splitter) return;
+
+    json_tokener_free(splitter->element_tokener);
+    free(splitter);
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct json_object;
+struct json_tokener;
+
+// Hands out the elements of one array while the rest of a document streams in
+typedef struct JsonSplitter JsonSplitter;
+
+// Receives a split element (borrowed, take a reference to keep it); return false to stop parsing
+typedef bool (*JsonElementCallback)(struct json_object *element, int index, void *ctx);
+
+/**
+ * Create a splitter for the array at a chain of object keys
+ * e.g. {"data", "episodes", NULL}; an empty chain splits a top-level array.
+ * Each element is parsed on its own and passed to the callback as soon as
+ * its last byte arrives. The rest of the document goes to the caller's
+ * tokener, which sees the split array as empty.
+ * @param path NULL-terminated key chain (must outlive the splitter)
+ * @param on_element Called once per element, in order
+ * @param ctx Passed to the callback
+ * @return Splitter (release with json_splitter_free) or NULL on error
+ */
+JsonSplitter* json_splitter_new(const char *const *path, JsonElementCallback on_element, void *ctx);
+
+/**
+ * Feed the next chunk of the document
+ * @param tokener Tokener building everything outside the split array
+ * @param json Receives the document once complete (bytes after it are ignored)
+ * @param data Chunk of the document
+ * @param len Length of the chunk
+ * @return false once the input cannot be valid JSON or the callback asked to stop
+ */
+bool json_splitter_feed(JsonSplitter *splitter, struct json_tokener *tokener,
+                        struct json_object **json, const char *data, size_t len);
+
+/**
+ * Start over on another copy of the document (e.g. a cached body after a failed transfer)
+ * Elements already handed out are skipped rather than delivered twice.
+ */
+void json_splitter_restart(JsonSplitter *splitter);
+
+// Number of elements handed out so far
+int json_splitter_count(const JsonSplitter *splitter);
+
+// Release a splitter
+void json_splitter_free(JsonSplitter *splitter);
+
+#endif /* JSON_STREAM_H */
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <json-c/json.h>
+#include "json_view.h"
+#include "../config.h"
+
+static void release_response(void *response) {
+    json_object_put(response);
+}
+
+JsonStrings json_strings_begin(Arena *arena, struct json_object *response) {
+    JsonStrings strings = { arena, false };
+
+    if (app_config.zero_copy_strings && response) {
+        arena_defer(arena, release_response, json_object_get(response));
+        strings.retained = true;
+    }
+    return strings;
+}
+
+char* json_strings_get(const JsonStrings *strings, struct json_object *value) {
+    if (!value) return NULL;
+
+    // String objects own their buffer; anything else is rendered into a
+    // scratch buffer that later calls may overwrite, so it is copied
+    if (strings->retained && json_object_is_type(value, json_type_string)) {
+        return (char *)json_object_get_string(value);
+    }
+    return arena_strdup(strings->arena, json_object_get_string(value));
+}
\ No newline at end of file
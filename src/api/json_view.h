@@ -0,0 +1,32 @@
+#ifndef JSON_VIEW_H
+#define JSON_VIEW_H
+
+#include <stdbool.h>
+#include "../utils/memory.h"
+
+struct json_object;
+
+// Source of the strings of a structure built in an arena from a parsed response
+typedef struct {
+    Arena *arena;
+    bool retained;  // The response lives as long as the arena; strings point into it
+} JsonStrings;
+
+/**
+ * Start taking strings out of a parsed response
+ * With Config.zero_copy_strings the arena takes a reference on the response
+ * (dropped by arena_destroy) and string fields become views into it;
+ * otherwise every string is copied into the arena.
+ * @param arena Arena that owns the structure being built
+ * @param response Root of the parsed response
+ */
+JsonStrings json_strings_begin(Arena *arena, struct json_object *response);
+
+/**
+ * String value of a response field
+ * Non-string values are rendered as text and copied.
+ * @return View or arena copy, valid until arena_destroy; NULL if value is NULL
+ */
+char* json_strings_get(const JsonStrings *strings, struct json_object *value);
+
+#endif /* JSON_VIEW_H */
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "lazy_list.h"
+#include "http.h"
+#include "metrics.h"
+#include "worker_pool.h"
+
+struct LazyList {
+    pthread_mutex_t lock;
+    int refs;
+    bool cancelled;
+    int pipe_fds[2];
+    size_t item_size;
+    const char *source;
+
+    LazyListLoader loader;
+    void *ctx;
+    void (*release)(void *ctx);
+
+    // Shared with the loader, guarded by lock
+    char *pending;
+    int pending_count;
+    int pending_capacity;
+    int pushed;
+    int wanted;
+    bool finished;
+    void *summary;
+
+    // Owner side only
+    char *items;
+    int count;
+    int capacity;
+    bool done;
+};
+
+static void release_list(LazyList *list) {
+    pthread_mutex_lock(&list->lock);
+    bool last = --list->refs == 0;
+    pthread_mutex_unlock(&list->lock);
+
+    if (!last) return;
+
+    if (list->release) {
+        list->release(list->ctx);
+    }
+    free(list->pending);
+    close(list->pipe_fds[0]);
+    close(list->pipe_fds[1]);
+    pthread_mutex_destroy(&list->lock);
+    free(list);
+}
+
+// Wake the owner; if the pipe is full a wake-up is already queued
+static void wake_owner(LazyList *list) {
+    char byte = 1;
+    ssize_t written = write(list->pipe_fds[1], &byte, 1);
+    (void)written;
+}
+
+// Abort the loader's requests once the owner has gone away
+static bool lazy_list_wait_tick(void *ctx) {
+    LazyList *list = ctx;
+
+    pthread_mutex_lock(&list->lock);
+    bool cancelled = list->cancelled;
+    pthread_mutex_unlock(&list->lock);
+
+    return !cancelled;
+}
+
+static void lazy_list_task(void *arg) {
+    LazyList *list = arg;
+
+    http_set_wait_hook(lazy_list_wait_tick, -1, list);
+    MetricsCall call;
+    metrics_call_begin(&call, list->source);
+    void *summary = list->loader(list, list->ctx);
+    metrics_call_end(&call);
+
+    pthread_mutex_lock(&list->lock);
+    list->finished = true;
+    list->summary = summary;
+    pthread_mutex_unlock(&list->lock);
+
+    wake_owner(list);
+    release_list(list);
+}
+
+LazyList* lazy_list_start(size_t item_size, const char *source, LazyListLoader loader,
+                          void *ctx, void (*release)(void *ctx)) {
+    LazyList *list = calloc(1, sizeof(LazyList));
+    if (!list) {
+        fprintf(stderr, "Failed to allocate memory for lazy list\n");
+        if (release) release(ctx);
+        return NULL;
+    }
+
+    if (pipe(list->pipe_fds) != 0) {
+        fprintf(stderr, "Failed to create lazy list pipe\n");
+        if (release) release(ctx);
+        free(list);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(list->pipe_fds[i], F_SETFL, O_NONBLOCK);
+        fcntl(list->pipe_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    pthread_mutex_init(&list->lock, NULL);
+    list->refs = 2;  // Owner and loader
+    list->item_size = item_size;
+    list->source = source;
+    list->loader = loader;
+    list->ctx = ctx;
+    list->release = release;
+
+    if (!worker_pool_submit(lazy_list_task, NULL, list)) {
+        fprintf(stderr, "Failed to start lazy list loader\n");
+        list->refs = 1;
+        release_list(list);
+        return NULL;
+    }
+
+    return list;
+}
+
+bool lazy_list_push(LazyList *list, const void *item) {
+    pthread_mutex_lock(&list->lock);
+    if (list->cancelled) {
+        pthread_mutex_unlock(&list->lock);
+        return false;
+    }
+
+    if (list->pending_count == list->pending_capacity) {
+        int capacity = list->pending_capacity ? list->pending_capacity * 2 : LAZY_LIST_PAGE_SIZE;
+        char *pending = realloc(list->pending, capacity * list->item_size);
+        if (!pending) {
+            pthread_mutex_unlock(&list->lock);
+            fprintf(stderr, "Failed to grow lazy list\n");
+            return false;
+        }
+        list->pending = pending;
+        list->pending_capacity = capacity;
+    }
+
+    memcpy(list->pending + list->pending_count * list->item_size, item, list->item_size);
+    list->pending_count++;
+    list->pushed++;
+
+    // A full page, or the last row the owner is waiting for
+    bool wake = list->pending_count >= LAZY_LIST_PAGE_SIZE || list->pushed == list->wanted;
+    pthread_mutex_unlock(&list->lock);
+
+    if (wake) {
+        wake_owner(list);
+    }
+    return true;
+}
+
+int lazy_list_fd(const LazyList *list) {
+    return list ? list->pipe_fds[0] : -1;
+}
+
+void lazy_list_request(LazyList *list, int end) {
+    if (!list) return;
+
+    pthread_mutex_lock(&list->lock);
+    list->wanted = end;
+    bool covered = list->pending_count > 0 && list->pushed >= end;
+    pthread_mutex_unlock(&list->lock);
+
+    // Items for the new window may already be waiting below a full page
+    if (covered) {
+        wake_owner(list);
+    }
+}
+
+bool lazy_list_update(LazyList *list) {
+    if (!list || list->done) return false;
+
+    char buffer[64];
+    while (read(list->pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+        // Drain wake-ups
+    }
+
+    pthread_mutex_lock(&list->lock);
+    int added = list->pending_count;
+    if (added > 0 && list->count + added > list->capacity) {
+        int capacity = list->capacity ? list->capacity : LAZY_LIST_PAGE_SIZE;
+        while (capacity < list->count + added) {
+            capacity *= 2;
+        }
+        char *items = realloc(list->items, capacity * list->item_size);
+        if (!items) {
+            // Leave them pending and try again on the next update
+            pthread_mutex_unlock(&list->lock);
+            return false;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    if (added > 0) {
+        memcpy(list->items + list->count * list->item_size, list->pending, added * list->item_size);
+        list->count += added;
+        list->pending_count = 0;
+    }
+    list->done = list->finished;
+    pthread_mutex_unlock(&list->lock);
+
+    return added > 0 || list->done;
+}
+
+void* lazy_list_items(const LazyList *list) {
+    return list ? list->items : NULL;
+}
+
+int lazy_list_count(const LazyList *list) {
+    return list ? list->count : 0;
+}
+
+bool lazy_list_done(const LazyList *list) {
+    return !list || list->done;
+}
+
+void* lazy_list_summary(const LazyList *list) {
+    // Written before finished was set, read only after done was seen under the lock
+    return list && list->done ? list->summary : NULL;
+}
+
+void lazy_list_free(LazyList *list) {
+    if (!list) return;
+
+    // A loader still running notices this on its next push or wait tick
+    pthread_mutex_lock(&list->lock);
+    list->cancelled = true;
+    pthread_mutex_unlock(&list->lock);
+
+    free(list->items);
+    release_list(list);
+}
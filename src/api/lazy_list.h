@@ -0,0 +1,81 @@
+#ifndef LAZY_LIST_H
+#define LAZY_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Items published a page at a time by a background loader while the owner displays them
+typedef struct LazyList LazyList;
+
+// Items are handed to the owner in pages of this many, or sooner once its window is filled
+#define LAZY_LIST_PAGE_SIZE 64
+
+/**
+ * Load a list's items on a pool worker
+ * Call lazy_list_push for every item in order. The loader's blocking requests
+ * are aborted once the owner frees the list.
+ * @param list The list being filled
+ * @param ctx Loader context given to lazy_list_start
+ * @return Summary of the source for the owner (e.g. the rest of the document,
+ *         still owned by ctx), or NULL if loading failed
+ */
+typedef void* (*LazyListLoader)(LazyList *list, void *ctx);
+
+/**
+ * Start loading a list on a background thread
+ * @param item_size Size of one item
+ * @param source Name the loader's requests are attributed to in the metrics
+ * @param loader Loads the items
+ * @param ctx Loader context, also owning whatever the items point to
+ * @param release Frees ctx once both the owner and the loader are done with it
+ * @return List handle (release with lazy_list_free) or NULL on error, in which case ctx is released
+ */
+LazyList* lazy_list_start(size_t item_size, const char *source, LazyListLoader loader,
+                          void *ctx, void (*release)(void *ctx));
+
+/**
+ * Append an item (loader side)
+ * The owner is woken once a page is full or its window is covered.
+ * @param item Item to copy into the list
+ * @return false once the owner has freed the list and loading should stop
+ */
+bool lazy_list_push(LazyList *list, const void *item);
+
+/**
+ * Descriptor that becomes readable when items are ready or loading ended
+ * Poll it together with stdin and call lazy_list_update when it fires.
+ */
+int lazy_list_fd(const LazyList *list);
+
+/**
+ * Tell the loader how far the owner's window reaches
+ * Items up to end are handed over as soon as they exist instead of a page at a time.
+ * @param end Index one past the last displayed item
+ */
+void lazy_list_request(LazyList *list, int end);
+
+/**
+ * Move the items published since the last call into the owner's array
+ * @return true if items were added or loading just ended
+ */
+bool lazy_list_update(LazyList *list);
+
+// Items received so far (owner side; the array moves on lazy_list_update)
+void* lazy_list_items(const LazyList *list);
+
+// Number of items received so far
+int lazy_list_count(const LazyList *list);
+
+// Check whether the loader finished and every item has been received
+bool lazy_list_done(const LazyList *list);
+
+// Summary returned by the loader, once lazy_list_done (NULL if loading failed)
+void* lazy_list_summary(const LazyList *list);
+
+/**
+ * Stop loading and release the list
+ * A loader still running finishes in the background; ctx is released after it.
+ */
+void lazy_list_free(LazyList *list);
+
+#endif /* LAZY_LIST_H */
@@ -2,38 +2,121 @@
 #include <stdlib.h>
 #include <string.h>
 #include "manga.h"
+#include "metrics.h"
+#include "lazy_list.h"
 #include "../config.h"
 
+// As in anime.c, each call pins the provider it started with
+
 SearchResult* manga_search(const char *query) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->search) {
         return NULL;
     }
     
-    return api->search(query);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    SearchResult *results = api->search(query);
+    metrics_call_end(&call);
+    if (results) results->provider = provider;
+    return results;
 }
 
-MangaInfo* manga_get_info(const char *id) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+MangaInfo* manga_get_info_from(ProviderType provider, const char *id) {
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->get_manga_info) {
         return NULL;
     }
     
-    return (MangaInfo*)api->get_manga_info(id);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    MangaInfo *info = (MangaInfo*)api->get_manga_info(id);
+    metrics_call_end(&call);
+    if (info) info->provider = provider;
+    return info;
+}
+
+MangaInfo* manga_get_info(const char *id) {
+    return manga_get_info_from(get_current_provider(), id);
+}
+
+MangaInfo* manga_open_info(const char *id) {
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
+    if (!api || !api->open_manga_info) {
+        return manga_get_info_from(provider, id);
+    }
+    
+    MangaInfo *info = (MangaInfo*)api->open_manga_info(id);
+    if (info) info->provider = provider;
+    return info;
+}
+
+// Details the provider only knows once the whole response is in
+static void merge_details(MangaInfo *info, const MangaInfo *details) {
+    if (details->title) info->title = details->title;
+    if (details->url) info->url = details->url;
+    if (details->image) info->image = details->image;
+    if (details->description) info->description = details->description;
+    if (details->release_date) info->release_date = details->release_date;
+    if (details->status) info->status = details->status;
+    if (details->genres) {
+        info->genres = details->genres;
+        info->genres_count = details->genres_count;
+    }
+}
+
+bool manga_info_update(MangaInfo *info) {
+    if (!info || !lazy_list_update(info->chapter_list)) {
+        return false;
+    }
+    
+    info->chapters = lazy_list_items(info->chapter_list);
+    info->total_chapters = lazy_list_count(info->chapter_list);
+    
+    // The details live with the list, which the info holds until it is freed
+    const MangaInfo *details = lazy_list_summary(info->chapter_list);
+    if (details) {
+        merge_details(info, details);
+    }
+    return true;
+}
+
+bool manga_info_loading(const MangaInfo *info) {
+    return info && !lazy_list_done(info->chapter_list);
+}
+
+int manga_info_fd(const MangaInfo *info) {
+    return manga_info_loading(info) ? lazy_list_fd(info->chapter_list) : -1;
+}
+
+void manga_info_request(MangaInfo *info, int end) {
+    if (info) {
+        lazy_list_request(info->chapter_list, end);
+    }
 }
 
 ChapterPages* manga_get_chapter_pages(const char *chapter_id) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
+    ProviderType provider = get_current_provider();
+    const ProviderAPI *api = get_provider_api(provider);
     if (!api || !api->get_chapter_pages) {
         return NULL;
     }
     
-    return (ChapterPages*)api->get_chapter_pages(chapter_id);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(provider));
+    ChapterPages *pages = (ChapterPages*)api->get_chapter_pages(chapter_id);
+    metrics_call_end(&call);
+    if (pages) pages->provider = provider;
+    return pages;
 }
 
 void manga_free_search_results(SearchResult *results) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_search_results || !results) {
+    if (!results) return;
+    
+    const ProviderAPI *api = get_provider_api(results->provider);
+    if (!api || !api->free_search_results) {
         return;
     }
     
@@ -41,8 +124,10 @@ void manga_free_search_results(SearchResult *results) {
 }
 
 void manga_free_info(MangaInfo *info) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_manga_info || !info) {
+    if (!info) return;
+    
+    const ProviderAPI *api = get_provider_api(info->provider);
+    if (!api || !api->free_manga_info) {
         return;
     }
     
@@ -50,8 +135,10 @@ void manga_free_info(MangaInfo *info) {
 }
 
 void manga_free_chapter_pages(ChapterPages *pages) {
-    const ProviderAPI *api = get_provider_api(get_current_provider());
-    if (!api || !api->free_chapter_info || !pages) {
+    if (!pages) return;
+    
+    const ProviderAPI *api = get_provider_api(pages->provider);
+    if (!api || !api->free_chapter_info) {
         return;
     }
     
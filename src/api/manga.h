@@ -24,6 +24,9 @@ typedef struct {
     int genres_count;
     int total_chapters;
     MangaChapter *chapters;
+    struct LazyList *chapter_list;  // Chapters still arriving, merged by manga_info_update (NULL when loaded whole)
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Provider that created it
 } MangaInfo;
 
 // Structure to hold chapter page information
@@ -32,6 +35,8 @@ typedef struct {
     int page_count;
     char *referer;  // HTTP referer for image loading
     char *base_url; // Base URL for relative paths
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Provider that created it
 } ChapterPages;
 
 // Search for manga with the current provider
@@ -40,10 +45,48 @@ SearchResult* manga_search(const char *query);
 // Get detailed manga information
 MangaInfo* manga_get_info(const char *id);
 
+/**
+ * Get detailed manga information from a given provider
+ * Unlike manga_get_info this leaves the current provider alone, so
+ * background fetches for federated results use the provider that found them.
+ * @param provider Provider to ask
+ * @param id Manga ID on that provider
+ * @return Manga information (free with manga_free_info) or NULL on error
+ */
+MangaInfo* manga_get_info_from(ProviderType provider, const char *id);
+
+/**
+ * Get manga information for display
+ * With providers that support it this returns at once and the chapter list
+ * keeps arriving in the background (see manga_info_update); otherwise it
+ * loads everything first, like manga_get_info.
+ * @param id The manga ID
+ * @return Manga information (free with manga_free_info) or NULL on error
+ */
+MangaInfo* manga_open_info(const char *id);
+
+/**
+ * Merge the chapters that arrived since the last call
+ * Grows chapters and total_chapters (the array may move) and fills in the
+ * remaining details once the whole list is in. Call it on the thread that
+ * displays the info.
+ * @return true if the info changed
+ */
+bool manga_info_update(MangaInfo *info);
+
+// Check whether chapters are still arriving
+bool manga_info_loading(const MangaInfo *info);
+
+// Descriptor that becomes readable when manga_info_update has work, -1 once loaded
+int manga_info_fd(const MangaInfo *info);
+
+// Tell the loader which chapters are on screen (indexes below end)
+void manga_info_request(MangaInfo *info, int end);
+
 // Get chapter pages
 ChapterPages* manga_get_chapter_pages(const char *chapter_id);
 
-// Free resources
+// Free resources with the provider that created them, whichever is current now
 void manga_free_search_results(SearchResult *results);
 void manga_free_info(MangaInfo *info);
 void manga_free_chapter_pages(ChapterPages *pages);
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <json-c/json.h>
+#include "metrics.h"
+#include "../utils/memory.h"
+
+#define METRICS_MAX_SOURCES 8
+#define METRICS_MAX_SAMPLES 256
+
+// Recent samples of one source; counters cover the whole session
+typedef struct {
+    const char *name;
+
+    RequestMetrics requests[METRICS_MAX_SAMPLES];
+    int request_count;
+    int request_next;
+
+    double call_ms[METRICS_MAX_SAMPLES];
+    int call_count;
+    int call_next;
+
+    int total_requests;
+    int total_cache_hits;
+    int total_failures;
+    long long total_bytes;
+    int total_calls;
+    long long total_allocations;
+} SourceMetrics;
+
+static SourceMetrics sources[METRICS_MAX_SOURCES];
+static int source_count = 0;
+static pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Source of the innermost call running on this thread
+static __thread const char *current_source = NULL;
+
+double metrics_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Caller holds the lock; NULL once the table is full
+static SourceMetrics* find_source(const char *name) {
+    for (int i = 0; i < source_count; i++) {
+        if (strcmp(sources[i].name, name) == 0) {
+            return &sources[i];
+        }
+    }
+
+    if (source_count == METRICS_MAX_SOURCES) {
+        return NULL;
+    }
+
+    SourceMetrics *source = &sources[source_count++];
+    memset(source, 0, sizeof(SourceMetrics));
+    source->name = name;
+    return source;
+}
+
+void metrics_call_begin(MetricsCall *call, const char *source) {
+    call->source = source;
+    call->previous = current_source;
+    call->started_ms = metrics_now_ms();
+    call->allocations = memory_allocation_count();
+    current_source = source;
+}
+
+void metrics_call_end(MetricsCall *call) {
+    double elapsed = metrics_now_ms() - call->started_ms;
+    long allocations = memory_allocation_count() - call->allocations;
+    current_source = call->previous;
+
+    pthread_mutex_lock(&metrics_lock);
+    SourceMetrics *source = find_source(call->source);
+    if (source) {
+        source->call_ms[source->call_next] = elapsed;
+        source->call_next = (source->call_next + 1) % METRICS_MAX_SAMPLES;
+        if (source->call_count < METRICS_MAX_SAMPLES) source->call_count++;
+        source->total_calls++;
+        source->total_allocations += allocations;
+    }
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+const char* metrics_current_source() {
+    return current_source ? current_source : METRICS_SOURCE_OTHER;
+}
+
+void metrics_record_request(const char *source_name, const RequestMetrics *sample) {
+    pthread_mutex_lock(&metrics_lock);
+    SourceMetrics *source = find_source(source_name ? source_name : METRICS_SOURCE_OTHER);
+    if (source) {
+        source->requests[source->request_next] = *sample;
+        source->request_next = (source->request_next + 1) % METRICS_MAX_SAMPLES;
+        if (source->request_count < METRICS_MAX_SAMPLES) source->request_count++;
+
+        source->total_requests++;
+        source->total_bytes += sample->bytes;
+        if (sample->cached) source->total_cache_hits++;
+        if (sample->failed) source->total_failures++;
+    }
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static double percentile(const double *sorted, int count, int pct) {
+    if (count == 0) return 0;
+    int rank = (pct * count + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+// Sort one field of the network samples (cache hits have no transfer to time)
+static int network_values(const SourceMetrics *source, size_t offset, double *values) {
+    int count = 0;
+    for (int i = 0; i < source->request_count; i++) {
+        const RequestMetrics *sample = &source->requests[i];
+        if (sample->cached) continue;
+        values[count++] = *(const double *)((const char *)sample + offset);
+    }
+    qsort(values, count, sizeof(double), compare_doubles);
+    return count;
+}
+
+// Caller holds the lock
+static void summarize_source(const SourceMetrics *source, MetricsSummary *summary) {
+    double values[METRICS_MAX_SAMPLES];
+    int count;
+
+    memset(summary, 0, sizeof(MetricsSummary));
+    summary->source = source->name;
+    summary->requests = source->total_requests;
+    summary->cache_hits = source->total_cache_hits;
+    summary->failures = source->total_failures;
+    summary->bytes = source->total_bytes;
+    summary->calls = source->total_calls;
+    if (source->total_calls > 0) {
+        summary->allocations_per_call = (double)source->total_allocations / source->total_calls;
+    }
+
+    count = network_values(source, offsetof(RequestMetrics, total_ms), values);
+    summary->total_p50 = percentile(values, count, 50);
+    summary->total_p95 = percentile(values, count, 95);
+    count = network_values(source, offsetof(RequestMetrics, namelookup_ms), values);
+    summary->namelookup_p50 = percentile(values, count, 50);
+    count = network_values(source, offsetof(RequestMetrics, connect_ms), values);
+    summary->connect_p50 = percentile(values, count, 50);
+    count = network_values(source, offsetof(RequestMetrics, appconnect_ms), values);
+    summary->appconnect_p50 = percentile(values, count, 50);
+    count = network_values(source, offsetof(RequestMetrics, starttransfer_ms), values);
+    summary->starttransfer_p50 = percentile(values, count, 50);
+
+    // Parsing happens for cache hits too
+    for (int i = 0; i < source->request_count; i++) {
+        values[i] = source->requests[i].parse_ms;
+    }
+    qsort(values, source->request_count, sizeof(double), compare_doubles);
+    summary->parse_p50 = percentile(values, source->request_count, 50);
+    summary->parse_p95 = percentile(values, source->request_count, 95);
+
+    memcpy(values, source->call_ms, source->call_count * sizeof(double));
+    qsort(values, source->call_count, sizeof(double), compare_doubles);
+    summary->call_p50 = percentile(values, source->call_count, 50);
+    summary->call_p95 = percentile(values, source->call_count, 95);
+}
+
+int metrics_summarize(MetricsSummary *summaries, int max) {
+    pthread_mutex_lock(&metrics_lock);
+    int count = source_count < max ? source_count : max;
+    for (int i = 0; i < count; i++) {
+        summarize_source(&sources[i], &summaries[i]);
+    }
+    pthread_mutex_unlock(&metrics_lock);
+    return count;
+}
+
+static void add_double(struct json_object *object, const char *key, double value) {
+    json_object_object_add(object, key, json_object_new_double(value));
+}
+
+static struct json_object* summary_to_json(const MetricsSummary *summary) {
+    struct json_object *object = json_object_new_object();
+    json_object_object_add(object, "requests", json_object_new_int(summary->requests));
+    json_object_object_add(object, "cache_hits", json_object_new_int(summary->cache_hits));
+    json_object_object_add(object, "failures", json_object_new_int(summary->failures));
+    json_object_object_add(object, "bytes", json_object_new_int64(summary->bytes));
+    add_double(object, "total_p50_ms", summary->total_p50);
+    add_double(object, "total_p95_ms", summary->total_p95);
+    add_double(object, "namelookup_p50_ms", summary->namelookup_p50);
+    add_double(object, "connect_p50_ms", summary->connect_p50);
+    add_double(object, "appconnect_p50_ms", summary->appconnect_p50);
+    add_double(object, "starttransfer_p50_ms", summary->starttransfer_p50);
+    add_double(object, "parse_p50_ms", summary->parse_p50);
+    add_double(object, "parse_p95_ms", summary->parse_p95);
+    json_object_object_add(object, "calls", json_object_new_int(summary->calls));
+    add_double(object, "call_p50_ms", summary->call_p50);
+    add_double(object, "call_p95_ms", summary->call_p95);
+    add_double(object, "allocations_per_call", summary->allocations_per_call);
+    return object;
+}
+
+static struct json_object* sample_to_json(const RequestMetrics *sample) {
+    struct json_object *object = json_object_new_object();
+    add_double(object, "namelookup_ms", sample->namelookup_ms);
+    add_double(object, "connect_ms", sample->connect_ms);
+    add_double(object, "appconnect_ms", sample->appconnect_ms);
+    add_double(object, "starttransfer_ms", sample->starttransfer_ms);
+    add_double(object, "total_ms", sample->total_ms);
+    add_double(object, "parse_ms", sample->parse_ms);
+    json_object_object_add(object, "bytes", json_object_new_int64(sample->bytes));
+    json_object_object_add(object, "status", json_object_new_int((int)sample->status));
+    json_object_object_add(object, "cached", json_object_new_boolean(sample->cached));
+    json_object_object_add(object, "failed", json_object_new_boolean(sample->failed));
+    return object;
+}
+
+bool metrics_dump_json(const char *path) {
+    struct json_object *root = json_object_new_object();
+
+    pthread_mutex_lock(&metrics_lock);
+    int count = source_count;
+    for (int i = 0; i < source_count; i++) {
+        const SourceMetrics *source = &sources[i];
+        MetricsSummary summary;
+        summarize_source(source, &summary);
+
+        struct json_object *entry = json_object_new_object();
+        json_object_object_add(entry, "summary", summary_to_json(&summary));
+
+        // Oldest first
+        struct json_object *samples = json_object_new_array();
+        int first = source->request_count < METRICS_MAX_SAMPLES ? 0 : source->request_next;
+        for (int j = 0; j < source->request_count; j++) {
+            const RequestMetrics *sample = &source->requests[(first + j) % METRICS_MAX_SAMPLES];
+            json_object_array_add(samples, sample_to_json(sample));
+        }
+        json_object_object_add(entry, "requests", samples);
+
+        json_object_object_add(root, source->name, entry);
+    }
+    pthread_mutex_unlock(&metrics_lock);
+
+    bool ok = count > 0 && json_object_to_file_ext(path, root, JSON_C_TO_STRING_PRETTY) == 0;
+    json_object_put(root);
+    return ok;
+}
@@ -0,0 +1,81 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+
+// Source used for requests made outside any provider call
+#define METRICS_SOURCE_OTHER "Other"
+
+// Timings of one HTTP request in milliseconds; curl phases are cumulative from the start
+typedef struct {
+    double namelookup_ms;
+    double connect_ms;
+    double appconnect_ms;
+    double starttransfer_ms;
+    double total_ms;
+    double parse_ms;
+    long long bytes;
+    long status;
+    bool cached;    // Served from the on-disk cache without a transfer
+    bool failed;    // Transport error or HTTP error status
+} RequestMetrics;
+
+// Tracks one provider call (e.g. a search) on the calling thread
+typedef struct {
+    const char *source;
+    const char *previous;
+    double started_ms;
+    long allocations;
+} MetricsCall;
+
+// Per-source aggregates over the samples still held by the registry
+typedef struct {
+    const char *source;
+    int requests;
+    int cache_hits;
+    int failures;
+    long long bytes;
+    double total_p50, total_p95;
+    double namelookup_p50, connect_p50, appconnect_p50, starttransfer_p50;
+    double parse_p50, parse_p95;
+    int calls;
+    double call_p50, call_p95;
+    double allocations_per_call;
+} MetricsSummary;
+
+// Monotonic clock in milliseconds
+double metrics_now_ms();
+
+/**
+ * Attribute the calling thread's requests to a source until metrics_call_end
+ * Calls nest; the outer source is restored when the inner call ends.
+ * @param call Caller-owned tracking state
+ * @param source Static name of the source (usually the provider name)
+ */
+void metrics_call_begin(MetricsCall *call, const char *source);
+
+// Record the call's wall time and allocation count
+void metrics_call_end(MetricsCall *call);
+
+// Source requests on the calling thread are attributed to right now
+const char* metrics_current_source();
+
+// Add a request sample to the registry
+void metrics_record_request(const char *source, const RequestMetrics *sample);
+
+/**
+ * Summarize every source seen so far
+ * @param summaries Array receiving one summary per source
+ * @param max Capacity of the array
+ * @return Number of summaries written
+ */
+int metrics_summarize(MetricsSummary *summaries, int max);
+
+/**
+ * Write the summaries and raw samples as JSON
+ * @param path Destination file
+ * @return true on success (false also when nothing was recorded)
+ */
+bool metrics_dump_json(const char *path);
+
+#endif /* METRICS_H */
@@ -0,0 +1,386 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "prefetch.h"
+#include "http.h"
+#include "cancel.h"
+#include "worker_pool.h"
+#include "../config.h"
+#include "../utils/memory.h"
+#include "../utils/fs.h"
+
+#define PREFETCH_TICK_MS 100
+#define PREFETCH_MAX_EXTENSION 5
+
+typedef enum {
+    PAGE_PENDING,
+    PAGE_DONE,
+    PAGE_FAILED
+} PageState;
+
+struct PagePrefetch {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int refs;
+    CancelToken *cancel;  // Cancelled once the owner frees the prefetch
+    bool complete;
+
+    char *chapter_id;
+    ChapterPages *pages;
+    PagePrefetch *after;
+    PagePrefetch *waiting;       // Prefetches to start once this one completes
+    PagePrefetch *next_waiting;  // Link in after->waiting
+
+    // Published once the page list is known
+    int page_count;
+    char **paths;
+    PageState *states;
+    int finished;
+};
+
+// Keep image extensions so viewers that sniff by name still work
+static void url_extension(const char *url, char *ext, size_t size) {
+    const char *end = strpbrk(url, "?#");
+    if (!end) end = url + strlen(url);
+
+    const char *dot = end;
+    while (dot > url && dot[-1] != '.' && dot[-1] != '/') dot--;
+
+    bool valid = dot > url && dot[-1] == '.' && dot < end && end - dot <= PREFETCH_MAX_EXTENSION;
+    for (const char *p = dot; valid && p < end; p++) {
+        if (!isalnum((unsigned char)*p)) valid = false;
+    }
+
+    if (valid) {
+        snprintf(ext, size, ".%.*s", (int)(end - dot), dot);
+    } else {
+        snprintf(ext, size, ".img");
+    }
+}
+
+// Build the local path of every page under the download directory
+static bool prepare_paths(PagePrefetch *prefetch, ChapterPages *pages) {
+    char dir[1024];
+    int len = snprintf(dir, sizeof(dir), "%s/",
+                       app_config.download_directory ? app_config.download_directory : ".");
+
+    // Chapter ids come from the API; never let them escape the directory
+    for (const char *p = prefetch->chapter_id; *p && len < (int)sizeof(dir) - 1; p++) {
+        dir[len++] = (isalnum((unsigned char)*p) || *p == '-' || *p == '_') ? *p : '_';
+    }
+    dir[len] = '\0';
+
+    if (!make_dirs(dir)) {
+        fprintf(stderr, "Failed to create download directory %s\n", dir);
+        return false;
+    }
+
+    char **paths = calloc(pages->page_count, sizeof(char*));
+    PageState *states = calloc(pages->page_count, sizeof(PageState));
+    if (!paths || !states) {
+        free(paths);
+        free(states);
+        return false;
+    }
+
+    for (int i = 0; i < pages->page_count; i++) {
+        char ext[PREFETCH_MAX_EXTENSION + 2] = ".img";
+        if (pages->page_urls[i]) {
+            url_extension(pages->page_urls[i], ext, sizeof(ext));
+        }
+
+        char path[1200];
+        snprintf(path, sizeof(path), "%s/%03d%s", dir, i + 1, ext);
+        paths[i] = safe_strdup(path);
+    }
+
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->paths = paths;
+    prefetch->states = states;
+    prefetch->page_count = pages->page_count;
+    pthread_cond_broadcast(&prefetch->changed);
+    pthread_mutex_unlock(&prefetch->lock);
+    return true;
+}
+
+static bool is_cancelled(PagePrefetch *prefetch) {
+    return cancel_token_cancelled(prefetch->cancel);
+}
+
+static void mark_page(PagePrefetch *prefetch, int index, PageState state) {
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->states[index] = state;
+    prefetch->finished++;
+    pthread_cond_broadcast(&prefetch->changed);
+    pthread_mutex_unlock(&prefetch->lock);
+}
+
+static void download_pages(PagePrefetch *prefetch) {
+    ChapterPages *pages = prefetch->pages;
+    int count = prefetch->page_count;
+    int remaining = 0;
+
+    HttpRequest **requests = calloc(count, sizeof(HttpRequest*));
+    if (!requests) return;
+
+    // Queued in page order; the per-host connection limit keeps later pages waiting
+    for (int i = 0; i < count; i++) {
+        if (!pages->page_urls[i]) {
+            mark_page(prefetch, i, PAGE_FAILED);
+        } else if (access(prefetch->paths[i], F_OK) == 0) {
+            mark_page(prefetch, i, PAGE_DONE);
+        } else if ((requests[i] = http_download_start(pages->page_urls[i], pages->referer, NULL,
+                                                      prefetch->paths[i], NULL, NULL))) {
+            remaining++;
+        } else {
+            mark_page(prefetch, i, PAGE_FAILED);
+        }
+    }
+
+    while (remaining > 0 && !is_cancelled(prefetch)) {
+        http_poll(PREFETCH_TICK_MS, -1);
+
+        for (int i = 0; i < count; i++) {
+            if (!requests[i] || !http_request_done(requests[i])) continue;
+
+            mark_page(prefetch, i, http_request_succeeded(requests[i]) ? PAGE_DONE : PAGE_FAILED);
+            http_request_free(requests[i]);
+            requests[i] = NULL;
+            remaining--;
+        }
+    }
+
+    // Drop whatever is still in flight after a cancel
+    for (int i = 0; i < count; i++) {
+        http_request_free(requests[i]);
+    }
+    free(requests);
+}
+
+static void release_prefetch(PagePrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    bool last = --prefetch->refs == 0;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    if (!last) return;
+
+    for (int i = 0; i < prefetch->page_count; i++) {
+        free(prefetch->paths[i]);
+    }
+    free(prefetch->paths);
+    free(prefetch->states);
+    manga_free_chapter_pages(prefetch->pages);
+    free(prefetch->chapter_id);
+    cancel_token_free(prefetch->cancel);
+    pthread_cond_destroy(&prefetch->changed);
+    pthread_mutex_destroy(&prefetch->lock);
+    free(prefetch);
+}
+
+static void download_task(void *arg);
+
+// Mark the prefetch complete and start the ones chained behind it
+static void finish_prefetch(PagePrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->complete = true;
+    PagePrefetch *waiting = prefetch->waiting;
+    prefetch->waiting = NULL;
+    pthread_cond_broadcast(&prefetch->changed);
+    pthread_mutex_unlock(&prefetch->lock);
+
+    while (waiting) {
+        PagePrefetch *next = waiting->next_waiting;
+        waiting->next_waiting = NULL;
+        if (!worker_pool_submit(download_task, NULL, waiting)) {
+            fprintf(stderr, "Failed to start page prefetch\n");
+            finish_prefetch(waiting);
+        }
+        waiting = next;
+    }
+
+    if (prefetch->after) {
+        release_prefetch(prefetch->after);
+    }
+    release_prefetch(prefetch);
+}
+
+static void download_task(void *arg) {
+    PagePrefetch *prefetch = arg;
+
+    http_set_cancel_token(prefetch->cancel);
+    if (!is_cancelled(prefetch)) {
+        download_pages(prefetch);
+    }
+    finish_prefetch(prefetch);
+}
+
+// Let the chapter being read download first: rather than holding a worker
+// while it runs, queue behind it and have its completion start the download
+static bool chain_after(PagePrefetch *prefetch) {
+    PagePrefetch *after = prefetch->after;
+    if (!after) return false;
+
+    pthread_mutex_lock(&after->lock);
+    bool chained = !after->complete;
+    if (chained) {
+        prefetch->next_waiting = after->waiting;
+        after->waiting = prefetch;
+    }
+    pthread_mutex_unlock(&after->lock);
+    return chained;
+}
+
+static void prefetch_task(void *arg) {
+    PagePrefetch *prefetch = arg;
+
+    // The page list request and every page download stop the moment the owner lets go
+    http_set_cancel_token(prefetch->cancel);
+
+    if (!prefetch->pages) {
+        prefetch->pages = manga_get_chapter_pages(prefetch->chapter_id);
+    }
+
+    ChapterPages *pages = prefetch->pages;
+    if (pages && pages->page_urls && pages->page_count > 0 && prepare_paths(prefetch, pages)) {
+        if (chain_after(prefetch)) {
+            return; // Resumed by download_task
+        }
+        download_task(prefetch);
+        return;
+    }
+
+    finish_prefetch(prefetch);
+}
+
+PagePrefetch* prefetch_chapter_start(const char *chapter_id, ChapterPages *pages, PagePrefetch *after) {
+    if (!chapter_id) {
+        manga_free_chapter_pages(pages);
+        return NULL;
+    }
+
+    PagePrefetch *prefetch = calloc(1, sizeof(PagePrefetch));
+    CancelToken *cancel = cancel_token_new();
+    if (!prefetch || !cancel) {
+        fprintf(stderr, "Failed to allocate memory for page prefetch\n");
+        free(prefetch);
+        cancel_token_free(cancel);
+        manga_free_chapter_pages(pages);
+        return NULL;
+    }
+
+    pthread_mutex_init(&prefetch->lock, NULL);
+    pthread_cond_init(&prefetch->changed, NULL);
+    prefetch->refs = 2; // owner and download thread
+    prefetch->cancel = cancel;
+    prefetch->chapter_id = safe_strdup(chapter_id);
+    prefetch->pages = pages;
+    prefetch->page_count = -1;
+
+    if (after) {
+        pthread_mutex_lock(&after->lock);
+        after->refs++;
+        pthread_mutex_unlock(&after->lock);
+        prefetch->after = after;
+    }
+
+    if (!worker_pool_submit(prefetch_task, NULL, prefetch)) {
+        fprintf(stderr, "Failed to start page prefetch\n");
+        if (after) release_prefetch(after);
+        prefetch->refs = 1;
+        prefetch->page_count = 0;
+        release_prefetch(prefetch);
+        return NULL;
+    }
+
+    return prefetch;
+}
+
+// Caller holds the lock
+static bool pages_ready(PagePrefetch *prefetch, int first, int pages) {
+    if (prefetch->complete) return true;
+    if (prefetch->page_count < 0) return false;
+
+    int end = first + pages;
+    if (end > prefetch->page_count) end = prefetch->page_count;
+    for (int i = first; i < end; i++) {
+        if (prefetch->states[i] == PAGE_PENDING) return false;
+    }
+    return true;
+}
+
+bool prefetch_wait(PagePrefetch *prefetch, int first, int pages, int timeout_ms) {
+    if (!prefetch) return true;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&prefetch->lock);
+    bool ready;
+    while (!(ready = pages_ready(prefetch, first, pages))) {
+        if (pthread_cond_timedwait(&prefetch->changed, &prefetch->lock, &deadline) != 0) {
+            ready = pages_ready(prefetch, first, pages);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return ready;
+}
+
+int prefetch_page_count(PagePrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    int count = prefetch->page_count;
+    pthread_mutex_unlock(&prefetch->lock);
+    return count;
+}
+
+int prefetch_pages_finished(PagePrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    int finished = prefetch->finished;
+    pthread_mutex_unlock(&prefetch->lock);
+    return finished;
+}
+
+int prefetch_pages_ready(PagePrefetch *prefetch, int first) {
+    pthread_mutex_lock(&prefetch->lock);
+    int ready = 0;
+    for (int i = first; i >= 0 && i < prefetch->page_count; i++) {
+        if (prefetch->states[i] == PAGE_PENDING) break;
+        ready++;
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+    return ready;
+}
+
+const char* prefetch_page_path(PagePrefetch *prefetch, int index) {
+    const char *path = NULL;
+
+    pthread_mutex_lock(&prefetch->lock);
+    if (index >= 0 && index < prefetch->page_count && prefetch->states[index] == PAGE_DONE) {
+        path = prefetch->paths[index];
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return path;
+}
+
+void prefetch_free(PagePrefetch *prefetch) {
+    if (!prefetch) return;
+
+    pthread_mutex_lock(&prefetch->lock);
+    cancel_token_cancel(prefetch->cancel);
+    pthread_cond_broadcast(&prefetch->changed);
+    pthread_mutex_unlock(&prefetch->lock);
+
+    release_prefetch(prefetch);
+}
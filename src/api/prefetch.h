@@ -0,0 +1,51 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+#include "manga.h"
+
+// Background download of a chapter's pages to local files
+typedef struct PagePrefetch PagePrefetch;
+
+/**
+ * Start downloading every page of a chapter on a background thread
+ * Pages land in Config.download_directory/<chapter id>/ in parallel,
+ * lowest page numbers first, with the chapter's referer applied. Pages
+ * already on disk are not downloaded again.
+ * @param chapter_id Chapter to download
+ * @param pages Page list (ownership is taken), or NULL to fetch it in the background
+ * @param after Optional prefetch whose pages must finish before this one
+ *              starts downloading images (the page list is fetched right away)
+ * @return Prefetch handle (release with prefetch_free) or NULL on error
+ */
+PagePrefetch* prefetch_chapter_start(const char *chapter_id, ChapterPages *pages, PagePrefetch *after);
+
+/**
+ * Wait until a run of pages is available
+ * @param prefetch The prefetch to wait on
+ * @param first Index of the first page required
+ * @param pages Number of pages required from first on
+ * @param timeout_ms Maximum time to wait
+ * @return true once those pages finished (or everything that will ever finish did)
+ */
+bool prefetch_wait(PagePrefetch *prefetch, int first, int pages, int timeout_ms);
+
+// Number of pages in the chapter, or -1 while the page list is still loading
+int prefetch_page_count(PagePrefetch *prefetch);
+
+// Number of pages that finished downloading (successfully or not)
+int prefetch_pages_finished(PagePrefetch *prefetch);
+
+// Number of pages from first on that finished (successfully or not) with none pending in between
+int prefetch_pages_ready(PagePrefetch *prefetch, int first);
+
+// Local path of a downloaded page, or NULL while it is pending or when it failed
+const char* prefetch_page_path(PagePrefetch *prefetch, int index);
+
+/**
+ * Stop the prefetch and release it
+ * Pages already downloaded stay on disk.
+ */
+void prefetch_free(PagePrefetch *prefetch);
+
+#endif /* PREFETCH_H */
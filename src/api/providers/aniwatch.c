@@ -1,56 +1,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <curl/curl.h>
 #include <json-c/json.h>
 #include "aniwatch.h"
+#include "../http.h"
+#include "../json_view.h"
+#include "../lazy_list.h"
 #include "../../config.h"
 #include "../../utils/memory.h"
 
-#define ANIWATCH_API_BASE_URL "https://aniwatch-api-2.thuanc177.me"
-
-typedef struct {
-    char *data;
-    size_t size;
-} MemoryStruct;
-
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, MemoryStruct *userp) {
-    size_t realsize = size * nmemb;
-    userp->data = realloc(userp->data, userp->size + realsize + 1);
-    if (userp->data == NULL) {
-        printf("Not enough memory (realloc returned NULL)\n");
-        return 0;
-    }
-    memcpy(&(userp->data[userp->size]), contents, realsize);
-    userp->size += realsize;
-    userp->data[userp->size] = 0;
-    return realsize;
-}
+#define ANIWATCH_DEFAULT_BASE_URL "https://aniwatch-api-2.thuanc177.me"
+#define ANIWATCH_API_BASE_URL provider_base_url("ANIWATCH_API_BASE_URL", ANIWATCH_DEFAULT_BASE_URL)
 
 // Remove the replace_spaces_with_hyphens function as we'll use proper URL encoding instead
 
 SearchResult* aniwatch_search_anime(const char *query) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
     char url[512];
     char *encoded_query = NULL;
     
     fprintf(stderr, "DEBUG: AniWatch search query: '%s'\n", query);
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-    
     // Properly URL encode the query string
-    encoded_query = curl_easy_escape(curl, query, 0);
+    encoded_query = http_escape(query);
     if (!encoded_query) {
         fprintf(stderr, "Failed to URL-encode query string\n");
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -60,31 +33,16 @@ SearchResult* aniwatch_search_anime(const char *query) {
     fprintf(stderr, "DEBUG: AniWatch Requesting URL: %s\n", url);
     
     // Free the encoded query after building the URL
-    curl_free(encoded_query);
-    
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
+    free(encoded_query);
+    
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, HTTP_CACHE_TTL_SEARCH, &json_obj)) {
         return NULL;
     }
     
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
     if (!json_obj) {
         fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -94,8 +52,6 @@ SearchResult* aniwatch_search_anime(const char *query) {
         !json_object_get_boolean(success_obj)) {
         fprintf(stderr, "API returned unsuccessful response\n");
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -104,8 +60,6 @@ SearchResult* aniwatch_search_anime(const char *query) {
     if (!json_object_object_get_ex(json_obj, "data", &data_obj)) {
         fprintf(stderr, "No data field in response\n");
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -114,34 +68,19 @@ SearchResult* aniwatch_search_anime(const char *query) {
     if (!json_object_object_get_ex(data_obj, "animes", &animes_array)) {
         fprintf(stderr, "No animes field in data\n");
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
-    // Create search result structure
-    SearchResult *search_result = malloc(sizeof(SearchResult));
-    if (!search_result) {
-        fprintf(stderr, "Failed to allocate memory for search results\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    // Create search result structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    SearchResult *search_result = arena_alloc(arena, sizeof(SearchResult));
+    search_result->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
     
     // Get array length
     int num_results = json_object_array_length(animes_array);
     search_result->total_results = num_results;
-    search_result->results = malloc(num_results * sizeof(SearchResultItem));
-    
-    if (!search_result->results) {
-        fprintf(stderr, "Failed to allocate memory for anime results\n");
-        free(search_result);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    search_result->results = arena_alloc(arena, num_results * sizeof(SearchResultItem));
     
     // Extract each result
     for (int i = 0; i < num_results; i++) {
@@ -149,17 +88,17 @@ SearchResult* aniwatch_search_anime(const char *query) {
         struct json_object *field;
         
         if (json_object_object_get_ex(result_obj, "id", &field))
-            search_result->results[i].id = safe_strdup(json_object_get_string(field));
+            search_result->results[i].id = json_strings_get(&strings, field);
         else
             search_result->results[i].id = NULL;
         
         if (json_object_object_get_ex(result_obj, "name", &field))
-            search_result->results[i].title = safe_strdup(json_object_get_string(field));
+            search_result->results[i].title = json_strings_get(&strings, field);
         else
             search_result->results[i].title = NULL;
         
         if (json_object_object_get_ex(result_obj, "poster", &field))
-            search_result->results[i].image = safe_strdup(json_object_get_string(field));
+            search_result->results[i].image = json_strings_get(&strings, field);
         else
             search_result->results[i].image = NULL;
         
@@ -186,62 +125,38 @@ SearchResult* aniwatch_search_anime(const char *query) {
     
     // Clean up
     json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
     
     return search_result;
 }
 
-AnimeInfo* aniwatch_get_anime_info(const char *anime_id) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
-    char url[512];
-    
-    // Build URL for anime episodes endpoint
-    snprintf(url, sizeof(url), "%s/api/v2/hianime/anime/%s/episodes", ANIWATCH_API_BASE_URL, anime_id);
-    
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-    
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
-    if (!json_obj) {
-        fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
+// Convert one element of the episodes array
+static void parse_episode(const JsonStrings *strings, struct json_object *episode_obj, int index,
+                          Episode *episode) {
+    struct json_object *field;
+    
+    if (json_object_object_get_ex(episode_obj, "episodeId", &field))
+        episode->id = json_strings_get(strings, field);
+    else
+        episode->id = NULL;
+        
+    if (json_object_object_get_ex(episode_obj, "number", &field))
+        episode->number = json_object_get_int(field);
+    else
+        episode->number = index + 1;
+        
+    if (json_object_object_get_ex(episode_obj, "title", &field))
+        episode->title = json_strings_get(strings, field);
+    else
+        episode->title = NULL;
+}
+
+// Convert an episodes response (whose episode array may have been split off)
+static AnimeInfo* parse_anime_info(struct json_object *json_obj, const char *anime_id) {
     // Check if the response was successful
     struct json_object *success_obj;
     if (!json_object_object_get_ex(json_obj, "success", &success_obj) || 
         !json_object_get_boolean(success_obj)) {
         fprintf(stderr, "API returned unsuccessful response\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -249,25 +164,18 @@ AnimeInfo* aniwatch_get_anime_info(const char *anime_id) {
     struct json_object *data_obj;
     if (!json_object_object_get_ex(json_obj, "data", &data_obj)) {
         fprintf(stderr, "No data field in response\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
-    // Create anime info structure
-    AnimeInfo *info = calloc(1, sizeof(AnimeInfo));
-    if (!info) {
-        fprintf(stderr, "Failed to allocate memory for anime info\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    // Create anime info structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    AnimeInfo *info = arena_calloc(arena, 1, sizeof(AnimeInfo));
+    info->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
     
     // Set basic anime info
-    info->id = safe_strdup(anime_id);
-    info->title = safe_strdup(anime_id); // Use anime_id as title since we don't have title in the episodes endpoint
+    info->id = arena_strdup(arena, anime_id);
+    info->title = arena_strdup(arena, anime_id); // Use anime_id as title since we don't have title in the episodes endpoint
     
     // Extract total episodes
     struct json_object *total_episodes_obj;
@@ -281,113 +189,203 @@ AnimeInfo* aniwatch_get_anime_info(const char *anime_id) {
     struct json_object *episodes_array;
     if (json_object_object_get_ex(data_obj, "episodes", &episodes_array)) {
         int num_episodes = json_object_array_length(episodes_array);
-        info->episodes = calloc(num_episodes, sizeof(Episode));
-        
-        if (!info->episodes) {
-            fprintf(stderr, "Failed to allocate memory for episodes\n");
-            free(info->id);
-            free(info->title);
-            free(info);
-            json_object_put(json_obj);
-            free(chunk.data);
-            curl_global_cleanup();
-            return NULL;
-        }
+        info->episodes = arena_calloc(arena, num_episodes, sizeof(Episode));
         
         for (int i = 0; i < num_episodes; i++) {
             struct json_object *episode_obj = json_object_array_get_idx(episodes_array, i);
-            struct json_object *field;
-            
-            if (json_object_object_get_ex(episode_obj, "episodeId", &field))
-                info->episodes[i].id = safe_strdup(json_object_get_string(field));
-            else
-                info->episodes[i].id = NULL;
-                
-            if (json_object_object_get_ex(episode_obj, "number", &field))
-                info->episodes[i].number = json_object_get_int(field);
-            else
-                info->episodes[i].number = i + 1;
-                
-            if (json_object_object_get_ex(episode_obj, "title", &field))
-                info->episodes[i].title = safe_strdup(json_object_get_string(field));
-            else
-                info->episodes[i].title = NULL;
+            parse_episode(&strings, episode_obj, i, &info->episodes[i]);
         }
+        
+        // Menus index the episode array by total_episodes
+        info->total_episodes = num_episodes;
     }
     
-    // Clean up
-    json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
-    
     return info;
 }
 
-StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *server) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
-    char url[512];
-    char *encoded_id = NULL;
+// Take a string field when the response has a value for it
+static void get_string(const JsonStrings *strings, struct json_object *obj, const char *key, char **dest) {
+    struct json_object *field;
+    char *value;
+    if (json_object_object_get_ex(obj, key, &field) && (value = json_strings_get(strings, field))) {
+        *dest = value;
+    }
+}
+
+// Merge an anime details response (data.anime.info and data.anime.moreInfo)
+// into an info built from the episodes endpoint
+static void parse_anime_details(struct json_object *json_obj, AnimeInfo *info) {
+    struct json_object *success_obj, *data_obj, *anime_obj;
+    if (!json_object_object_get_ex(json_obj, "success", &success_obj) ||
+        !json_object_get_boolean(success_obj) ||
+        !json_object_object_get_ex(json_obj, "data", &data_obj) ||
+        !json_object_object_get_ex(data_obj, "anime", &anime_obj)) {
+        fprintf(stderr, "No anime details in response\n");
+        return;
+    }
+    JsonStrings strings = json_strings_begin(info->arena, json_obj);
     
-    // Use default server if none provided
-    if (!server) server = "hd-1";
+    struct json_object *section, *field;
+    if (json_object_object_get_ex(anime_obj, "info", &section)) {
+        get_string(&strings, section, "name", &info->title);
+        get_string(&strings, section, "poster", &info->image);
+        get_string(&strings, section, "description", &info->description);
+        
+        struct json_object *stats_obj, *episodes_obj;
+        if (json_object_object_get_ex(section, "stats", &stats_obj) &&
+            json_object_object_get_ex(stats_obj, "episodes", &episodes_obj)) {
+            if (json_object_object_get_ex(episodes_obj, "sub", &field))
+                info->sub_episodes = json_object_get_int(field);
+            if (json_object_object_get_ex(episodes_obj, "dub", &field))
+                info->dub_episodes = json_object_get_int(field);
+        }
+    }
     
-    // URL encode the episode_id to handle special characters like "?"
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
+    if (json_object_object_get_ex(anime_obj, "moreInfo", &section)) {
+        get_string(&strings, section, "status", &info->status);
+        get_string(&strings, section, "aired", &info->release_date);
+        
+        if (json_object_object_get_ex(section, "genres", &field) &&
+            json_object_is_type(field, json_type_array)) {
+            int count = json_object_array_length(field);
+            info->genres = arena_calloc(info->arena, count, sizeof(char*));
+            info->genres_count = 0;
+            for (int i = 0; i < count; i++) {
+                char *genre = json_strings_get(&strings, json_object_array_get_idx(field, i));
+                if (genre) info->genres[info->genres_count++] = genre;
+            }
+        }
     }
     
-    // Properly encode the episode ID
-    encoded_id = curl_easy_escape(curl, episode_id, 0);
-    if (!encoded_id) {
-        fprintf(stderr, "Failed to URL-encode episode ID\n");
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
+    if (info->sub_episodes > 0 || info->dub_episodes > 0) {
+        info->sub_or_dub = arena_strdup(info->arena, info->sub_episodes > 0 && info->dub_episodes > 0 ? "both" :
+                                                     info->sub_episodes > 0 ? "sub" : "dub");
+    }
+}
+
+// The two endpoints behind an info; fetched together, they cost one round trip
+static void build_info_urls(const char *anime_id, char *episodes_url, char *details_url, size_t size) {
+    snprintf(episodes_url, size, "%s/api/v2/hianime/anime/%s/episodes", ANIWATCH_API_BASE_URL, anime_id);
+    snprintf(details_url, size, "%s/api/v2/hianime/anime/%s", ANIWATCH_API_BASE_URL, anime_id);
+}
+
+static const int info_ttls[] = { HTTP_CACHE_TTL_EPISODES, HTTP_CACHE_TTL_INFO };
+
+AnimeInfo* aniwatch_get_anime_info(const char *anime_id) {
+    char episodes_url[512], details_url[512];
+    build_info_urls(anime_id, episodes_url, details_url, sizeof(episodes_url));
+    const char *urls[] = { episodes_url, details_url };
+    
+    // Perform both requests at once, parsing the bodies as they arrive
+    struct json_object *json[2] = { NULL, NULL };
+    bool ok[2] = { false, false };
+    if (!http_get_json_many(urls, info_ttls, NULL, json, ok, 2) || !json[0]) {
+        if (ok[0] && !json[0]) fprintf(stderr, "Failed to parse JSON response\n");
+        if (json[0]) json_object_put(json[0]);
+        if (json[1]) json_object_put(json[1]);
         return NULL;
     }
     
-    // Build URL for episode streaming info endpoint
-    snprintf(url, sizeof(url), "%s/api/v2/hianime/episode/sources?animeEpisodeId=%s&server=%s&category=sub", 
-             ANIWATCH_API_BASE_URL, encoded_id, server);
-    
-    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
+    // Without details the info still lists the episodes, titled by its ID
+    AnimeInfo *info = parse_anime_info(json[0], anime_id);
+    if (info && json[1]) {
+        parse_anime_details(json[1], info);
+    }
+    json_object_put(json[0]);
+    if (json[1]) json_object_put(json[1]);
     
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_free(encoded_id); // Free encoded ID
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        curl_easy_cleanup(curl);
-        free(chunk.data);
-        curl_global_cleanup();
+    return info;
+}
+
+// Loader of an info opened with aniwatch_open_anime_info, owned by its episode list
+typedef struct {
+    LazyList *list;
+    char *anime_id;
+    Arena *arena;        // Episode strings
+    AnimeInfo *summary;  // The response without its episodes, once complete
+} EpisodeLoad;
+
+// The endpoint has no pagination, so episodes are taken from the response as it streams
+static const char *const episodes_path[] = { "data", "episodes", NULL };
+
+static bool push_episode(struct json_object *element, int index, void *ctx) {
+    EpisodeLoad *load = ctx;
+    JsonStrings strings = json_strings_begin(load->arena, element);
+    Episode episode = { 0 };
+    parse_episode(&strings, element, index, &episode);
+    return lazy_list_push(load->list, &episode);
+}
+
+static void* load_episodes(LazyList *list, void *ctx) {
+    EpisodeLoad *load = ctx;
+    load->list = list;
+    
+    char episodes_url[512], details_url[512];
+    build_info_urls(load->anime_id, episodes_url, details_url, sizeof(episodes_url));
+    const char *urls[] = { episodes_url, details_url };
+    
+    // Episodes stream into the list while the details download alongside
+    const HttpJsonSplit splits[] = {
+        { episodes_path, push_episode, load },
+        { NULL, NULL, NULL }
+    };
+    struct json_object *json[2] = { NULL, NULL };
+    bool ok[2] = { false, false };
+    if (!http_get_json_many(urls, info_ttls, splits, json, ok, 2) || !json[0]) {
+        if (json[0]) json_object_put(json[0]);
+        if (json[1]) json_object_put(json[1]);
         return NULL;
     }
     
-    curl_easy_cleanup(curl);
-    
-    // Print the first part of the response for debugging
-    fprintf(stderr, "DEBUG: Response start: %.100s...\n", chunk.data);
-    
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
-    if (!json_obj) {
-        fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
+    load->summary = parse_anime_info(json[0], load->anime_id);
+    if (load->summary && json[1]) {
+        parse_anime_details(json[1], load->summary);
+    }
+    json_object_put(json[0]);
+    if (json[1]) json_object_put(json[1]);
+    return load->summary;
+}
+
+static void release_load(void *ctx) {
+    EpisodeLoad *load = ctx;
+    aniwatch_free_anime_info(load->summary);
+    arena_destroy(load->arena);
+    free(load->anime_id);
+    free(load);
+}
+
+static void free_episode_list(void *list) {
+    lazy_list_free(list);
+}
+
+AnimeInfo* aniwatch_open_anime_info(const char *anime_id) {
+    EpisodeLoad *load = calloc(1, sizeof(EpisodeLoad));
+    if (!load) {
+        fprintf(stderr, "Failed to allocate memory for episode loader\n");
         return NULL;
     }
+    load->anime_id = safe_strdup(anime_id);
+    load->arena = arena_create(0);
+    
+    // Only the ID is known until the response is complete
+    Arena *arena = arena_create(0);
+    AnimeInfo *info = arena_calloc(arena, 1, sizeof(AnimeInfo));
+    info->arena = arena;
+    info->id = arena_strdup(arena, anime_id);
+    info->title = info->id;
+    
+    info->episode_list = lazy_list_start(sizeof(Episode), provider_type_to_string(PROVIDER_ANIWATCH),
+                                         load_episodes, load, release_load);
+    if (!info->episode_list) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    arena_defer(arena, free_episode_list, info->episode_list);
+    
+    return info;
+}
 
+StreamInfo* aniwatch_parse_episode_stream(struct json_object *json_obj) {
     // Check if the response was successful
     struct json_object *success_obj;
 
@@ -395,9 +393,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     if (!json_object_object_get_ex(json_obj, "success", &success_obj) || 
         !json_object_get_boolean(success_obj)) {
         fprintf(stderr, "API returned unsuccessful response\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -405,9 +400,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     struct json_object *data_obj;
     if (!json_object_object_get_ex(json_obj, "data", &data_obj)) {
         fprintf(stderr, "No data field in response\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -415,9 +407,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     StreamInfo *stream_info = calloc(1, sizeof(StreamInfo));
     if (!stream_info) {
         fprintf(stderr, "Failed to allocate memory for stream info\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -426,9 +415,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     if (!json_object_object_get_ex(data_obj, "sources", &sources_array)) {
         fprintf(stderr, "No sources field in data\n");
         free(stream_info);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -437,9 +423,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     if (num_sources <= 0) {
         fprintf(stderr, "No streaming sources available\n");
         free(stream_info);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -450,9 +433,6 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
     if (!stream_info->sources) {
         fprintf(stderr, "Memory allocation failed\n");
         free(stream_info);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -547,22 +527,103 @@ StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *serv
         }
     }
     
-    // Clean up
-    json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
+    return stream_info;
+}
+
+StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *server, const char *category) {
+    char url[512];
+    char *encoded_id = NULL;
+    
+    // Use default server if none provided
+    if (!server) server = "hd-1";
+    if (!category) category = "sub";
+    
+    // URL encode the episode_id to handle special characters like "?"
+    encoded_id = http_escape(episode_id);
+    if (!encoded_id) {
+        fprintf(stderr, "Failed to URL-encode episode ID\n");
+        return NULL;
+    }
+    
+    // Build URL for episode streaming info endpoint
+    snprintf(url, sizeof(url), "%s/api/v2/hianime/episode/sources?animeEpisodeId=%s&server=%s&category=%s", 
+             ANIWATCH_API_BASE_URL, encoded_id, server, category);
+    
+    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
+    
+    free(encoded_id); // Free encoded ID
+    
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, 0, &json_obj)) {
+        return NULL;
+    }
     
+    if (!json_obj) {
+        fprintf(stderr, "Failed to parse JSON response\n");
+        return NULL;
+    }
+
+    StreamInfo *stream_info = aniwatch_parse_episode_stream(json_obj);
+    json_object_put(json_obj);
+
     return stream_info;
 }
 
+void aniwatch_free_search_results(SearchResult *results) {
+    if (!results) return;
+    
+    // Releases the structure along with every string it points to
+    arena_destroy(results->arena);
+}
+
+void aniwatch_free_anime_info(AnimeInfo *info) {
+    if (!info) return;
+    
+    // Releases the structure along with every string it points to
+    arena_destroy(info->arena);
+}
+
+void aniwatch_free_stream_info(StreamInfo *info) {
+    if (!info) return;
+    
+    free(info->referer);
+    free(info->user_agent);
+    
+    if (info->sources) {
+        for (int i = 0; i < info->sources_count; i++) {
+            free(info->sources[i].url);
+            free(info->sources[i].quality);
+        }
+        free(info->sources);
+    }
+    
+    if (info->subtitles) {
+        for (int i = 0; i < info->subtitles_count; i++) {
+            free(info->subtitles[i].url);
+            free(info->subtitles[i].lang);
+        }
+        free(info->subtitles);
+    }
+    
+    free(info);
+}
+
+// Servers and categories worth racing, preferred first
+static const char *const aniwatch_stream_servers[] = { "hd-1", "hd-2", NULL };
+static const char *const aniwatch_stream_categories[] = { "sub", "dub", NULL };
+
 // Define the Provider API
 const ProviderAPI aniwatch_provider_api = {
     .search = aniwatch_search_anime,
-    .free_search_results = NULL, // Use generic free function
+    .free_search_results = aniwatch_free_search_results,
     .get_anime_info = (void* (*)(const char*))aniwatch_get_anime_info,
-    .get_episode_stream = (void* (*)(const char*, const char*))aniwatch_get_episode_stream,
-    .free_anime_info = NULL, // Use generic free function
-    .free_stream_info = NULL, // Use generic free function
+    .open_anime_info = (void* (*)(const char*))aniwatch_open_anime_info,
+    .get_episode_stream = (void* (*)(const char*, const char*, const char*))aniwatch_get_episode_stream,
+    .free_anime_info = (void (*)(void*))aniwatch_free_anime_info,
+    .free_stream_info = (void (*)(void*))aniwatch_free_stream_info,
+    .stream_servers = aniwatch_stream_servers,
+    .stream_categories = aniwatch_stream_categories,
     // Manga functions are not supported
     .get_manga_info = NULL,
     .get_chapter_pages = NULL,
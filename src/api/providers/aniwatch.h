@@ -3,6 +3,8 @@
 
 #include "../anime.h"
 
+struct json_object;
+
 /**
  * Search for anime on AniWatch
  * @param query The search query
@@ -17,13 +19,34 @@ SearchResult* aniwatch_search_anime(const char *query);
  */
 AnimeInfo* aniwatch_get_anime_info(const char *id);
 
+/**
+ * Start loading an anime's information in the background
+ * Returns at once; episodes arrive through anime_info_update.
+ * @param id The anime ID
+ * @return Anime information structure or NULL on error
+ */
+AnimeInfo* aniwatch_open_anime_info(const char *id);
+
 /**
  * Get streaming links for an episode
  * @param episode_id The episode ID
  * @param server Optional server name (defaults to "hd-1" if NULL)
+ * @param category Optional audio category, "sub" or "dub" (defaults to "sub" if NULL)
  * @return Stream information structure or NULL on error
  */
-StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *server);
+StreamInfo* aniwatch_get_episode_stream(const char *episode_id, const char *server, const char *category);
+
+/**
+ * Convert an episode sources response into a stream info structure
+ * @param json Parsed response body (not consumed)
+ * @return Stream information structure or NULL if the response is unusable
+ */
+StreamInfo* aniwatch_parse_episode_stream(struct json_object *json);
+
+// Free resources
+void aniwatch_free_search_results(SearchResult *results);
+void aniwatch_free_anime_info(AnimeInfo *info);
+void aniwatch_free_stream_info(StreamInfo *info);
 
 // Get Zoro provider API
 const ProviderAPI* aniwatch_get_api();
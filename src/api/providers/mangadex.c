@@ -1,130 +1,62 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <curl/curl.h>
 #include <json-c/json.h>
 #include "mangadex.h"
+#include "../http.h"
+#include "../json_view.h"
+#include "../lazy_list.h"
 #include "../../utils/memory.h"
 
-#define MANGADEX_API_BASE_URL "https://consumet.thuanc177.me/manga/mangadex"
-
-typedef struct {
-    char *data;
-    size_t size;
-} MemoryStruct;
-
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    MemoryStruct *mem = (MemoryStruct *)userp;
-    
-    char *ptr = realloc(mem->data, mem->size + realsize + 1);
-    if (!ptr) {
-        fprintf(stderr, "Not enough memory (realloc returned NULL)\n");
-        return 0;
-    }
-    
-    mem->data = ptr;
-    memcpy(&(mem->data[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->data[mem->size] = 0;
-    
-    return realsize;
-}
+#define MANGADEX_DEFAULT_BASE_URL "https://consumet.thuanc177.me/manga/mangadex"
+#define MANGADEX_API_BASE_URL provider_base_url("MANGADEX_API_BASE_URL", MANGADEX_DEFAULT_BASE_URL)
 
 SearchResult* mangadex_search_manga(const char *query) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
     char url[512];
     
     // URL encode the query
-    CURL *curl_handle = curl_easy_init();
-    if (!curl_handle) {
-        fprintf(stderr, "Failed to initialize curl for URL encoding\n");
+    char *encoded_query = http_escape(query);
+    if (!encoded_query) {
+        fprintf(stderr, "Failed to URL-encode query string\n");
         return NULL;
     }
     
-    char *encoded_query = curl_easy_escape(curl_handle, query, 0);
-    curl_easy_cleanup(curl_handle);
-    
     // Build URL for manga search endpoint
     snprintf(url, sizeof(url), "%s/%s", 
              MANGADEX_API_BASE_URL, encoded_query);
     fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
     
-    curl_free(encoded_query);
+    free(encoded_query);
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, HTTP_CACHE_TTL_SEARCH, &json_obj)) {
         return NULL;
     }
     
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
     if (!json_obj) {
         fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
-    // Create search result structure
-    SearchResult *search_result = malloc(sizeof(SearchResult));
-    if (!search_result) {
-        fprintf(stderr, "Failed to allocate memory for search results\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
-    // Initialize search result
-    search_result->total_results = 0;
-    search_result->results = NULL;
-    
     // Extract results array
     struct json_object *results_array;
     if (!json_object_object_get_ex(json_obj, "results", &results_array)) {
         fprintf(stderr, "No results field in JSON response\n");
-        free(search_result);
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
+    // Create search result structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    SearchResult *search_result = arena_alloc(arena, sizeof(SearchResult));
+    search_result->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
+    
     // Get array length
     int num_results = json_object_array_length(results_array);
     search_result->total_results = num_results;
-    search_result->results = malloc(num_results * sizeof(SearchResultItem));
-    
-    if (!search_result->results) {
-        fprintf(stderr, "Failed to allocate memory for manga results\n");
-        free(search_result);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    search_result->results = arena_alloc(arena, num_results * sizeof(SearchResultItem));
     
     // Extract each result
     for (int i = 0; i < num_results; i++) {
@@ -140,15 +72,15 @@ SearchResult* mangadex_search_manga(const char *query) {
         
         // Get manga ID
         if (json_object_object_get_ex(manga_obj, "id", &field))
-            search_result->results[i].id = strdup(json_object_get_string(field));
+            search_result->results[i].id = json_strings_get(&strings, field);
         
         // Get title
         if (json_object_object_get_ex(manga_obj, "title", &field))
-            search_result->results[i].title = strdup(json_object_get_string(field));
+            search_result->results[i].title = json_strings_get(&strings, field);
         
         // Get image
         if (json_object_object_get_ex(manga_obj, "image", &field))
-            search_result->results[i].image = strdup(json_object_get_string(field));
+            search_result->results[i].image = json_strings_get(&strings, field);
         
         // Extract chapter/volume information with better fallback mechanism
         search_result->results[i].episodes_or_chapters = 0;
@@ -199,77 +131,51 @@ SearchResult* mangadex_search_manga(const char *query) {
     
     // Clean up
     json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
     
     return search_result;
 }
 
-MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
-    char url[512];
-    
-    // Build URL for manga info endpoint - UPDATED FORMAT
-    snprintf(url, sizeof(url), "%s/info/%s", 
-             MANGADEX_API_BASE_URL, manga_id);
-    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
-    
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-    
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Add timeout to prevent hanging
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L); // 15 seconds timeout
+// Convert one element of the chapters array
+static void parse_chapter(const JsonStrings *strings, struct json_object *chapter, int index,
+                          MangadexChapter *out) {
+    struct json_object *field;
     
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+    // Initialize chapter data
+    out->id = NULL;
+    out->title = NULL;
+    out->releaseDate = NULL;
+    out->number = index + 1;  // Default to index + 1
     
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    // Get chapter ID - this is important for reading
+    if (json_object_object_get_ex(chapter, "id", &field) && field)
+        out->id = json_strings_get(strings, field);
     
-    // Debug response
-    fprintf(stderr, "Response size: %zu bytes\n", chunk.size);
-    if (chunk.size > 0) {
-        // Print first 200 characters for debug
-        char preview[201] = {0};
-        strncpy(preview, chunk.data, 200);
-        fprintf(stderr, "Response preview: %s\n", preview);
-    }
-    
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
-    if (!json_obj) {
-        fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
+    // Get chapter title
+    if (json_object_object_get_ex(chapter, "title", &field) && field && 
+        !json_object_is_type(field, json_type_null)) {
+        out->title = json_strings_get(strings, field);
+    } else {
+        // If title is null, create a default title
+        char default_title[32];
+        snprintf(default_title, sizeof(default_title), "Chapter %d", index + 1);
+        out->title = arena_strdup(strings->arena, default_title);
     }
     
-    // Create manga info structure
-    MangadexMangaInfo *info = calloc(1, sizeof(MangadexMangaInfo));
-    if (!info) {
-        fprintf(stderr, "Failed to allocate memory for manga info\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
+    // Get chapter number
+    if (json_object_object_get_ex(chapter, "chapterNumber", &field) && field && 
+        !json_object_is_type(field, json_type_null)) {
+        const char *chapterNumStr = json_object_get_string(field);
+        if (chapterNumStr)
+            out->number = atof(chapterNumStr); // Using atof for decimal chapter numbers
     }
+}
+
+MangadexMangaInfo* mangadex_parse_manga_info(struct json_object *json_obj, const char *manga_id) {
+    // Create manga info structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    MangadexMangaInfo *info = arena_calloc(arena, 1, sizeof(MangadexMangaInfo));
+    info->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
     
     // Initialize all pointers to NULL
     info->id = NULL;
@@ -289,19 +195,19 @@ MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
     
     // Get manga ID
     if (json_object_object_get_ex(json_obj, "id", &field) && field)
-        info->id = strdup(json_object_get_string(field));
+        info->id = json_strings_get(&strings, field);
     else
-        info->id = strdup(manga_id); // Fallback to requested ID
+        info->id = arena_strdup(arena, manga_id); // Fallback to requested ID
     
     // Get title
     if (json_object_object_get_ex(json_obj, "title", &field) && field)
-        info->title = strdup(json_object_get_string(field));
+        info->title = json_strings_get(&strings, field);
     else
-        info->title = strdup("Unknown Title");
+        info->title = arena_strdup(arena, "Unknown Title");
     
     // Get image
     if (json_object_object_get_ex(json_obj, "image", &field) && field)
-        info->image = strdup(json_object_get_string(field));
+        info->image = json_strings_get(&strings, field);
     
     // Get description - Handle description as an object with language keys
     struct json_object *desc_obj;
@@ -310,27 +216,27 @@ MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
             // Try to get English description first
             struct json_object *en_desc;
             if (json_object_object_get_ex(desc_obj, "en", &en_desc)) {
-                info->description = strdup(json_object_get_string(en_desc));
+                info->description = json_strings_get(&strings, en_desc);
             } else {
                 // If no English description, use the first available language
                 json_object_object_foreach(desc_obj, key, val) {
-                    info->description = strdup(json_object_get_string(val));
+                    info->description = json_strings_get(&strings, val);
                     break;
                 }
             }
         } else if (json_object_is_type(desc_obj, json_type_string)) {
             // If description is directly a string
-            info->description = strdup(json_object_get_string(desc_obj));
+            info->description = json_strings_get(&strings, desc_obj);
         }
     }
     
     // Get release date
     if (json_object_object_get_ex(json_obj, "releaseDate", &field) && field)
-        info->release_date = strdup(json_object_get_string(field));
+        info->release_date = json_strings_get(&strings, field);
     
     // Get status
     if (json_object_object_get_ex(json_obj, "status", &field) && field)
-        info->status = strdup(json_object_get_string(field));
+        info->status = json_strings_get(&strings, field);
     
     // Extract genres
     struct json_object *genres_array;
@@ -339,12 +245,12 @@ MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
         
         info->genres_count = json_object_array_length(genres_array);
         if (info->genres_count > 0) {
-            info->genres = calloc(info->genres_count, sizeof(char*));
+            info->genres = arena_calloc(arena, info->genres_count, sizeof(char*));
             if (info->genres) {
                 for (int i = 0; i < info->genres_count; i++) {
                     struct json_object *genre = json_object_array_get_idx(genres_array, i);
                     if (genre)
-                        info->genres[i] = strdup(json_object_get_string(genre));
+                        info->genres[i] = json_strings_get(&strings, genre);
                 }
             } else {
                 info->genres_count = 0;
@@ -361,40 +267,13 @@ MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
         fprintf(stderr, "Found %d chapters for manga\n", info->total_chapters);
         
         if (info->total_chapters > 0) {
-            info->chapters = calloc(info->total_chapters, sizeof(MangadexChapter));
+            info->chapters = arena_calloc(arena, info->total_chapters, sizeof(MangadexChapter));
             if (info->chapters) {
                 for (int i = 0; i < info->total_chapters; i++) {
                     struct json_object *chapter = json_object_array_get_idx(chapters_array, i);
                     if (!chapter) continue;
                     
-                    // Initialize chapter data
-                    info->chapters[i].id = NULL;
-                    info->chapters[i].title = NULL;
-                    info->chapters[i].releaseDate = NULL;
-                    info->chapters[i].number = i + 1;  // Default to index + 1
-                    
-                    // Get chapter ID - this is important for reading
-                    if (json_object_object_get_ex(chapter, "id", &field) && field)
-                        info->chapters[i].id = strdup(json_object_get_string(field));
-                    
-                    // Get chapter title
-                    if (json_object_object_get_ex(chapter, "title", &field) && field && 
-                        !json_object_is_type(field, json_type_null)) {
-                        info->chapters[i].title = strdup(json_object_get_string(field));
-                    } else {
-                        // If title is null, create a default title
-                        char default_title[32];
-                        snprintf(default_title, sizeof(default_title), "Chapter %d", i + 1);
-                        info->chapters[i].title = strdup(default_title);
-                    }
-                    
-                    // Get chapter number
-                    if (json_object_object_get_ex(chapter, "chapterNumber", &field) && field && 
-                        !json_object_is_type(field, json_type_null)) {
-                        const char *chapterNumStr = json_object_get_string(field);
-                        if (chapterNumStr)
-                            info->chapters[i].number = atof(chapterNumStr); // Using atof for decimal chapter numbers
-                    }
+                    parse_chapter(&strings, chapter, i, &info->chapters[i]);
                 }
             } else {
                 fprintf(stderr, "Failed to allocate memory for chapters\n");
@@ -407,18 +286,111 @@ MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
         fprintf(stderr, "No chapters field found in manga object or not an array\n");
     }
     
-    // Clean up
+    return info;
+}
+
+MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id) {
+    char url[512];
+    
+    // Build URL for manga info endpoint - UPDATED FORMAT
+    snprintf(url, sizeof(url), "%s/info/%s", 
+             MANGADEX_API_BASE_URL, manga_id);
+    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
+    
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, HTTP_CACHE_TTL_INFO, &json_obj)) {
+        return NULL;
+    }
+    
+    if (!json_obj) {
+        fprintf(stderr, "Failed to parse JSON response\n");
+        return NULL;
+    }
+    
+    MangadexMangaInfo *info = mangadex_parse_manga_info(json_obj, manga_id);
     json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
+
+    return info;
+}
+
+// Loader of an info opened with mangadex_open_manga_info, owned by its chapter list
+typedef struct {
+    LazyList *list;
+    char *manga_id;
+    Arena *arena;                // Chapter strings
+    MangadexMangaInfo *summary;  // The response without its chapters, once complete
+} ChapterLoad;
+
+// The info endpoint has no pagination, so chapters are taken from the response as it streams
+static const char *const chapters_path[] = { "chapters", NULL };
+
+static bool push_chapter(struct json_object *element, int index, void *ctx) {
+    ChapterLoad *load = ctx;
+    JsonStrings strings = json_strings_begin(load->arena, element);
+    MangadexChapter chapter;
+    parse_chapter(&strings, element, index, &chapter);
+    return lazy_list_push(load->list, &chapter);
+}
+
+static void* load_chapters(LazyList *list, void *ctx) {
+    ChapterLoad *load = ctx;
+    load->list = list;
+    
+    char url[512];
+    snprintf(url, sizeof(url), "%s/info/%s", MANGADEX_API_BASE_URL, load->manga_id);
+    
+    struct json_object *json_obj = NULL;
+    if (!http_get_json_split(url, HTTP_CACHE_TTL_INFO, chapters_path, push_chapter, load, &json_obj) ||
+        !json_obj) {
+        return NULL;
+    }
+    
+    load->summary = mangadex_parse_manga_info(json_obj, load->manga_id);
+    json_object_put(json_obj);
+    return load->summary;
+}
+
+static void release_load(void *ctx) {
+    ChapterLoad *load = ctx;
+    mangadex_free_manga_info(load->summary);
+    arena_destroy(load->arena);
+    free(load->manga_id);
+    free(load);
+}
+
+static void free_chapter_list(void *list) {
+    lazy_list_free(list);
+}
+
+MangadexMangaInfo* mangadex_open_manga_info(const char *manga_id) {
+    ChapterLoad *load = calloc(1, sizeof(ChapterLoad));
+    if (!load) {
+        fprintf(stderr, "Failed to allocate memory for chapter loader\n");
+        return NULL;
+    }
+    load->manga_id = safe_strdup(manga_id);
+    load->arena = arena_create(0);
+    
+    // Title and details are merged once the response is complete
+    Arena *arena = arena_create(0);
+    MangadexMangaInfo *info = arena_calloc(arena, 1, sizeof(MangadexMangaInfo));
+    info->arena = arena;
+    info->id = arena_strdup(arena, manga_id);
+    info->title = info->id;
+    
+    info->chapter_list = lazy_list_start(sizeof(MangadexChapter), provider_type_to_string(PROVIDER_MANGADEX),
+                                         load_chapters, load, release_load);
+    if (!info->chapter_list) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    arena_defer(arena, free_chapter_list, info->chapter_list);
     
     return info;
 }
 
 MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
     char url[512];
     
     // Build URL for chapter pages endpoint
@@ -426,63 +398,28 @@ MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
              MANGADEX_API_BASE_URL, chapter_id);
     fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_array = NULL;
+    if (!http_get_json(url, 0, &json_array)) {
         return NULL;
     }
     
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
-    // Parse JSON response
-    struct json_object *json_array = json_tokener_parse(chunk.data);
     if (!json_array || !json_object_is_type(json_array, json_type_array)) {
         fprintf(stderr, "Failed to parse JSON response or not an array\n");
         if (json_array) json_object_put(json_array);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
-    // Create chapter pages structure
-    MangadexChapterPages *pages = calloc(1, sizeof(MangadexChapterPages));
-    if (!pages) {
-        fprintf(stderr, "Failed to allocate memory for chapter pages\n");
-        json_object_put(json_array);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    // Create chapter pages structure; it and every URL live in one arena
+    Arena *arena = arena_create(0);
+    MangadexChapterPages *pages = arena_calloc(arena, 1, sizeof(MangadexChapterPages));
+    pages->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_array);
     
     // Get array length
     int num_pages = json_object_array_length(json_array);
     pages->page_count = num_pages;
-    pages->page_urls = calloc(num_pages, sizeof(char*));
-    
-    if (!pages->page_urls) {
-        fprintf(stderr, "Failed to allocate memory for page URLs\n");
-        free(pages);
-        json_object_put(json_array);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    pages->page_urls = arena_calloc(arena, num_pages, sizeof(char*));
     
     // Extract pages
     for (int i = 0; i < num_pages; i++) {
@@ -490,7 +427,7 @@ MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
         struct json_object *img_field;
         
         if (json_object_object_get_ex(page_obj, "img", &img_field)) {
-            pages->page_urls[i] = strdup(json_object_get_string(img_field));
+            pages->page_urls[i] = json_strings_get(&strings, img_field);
         }
         
         // Get the referer header if available (for the first page is enough)
@@ -500,7 +437,7 @@ MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
                 struct json_object *referer;
                 if (json_object_is_type(header_field, json_type_object) && 
                     json_object_object_get_ex(header_field, "Referer", &referer)) {
-                    pages->referer = strdup(json_object_get_string(referer));
+                    pages->referer = json_strings_get(&strings, referer);
                 }
             }
         }
@@ -508,8 +445,6 @@ MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
     
     // Clean up
     json_object_put(json_array);
-    free(chunk.data);
-    curl_global_cleanup();
     
     return pages;
 }
@@ -517,62 +452,26 @@ MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id) {
 void mangadex_free_search_results(SearchResult *results) {
     if (!results) return;
     
-    for (int i = 0; i < results->total_results; i++) {
-        free(results->results[i].id);
-        free(results->results[i].title);
-        free(results->results[i].image);
-    }
-    
-    free(results->results);
-    free(results);
+    // Releases the structure along with every string it points to
+    arena_destroy(results->arena);
 }
 
 void mangadex_free_manga_info(MangadexMangaInfo *info) {
     if (!info) return;
     
-    if (info->id) free(info->id);
-    if (info->title) free(info->title);
-    if (info->url) free(info->url);
-    if (info->image) free(info->image);
-    if (info->description) free(info->description);
-    if (info->release_date) free(info->release_date);
-    if (info->status) free(info->status);
-    
-    if (info->genres) {
-        for (int i = 0; i < info->genres_count; i++) {
-            if (info->genres[i]) free(info->genres[i]);
-        }
-        free(info->genres);
-    }
-    
-    if (info->chapters) {
-        for (int i = 0; i < info->total_chapters; i++) {
-            if (info->chapters[i].id) free(info->chapters[i].id);
-            if (info->chapters[i].title) free(info->chapters[i].title);
-            if (info->chapters[i].releaseDate) free(info->chapters[i].releaseDate);
-        }
-        free(info->chapters);
-    }
-    
-    free(info);
+    // Releases the structure along with every string it points to
+    arena_destroy(info->arena);
 }
 
 void mangadex_free_chapter_pages(MangadexChapterPages *pages) {
     if (!pages) return;
     
-    if (pages->page_urls) {
-        for (int i = 0; i < pages->page_count; i++) {
-            free(pages->page_urls[i]);
-        }
-        free(pages->page_urls);
-    }
-    
-    free(pages->referer);
-    free(pages);
+    // Releases the structure along with every string it points to
+    arena_destroy(pages->arena);
 }
 
 // Provider API function mapping
-static ProviderAPI mangadex_api = {
+static const ProviderAPI mangadex_api = {
     .search = mangadex_search_manga,
     .free_search_results = mangadex_free_search_results,
     .get_anime_info = NULL, // Not supported for manga provider
@@ -581,6 +480,7 @@ static ProviderAPI mangadex_api = {
     .free_stream_info = NULL, // Not supported for manga provider
     // Manga functions
     .get_manga_info = (void* (*)(const char*))mangadex_get_manga_info,
+    .open_manga_info = (void* (*)(const char*))mangadex_open_manga_info,
     .get_chapter_pages = (void* (*)(const char*))mangadex_get_chapter_pages,
     .free_manga_info = (void (*)(void*))mangadex_free_manga_info,
     .free_chapter_info = (void (*)(void*))mangadex_free_chapter_pages
@@ -3,6 +3,8 @@
 
 #include "../api.h"
 
+struct json_object;
+
 // Structure to hold chapter information
 typedef struct {
     char *id;
@@ -24,6 +26,9 @@ typedef struct {
     int genres_count;
     int total_chapters;
     MangadexChapter *chapters;
+    struct LazyList *chapter_list;  // Set by mangadex_open_manga_info while chapters arrive
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Set by the API layer; keeps the layout of MangaInfo
 } MangadexMangaInfo;
 
 // Structure to hold chapter page information
@@ -31,6 +36,9 @@ typedef struct {
     char **page_urls;
     int page_count;
     char *referer;  // HTTP referer for image loading if needed
+    char *base_url; // Unused; keeps the layout identical to ChapterPages
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Set by the API layer; keeps the layout of ChapterPages
 } MangadexChapterPages;
 
 // Get Mangadex provider API
@@ -39,8 +47,13 @@ const ProviderAPI* mangadex_get_api();
 // API implementation functions for Mangadex
 SearchResult* mangadex_search_manga(const char *query);
 MangadexMangaInfo* mangadex_get_manga_info(const char *manga_id);
+MangadexMangaInfo* mangadex_open_manga_info(const char *manga_id);  // Chapters stream in, see manga_info_update
 MangadexChapterPages* mangadex_get_chapter_pages(const char *chapter_id);
 
+// Response conversion, split from the fetch so it can be benchmarked offline
+// (manga_id is the fallback when the response carries no id)
+MangadexMangaInfo* mangadex_parse_manga_info(struct json_object *json, const char *manga_id);
+
 // Cleanup functions
 void mangadex_free_search_results(SearchResult *results);
 void mangadex_free_manga_info(MangadexMangaInfo *info);
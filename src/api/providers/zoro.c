@@ -1,88 +1,40 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <curl/curl.h>
 #include <json-c/json.h>
 #include "zoro.h"
+#include "../http.h"
+#include "../json_view.h"
+#include "../lazy_list.h"
 #include "../../config.h"
 #include "../../utils/memory.h"
 
-#define ZORO_API_BASE_URL "https://consumet.thuanc177.me/anime/zoro"
-
-typedef struct {
-    char *data;
-    size_t size;
-} MemoryStruct;
-
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, MemoryStruct *userp) {
-    size_t realsize = size * nmemb;
-    userp->data = realloc(userp->data, userp->size + realsize + 1);
-    if (userp->data == NULL) {
-        printf("Not enough memory (realloc returned NULL)\n");
-        return 0;
-    }
-    memcpy(&(userp->data[userp->size]), contents, realsize);
-    userp->size += realsize;
-    userp->data[userp->size] = 0;
-    return realsize;
-}
+#define ZORO_DEFAULT_BASE_URL "https://consumet.thuanc177.me/anime/zoro"
+#define ZORO_API_BASE_URL provider_base_url("ZORO_API_BASE_URL", ZORO_DEFAULT_BASE_URL)
 
 SearchResult* zoro_search_anime(const char *query) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
     char url[512];
     char *encoded_query = NULL;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-
     // Properly URL encode the query string
-    encoded_query = curl_easy_escape(curl, query, 0);
+    encoded_query = http_escape(query);
     if (!encoded_query) {
         fprintf(stderr, "Failed to URL-encode query string\n");
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
         return NULL;
     }
     
     // Build URL for anime search endpoint
     snprintf(url, sizeof(url), "%s/%s", ZORO_API_BASE_URL, encoded_query);
+    free(encoded_query);
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-    
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, HTTP_CACHE_TTL_SEARCH, &json_obj)) {
         return NULL;
     }
     
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
     if (!json_obj) {
         fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -91,34 +43,19 @@ SearchResult* zoro_search_anime(const char *query) {
     if (!json_object_object_get_ex(json_obj, "results", &results_array)) {
         fprintf(stderr, "No results field in JSON response\n");
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
-    // Create search result structure
-    SearchResult *search_result = malloc(sizeof(SearchResult));
-    if (!search_result) {
-        fprintf(stderr, "Failed to allocate memory for search results\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    // Create search result structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    SearchResult *search_result = arena_alloc(arena, sizeof(SearchResult));
+    search_result->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
     
     // Get array length
     int num_results = json_object_array_length(results_array);
     search_result->total_results = num_results;
-    search_result->results = malloc(num_results * sizeof(SearchResultItem));
-    
-    if (!search_result->results) {
-        fprintf(stderr, "Failed to allocate memory for anime results\n");
-        free(search_result);
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    search_result->results = arena_calloc(arena, num_results, sizeof(SearchResultItem));
     
     // Extract each result
     for (int i = 0; i < num_results; i++) {
@@ -126,17 +63,17 @@ SearchResult* zoro_search_anime(const char *query) {
         struct json_object *field;
         
         if (json_object_object_get_ex(result_obj, "id", &field))
-            search_result->results[i].id = strdup(json_object_get_string(field));
+            search_result->results[i].id = json_strings_get(&strings, field);
         else
             search_result->results[i].id = NULL;
         
         if (json_object_object_get_ex(result_obj, "title", &field))
-            search_result->results[i].title = strdup(json_object_get_string(field));
+            search_result->results[i].title = json_strings_get(&strings, field);
         else
             search_result->results[i].title = NULL;
         
         if (json_object_object_get_ex(result_obj, "image", &field))
-            search_result->results[i].image = strdup(json_object_get_string(field));
+            search_result->results[i].image = json_strings_get(&strings, field);
         else
             search_result->results[i].image = NULL;
         
@@ -150,9 +87,6 @@ SearchResult* zoro_search_anime(const char *query) {
     
     // Clean up
     json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
-    free(encoded_query);
     
     return search_result;
 }
@@ -160,14 +94,21 @@ SearchResult* zoro_search_anime(const char *query) {
 // Implement the rest of Zoro provider functions here
 // ...
 
+// Servers and categories worth racing, preferred first
+static const char *const zoro_stream_servers[] = { "vidstreaming", "vidcloud", NULL };
+static const char *const zoro_stream_categories[] = { "both", NULL };
+
 // Provider API function mapping
-static ProviderAPI zoro_api = {
+static const ProviderAPI zoro_api = {
     .search = zoro_search_anime,
     .free_search_results = zoro_free_search_results,
     .get_anime_info = (void* (*)(const char*))zoro_get_anime_info,
-    .get_episode_stream = (void* (*)(const char*, const char*))zoro_get_episode_stream,
+    .open_anime_info = (void* (*)(const char*))zoro_open_anime_info,
+    .get_episode_stream = (void* (*)(const char*, const char*, const char*))zoro_get_episode_stream,
     .free_anime_info = (void (*)(void*))zoro_free_anime_info,
     .free_stream_info = (void (*)(void*))zoro_free_stream_info,
+    .stream_servers = zoro_stream_servers,
+    .stream_categories = zoro_stream_categories,
     // Manga functions are not supported
     .get_manga_info = NULL,
     .get_chapter_pages = NULL,
@@ -183,104 +124,70 @@ const ProviderAPI* zoro_get_api() {
 void zoro_free_search_results(SearchResult *results) {
     if (!results) return;
     
-    for (int i = 0; i < results->total_results; i++) {
-        free(results->results[i].id);
-        free(results->results[i].title);
-        free(results->results[i].image);
-    }
-    
-    free(results->results);
-    free(results);
+    // Releases the structure along with every string it points to
+    arena_destroy(results->arena);
 }
 
-ZoroAnimeInfo* zoro_get_anime_info(const char *anime_id) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
-    char url[512];
-    
-    // Build URL for anime info endpoint
-    snprintf(url, sizeof(url), "%s/info?id=%s", ZORO_API_BASE_URL, anime_id);
-    
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return NULL;
-    }
-    
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
-    
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
-    if (!json_obj) {
-        fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+// Convert one element of the episodes array
+static void parse_episode(const JsonStrings *strings, struct json_object *episode_obj, ZoroEpisode *episode) {
+    struct json_object *field;
     
-    // Create anime info structure
-    ZoroAnimeInfo *info = calloc(1, sizeof(ZoroAnimeInfo));
-    if (!info) {
-        fprintf(stderr, "Failed to allocate memory for anime info\n");
-        json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
-        return NULL;
-    }
+    if (json_object_object_get_ex(episode_obj, "id", &field))
+        episode->id = json_strings_get(strings, field);
+        
+    if (json_object_object_get_ex(episode_obj, "number", &field))
+        episode->number = json_object_get_int(field);
+        
+    if (json_object_object_get_ex(episode_obj, "title", &field))
+        episode->title = json_strings_get(strings, field);
+        
+    if (json_object_object_get_ex(episode_obj, "url", &field))
+        episode->url = json_strings_get(strings, field);
+}
+
+ZoroAnimeInfo* zoro_parse_anime_info(struct json_object *json_obj) {
+    // Create anime info structure; it and every string live in one arena
+    Arena *arena = arena_create(0);
+    ZoroAnimeInfo *info = arena_calloc(arena, 1, sizeof(ZoroAnimeInfo));
+    info->arena = arena;
+    JsonStrings strings = json_strings_begin(arena, json_obj);
     
     // Extract anime details
     struct json_object *field;
     if (json_object_object_get_ex(json_obj, "id", &field))
-        info->id = strdup(json_object_get_string(field));
+        info->id = json_strings_get(&strings, field);
     
     if (json_object_object_get_ex(json_obj, "title", &field))
-        info->title = strdup(json_object_get_string(field));
+        info->title = json_strings_get(&strings, field);
         
     if (json_object_object_get_ex(json_obj, "url", &field))
-        info->url = strdup(json_object_get_string(field));
+        info->url = json_strings_get(&strings, field);
         
     if (json_object_object_get_ex(json_obj, "image", &field))
-        info->image = strdup(json_object_get_string(field));
+        info->image = json_strings_get(&strings, field);
         
     if (json_object_object_get_ex(json_obj, "description", &field))
-        info->description = strdup(json_object_get_string(field));
+        info->description = json_strings_get(&strings, field);
         
     if (json_object_object_get_ex(json_obj, "releaseDate", &field))
-        info->release_date = strdup(json_object_get_string(field));
+        info->release_date = json_strings_get(&strings, field);
         
     if (json_object_object_get_ex(json_obj, "status", &field))
-        info->status = strdup(json_object_get_string(field));
+        info->status = json_strings_get(&strings, field);
     
     if (json_object_object_get_ex(json_obj, "type", &field))
-        info->sub_or_dub = strdup(json_object_get_string(field));
+        info->sub_or_dub = json_strings_get(&strings, field);
     
     // Extract genres
     struct json_object *genres_array;
     if (json_object_object_get_ex(json_obj, "genres", &genres_array)) {
         int num_genres = json_object_array_length(genres_array);
         info->genres_count = num_genres;
-        info->genres = calloc(num_genres, sizeof(char*));
+        info->genres = arena_calloc(arena, num_genres, sizeof(char*));
         
         for (int i = 0; i < num_genres; i++) {
             struct json_object *genre_obj = json_object_array_get_idx(genres_array, i);
-            info->genres[i] = strdup(json_object_get_string(genre_obj));
+            info->genres[i] = json_strings_get(&strings, genre_obj);
         }
     }
     
@@ -289,73 +196,133 @@ ZoroAnimeInfo* zoro_get_anime_info(const char *anime_id) {
     if (json_object_object_get_ex(json_obj, "episodes", &episodes_array)) {
         int num_episodes = json_object_array_length(episodes_array);
         info->total_episodes = num_episodes;
-        info->episodes = calloc(num_episodes, sizeof(ZoroEpisode));
+        info->episodes = arena_calloc(arena, num_episodes, sizeof(ZoroEpisode));
         
         for (int i = 0; i < num_episodes; i++) {
             struct json_object *episode_obj = json_object_array_get_idx(episodes_array, i);
-            
-            if (json_object_object_get_ex(episode_obj, "id", &field))
-                info->episodes[i].id = strdup(json_object_get_string(field));
-                
-            if (json_object_object_get_ex(episode_obj, "number", &field))
-                info->episodes[i].number = json_object_get_int(field);
-                
-            if (json_object_object_get_ex(episode_obj, "title", &field))
-                info->episodes[i].title = strdup(json_object_get_string(field));
-                
-            if (json_object_object_get_ex(episode_obj, "url", &field))
-                info->episodes[i].url = strdup(json_object_get_string(field));
+            parse_episode(&strings, episode_obj, &info->episodes[i]);
         }
     }
     
-    // Clean up
-    json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
-    
     return info;
 }
 
-ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *server) {
-    CURL *curl;
-    CURLcode res;
-    MemoryStruct chunk = {NULL, 0};
+ZoroAnimeInfo* zoro_get_anime_info(const char *anime_id) {
     char url[512];
+    
+    // Build URL for anime info endpoint
+    snprintf(url, sizeof(url), "%s/info?id=%s", ZORO_API_BASE_URL, anime_id);
+    
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, HTTP_CACHE_TTL_INFO, &json_obj)) {
+        return NULL;
+    }
+    
+    if (!json_obj) {
+        fprintf(stderr, "Failed to parse JSON response\n");
+        return NULL;
+    }
+    
+    ZoroAnimeInfo *info = zoro_parse_anime_info(json_obj);
+    json_object_put(json_obj);
 
-    snprintf(url, sizeof(url), "%s/watch?episodeId=%s$both&server=%s", 
-             ZORO_API_BASE_URL, episode_id, server ? server : "vidstreaming");
-    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
+    return info;
+}
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "Failed to initialize curl\n");
+// Loader of an info opened with zoro_open_anime_info, owned by its episode list
+typedef struct {
+    LazyList *list;
+    char *anime_id;
+    Arena *arena;            // Episode strings
+    ZoroAnimeInfo *summary;  // The response without its episodes, once complete
+} EpisodeLoad;
+
+// The info endpoint has no pagination, so episodes are taken from the response as it streams
+static const char *const episodes_path[] = { "episodes", NULL };
+
+static bool push_episode(struct json_object *element, int index, void *ctx) {
+    EpisodeLoad *load = ctx;
+    (void)index;
+    JsonStrings strings = json_strings_begin(load->arena, element);
+    ZoroEpisode episode = { 0 };
+    parse_episode(&strings, element, &episode);
+    return lazy_list_push(load->list, &episode);
+}
+
+static void* load_episodes(LazyList *list, void *ctx) {
+    EpisodeLoad *load = ctx;
+    load->list = list;
+    
+    char url[512];
+    snprintf(url, sizeof(url), "%s/info?id=%s", ZORO_API_BASE_URL, load->anime_id);
+    
+    struct json_object *json_obj = NULL;
+    if (!http_get_json_split(url, HTTP_CACHE_TTL_INFO, episodes_path, push_episode, load, &json_obj) ||
+        !json_obj) {
         return NULL;
     }
     
-    // Set up curl options
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-    
-    // Perform the request
-    res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+    load->summary = zoro_parse_anime_info(json_obj);
+    json_object_put(json_obj);
+    return load->summary;
+}
+
+static void release_load(void *ctx) {
+    EpisodeLoad *load = ctx;
+    zoro_free_anime_info(load->summary);
+    arena_destroy(load->arena);
+    free(load->anime_id);
+    free(load);
+}
+
+static void free_episode_list(void *list) {
+    lazy_list_free(list);
+}
+
+ZoroAnimeInfo* zoro_open_anime_info(const char *anime_id) {
+    EpisodeLoad *load = calloc(1, sizeof(EpisodeLoad));
+    if (!load) {
+        fprintf(stderr, "Failed to allocate memory for episode loader\n");
+        return NULL;
+    }
+    load->anime_id = safe_strdup(anime_id);
+    load->arena = arena_create(0);
+    
+    // Details are merged once the response is complete; until then only the ID is known
+    Arena *arena = arena_create(0);
+    ZoroAnimeInfo *info = arena_calloc(arena, 1, sizeof(ZoroAnimeInfo));
+    info->arena = arena;
+    info->id = arena_strdup(arena, anime_id);
+    info->title = info->id;
+    
+    info->episode_list = lazy_list_start(sizeof(ZoroEpisode), provider_type_to_string(PROVIDER_ZORO),
+                                         load_episodes, load, release_load);
+    if (!info->episode_list) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    arena_defer(arena, free_episode_list, info->episode_list);
     
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        free(chunk.data);
-        curl_global_cleanup();
+    return info;
+}
+
+ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *server, const char *category) {
+    char url[512];
+
+    snprintf(url, sizeof(url), "%s/watch?episodeId=%s$%s&server=%s", 
+             ZORO_API_BASE_URL, episode_id, category ? category : "both",
+             server ? server : "vidstreaming");
+    fprintf(stderr, "DEBUG: Requesting URL: %s\n", url);
+
+    // Perform the request, parsing the body as it arrives
+    struct json_object *json_obj = NULL;
+    if (!http_get_json(url, 0, &json_obj)) {
         return NULL;
     }
     
-    // Parse JSON response
-    struct json_object *json_obj = json_tokener_parse(chunk.data);
     if (!json_obj) {
         fprintf(stderr, "Failed to parse JSON response\n");
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -364,8 +331,6 @@ ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *serv
     if (!info) {
         fprintf(stderr, "Failed to allocate memory for stream info\n");
         json_object_put(json_obj);
-        free(chunk.data);
-        curl_global_cleanup();
         return NULL;
     }
     
@@ -422,8 +387,6 @@ ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *serv
     
     // Clean up
     json_object_put(json_obj);
-    free(chunk.data);
-    curl_global_cleanup();
     
     return info;
 }
@@ -431,32 +394,8 @@ ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *serv
 void zoro_free_anime_info(ZoroAnimeInfo *info) {
     if (!info) return;
     
-    free(info->id);
-    free(info->title);
-    free(info->url);
-    free(info->image);
-    free(info->description);
-    free(info->release_date);
-    free(info->status);
-    free(info->sub_or_dub);
-    
-    if (info->genres) {
-        for (int i = 0; i < info->genres_count; i++) {
-            free(info->genres[i]);
-        }
-        free(info->genres);
-    }
-    
-    if (info->episodes) {
-        for (int i = 0; i < info->total_episodes; i++) {
-            free(info->episodes[i].id);
-            free(info->episodes[i].title);
-            free(info->episodes[i].url);
-        }
-        free(info->episodes);
-    }
-    
-    free(info);
+    // Releases the structure along with every string it points to
+    arena_destroy(info->arena);
 }
 
 void zoro_free_stream_info(ZoroStreamInfo *info) {
@@ -3,6 +3,8 @@
 
 #include "../api.h"
 
+struct json_object;
+
 // Structure to hold episode information
 typedef struct {
     char *id;
@@ -23,8 +25,13 @@ typedef struct {
     char **genres;
     int genres_count;
     char *sub_or_dub;
+    int sub_episodes;  // Episodes out subbed, 0 when the provider does not say
+    int dub_episodes;  // Episodes out dubbed, 0 when the provider does not say
     int total_episodes;
     ZoroEpisode *episodes;
+    struct LazyList *episode_list;  // Set by zoro_open_anime_info while episodes arrive
+    struct Arena *arena;  // Owns the structure and everything it points to
+    ProviderType provider;  // Set by the API layer; keeps the layout of AnimeInfo
 } ZoroAnimeInfo;
 
 // Structure to hold streaming source information
@@ -48,6 +55,8 @@ typedef struct {
     int sources_count;
     ZoroSubtitle *subtitles;
     int subtitles_count;
+    ProviderType provider;  // Set by the API layer; keeps the layout of StreamInfo
+    const char *category;   // Set by the API layer, like provider
 } ZoroStreamInfo;
 
 // Get Zoro provider API
@@ -56,7 +65,11 @@ const ProviderAPI* zoro_get_api();
 // API implementation functions for Zoro
 SearchResult* zoro_search_anime(const char *query);
 ZoroAnimeInfo* zoro_get_anime_info(const char *anime_id);
-ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *server);
+ZoroAnimeInfo* zoro_open_anime_info(const char *anime_id);  // Episodes stream in, see anime_info_update
+ZoroStreamInfo* zoro_get_episode_stream(const char *episode_id, const char *server, const char *category);
+
+// Response conversion, split from the fetch so it can be benchmarked offline
+ZoroAnimeInfo* zoro_parse_anime_info(struct json_object *json);
 
 // Cleanup functions
 void zoro_free_search_results(SearchResult *results);
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "stream_prefetch.h"
+#include "http.h"
+#include "metrics.h"
+#include "worker_pool.h"
+#include "stream_race.h"
+#include "../config.h"
+#include "../utils/memory.h"
+
+struct StreamPrefetch {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int refs;
+    bool cancelled;
+    bool complete;
+
+    char *episode_id;
+    ProviderType provider;
+
+    StreamInfo *stream;
+    time_t resolved_at;
+};
+
+static time_t monotonic_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+// Abort the request once the owner has gone away
+static bool stream_prefetch_wait_tick(void *ctx) {
+    StreamPrefetch *prefetch = ctx;
+
+    pthread_mutex_lock(&prefetch->lock);
+    bool cancelled = prefetch->cancelled;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return !cancelled;
+}
+
+static void free_stream(StreamPrefetch *prefetch, StreamInfo *stream) {
+    const ProviderAPI *api = get_provider_api(prefetch->provider);
+    if (stream && api->free_stream_info) {
+        api->free_stream_info(stream);
+    }
+}
+
+static void release_prefetch(StreamPrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    bool last = --prefetch->refs == 0;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    if (!last) return;
+
+    free_stream(prefetch, prefetch->stream);
+    free(prefetch->episode_id);
+    pthread_cond_destroy(&prefetch->changed);
+    pthread_mutex_destroy(&prefetch->lock);
+    free(prefetch);
+}
+
+static void stream_prefetch_task(void *arg) {
+    StreamPrefetch *prefetch = arg;
+    http_set_wait_hook(stream_prefetch_wait_tick, -1, prefetch);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(prefetch->provider));
+    StreamInfo *stream = stream_race_resolve(prefetch->provider, prefetch->episode_id);
+    metrics_call_end(&call);
+
+    // A stream without sources is as good as a failure
+    if (stream && stream->sources_count == 0) {
+        free_stream(prefetch, stream);
+        stream = NULL;
+    }
+
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->stream = stream;
+    prefetch->resolved_at = monotonic_seconds();
+    prefetch->complete = true;
+    pthread_cond_broadcast(&prefetch->changed);
+    pthread_mutex_unlock(&prefetch->lock);
+
+    release_prefetch(prefetch);
+}
+
+StreamPrefetch* stream_prefetch_start(const char *episode_id) {
+    const ProviderAPI *api = get_provider_api(get_current_provider());
+    if (!episode_id || !api || !api->get_episode_stream) {
+        return NULL;
+    }
+
+    StreamPrefetch *prefetch = calloc(1, sizeof(StreamPrefetch));
+    if (!prefetch) {
+        fprintf(stderr, "Failed to allocate memory for stream prefetch\n");
+        return NULL;
+    }
+
+    pthread_mutex_init(&prefetch->lock, NULL);
+    pthread_cond_init(&prefetch->changed, NULL);
+    prefetch->refs = 2; // owner and resolver thread
+    prefetch->episode_id = safe_strdup(episode_id);
+    prefetch->provider = get_current_provider();
+
+    if (!worker_pool_submit(stream_prefetch_task, NULL, prefetch)) {
+        fprintf(stderr, "Failed to start stream prefetch\n");
+        prefetch->refs = 1;
+        release_prefetch(prefetch);
+        return NULL;
+    }
+
+    return prefetch;
+}
+
+bool stream_prefetch_matches(const StreamPrefetch *prefetch, const char *episode_id) {
+    return prefetch && episode_id && strcmp(prefetch->episode_id, episode_id) == 0;
+}
+
+bool stream_prefetch_wait(StreamPrefetch *prefetch, int timeout_ms) {
+    if (!prefetch) return true;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&prefetch->lock);
+    while (!prefetch->complete) {
+        if (pthread_cond_timedwait(&prefetch->changed, &prefetch->lock, &deadline) != 0) {
+            break;
+        }
+    }
+    bool complete = prefetch->complete;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return complete;
+}
+
+bool stream_prefetch_expired(StreamPrefetch *prefetch) {
+    pthread_mutex_lock(&prefetch->lock);
+    bool expired = prefetch->complete &&
+                   monotonic_seconds() - prefetch->resolved_at >= STREAM_PREFETCH_TTL;
+    pthread_mutex_unlock(&prefetch->lock);
+    return expired;
+}
+
+StreamInfo* stream_prefetch_take(StreamPrefetch *prefetch) {
+    if (!prefetch || stream_prefetch_expired(prefetch)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&prefetch->lock);
+    StreamInfo *stream = prefetch->stream;
+    prefetch->stream = NULL;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return stream;
+}
+
+void stream_prefetch_free(StreamPrefetch *prefetch) {
+    if (!prefetch) return;
+
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->cancelled = true;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    release_prefetch(prefetch);
+}
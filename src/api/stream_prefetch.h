@@ -0,0 +1,45 @@
+#ifndef STREAM_PREFETCH_H
+#define STREAM_PREFETCH_H
+
+#include <stdbool.h>
+#include "anime.h"
+
+// Stream links carry short-lived tokens; older results are resolved again
+#define STREAM_PREFETCH_TTL (5 * 60)
+
+// Background resolution of an episode's streaming information
+typedef struct StreamPrefetch StreamPrefetch;
+
+/**
+ * Start resolving an episode's streams on a background thread
+ * The provider active at this point is used, even if it changes later.
+ * @param episode_id Episode to resolve
+ * @return Prefetch handle (release with stream_prefetch_free) or NULL on error
+ */
+StreamPrefetch* stream_prefetch_start(const char *episode_id);
+
+// Check whether the prefetch resolves the given episode
+bool stream_prefetch_matches(const StreamPrefetch *prefetch, const char *episode_id);
+
+/**
+ * Wait for the resolution to finish
+ * @param prefetch The prefetch to wait on
+ * @param timeout_ms Maximum time to wait
+ * @return true once the streams were resolved or the request failed
+ */
+bool stream_prefetch_wait(StreamPrefetch *prefetch, int timeout_ms);
+
+// Check whether a finished result is older than STREAM_PREFETCH_TTL
+bool stream_prefetch_expired(StreamPrefetch *prefetch);
+
+/**
+ * Take the resolved streams out of a finished prefetch
+ * @return Streaming information (free with anime_free_stream_info), or NULL
+ *         if resolution failed, is still running, expired or was already taken
+ */
+StreamInfo* stream_prefetch_take(StreamPrefetch *prefetch);
+
+// Stop the prefetch and release it along with any untaken result
+void stream_prefetch_free(StreamPrefetch *prefetch);
+
+#endif /* STREAM_PREFETCH_H */
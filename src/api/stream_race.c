@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "stream_race.h"
+#include "http.h"
+#include "metrics.h"
+#include "../utils/memory.h"
+
+#define STREAM_RACE_TICK_MS 100
+#define STREAM_RACE_MAX_CANDIDATES 16
+
+// State shared by the caller and the candidate threads
+typedef struct {
+    pthread_mutex_t lock;
+    int refs;
+    bool cancelled;
+    int finished;
+    int pipe_fds[2];
+
+    ProviderType provider;
+    StreamInfo *winner;
+    const char *winner_category;
+} RaceState;
+
+// One server/category pair queried on its own thread
+typedef struct {
+    RaceState *race;
+    char *episode_id;
+    const char *server;
+    const char *category;
+} RaceCandidate;
+
+// Candidate threads still running, so shutdown can wait for the handles they use
+static pthread_mutex_t candidates_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t candidates_done = PTHREAD_COND_INITIALIZER;
+static int live_candidates = 0;
+
+static long long monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static void free_stream(ProviderType provider, StreamInfo *stream) {
+    const ProviderAPI *api = get_provider_api(provider);
+    if (stream && api->free_stream_info) {
+        api->free_stream_info(stream);
+    }
+}
+
+static bool is_playable(const StreamInfo *stream) {
+    return stream && stream->sources && stream->sources_count > 0 && stream->sources[0].url;
+}
+
+static void release_race(RaceState *race) {
+    pthread_mutex_lock(&race->lock);
+    bool last = --race->refs == 0;
+    pthread_mutex_unlock(&race->lock);
+
+    if (!last) return;
+
+    free_stream(race->provider, race->winner);
+    close(race->pipe_fds[0]);
+    close(race->pipe_fds[1]);
+    pthread_mutex_destroy(&race->lock);
+    free(race);
+}
+
+// Losers stop as soon as a winner is known
+static bool candidate_wait_tick(void *ctx) {
+    RaceState *race = ctx;
+
+    pthread_mutex_lock(&race->lock);
+    bool cancelled = race->cancelled;
+    pthread_mutex_unlock(&race->lock);
+
+    return !cancelled;
+}
+
+static void* candidate_thread(void *arg) {
+    RaceCandidate *candidate = arg;
+    RaceState *race = candidate->race;
+    const ProviderAPI *api = get_provider_api(race->provider);
+
+    http_set_wait_hook(candidate_wait_tick, -1, race);
+    MetricsCall call;
+    metrics_call_begin(&call, provider_type_to_string(race->provider));
+    StreamInfo *stream = api->get_episode_stream(candidate->episode_id, candidate->server,
+                                                 candidate->category);
+    metrics_call_end(&call);
+    http_thread_cleanup();
+
+    pthread_mutex_lock(&race->lock);
+    if (!race->cancelled && !race->winner && is_playable(stream)) {
+        race->winner = stream;
+        race->winner_category = candidate->category;
+        stream = NULL;
+    }
+    race->finished++;
+    pthread_mutex_unlock(&race->lock);
+
+    free_stream(race->provider, stream);
+
+    // Wake the caller; if the pipe is full a wake-up is already queued
+    char byte = 1;
+    ssize_t written = write(race->pipe_fds[1], &byte, 1);
+    (void)written;
+
+    release_race(race);
+    free(candidate->episode_id);
+    free(candidate);
+
+    pthread_mutex_lock(&candidates_lock);
+    if (--live_candidates == 0) {
+        pthread_cond_broadcast(&candidates_done);
+    }
+    pthread_mutex_unlock(&candidates_lock);
+    return NULL;
+}
+
+static bool start_candidate(RaceState *race, const char *episode_id,
+                            const char *server, const char *category) {
+    RaceCandidate *candidate = malloc(sizeof(RaceCandidate));
+    if (!candidate) {
+        return false;
+    }
+
+    candidate->race = race;
+    candidate->episode_id = safe_strdup(episode_id);
+    candidate->server = server;
+    candidate->category = category;
+
+    // Count the reference before the thread can drop it
+    pthread_mutex_lock(&race->lock);
+    race->refs++;
+    pthread_mutex_unlock(&race->lock);
+
+    pthread_mutex_lock(&candidates_lock);
+    live_candidates++;
+    pthread_mutex_unlock(&candidates_lock);
+
+    // Not a pool task: the race may itself run on a worker, and a candidate
+    // queued behind busy workers would leave it waiting for nothing
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, candidate_thread, candidate) != 0) {
+        fprintf(stderr, "Failed to start stream resolver thread\n");
+        pthread_mutex_lock(&race->lock);
+        race->refs--;
+        pthread_mutex_unlock(&race->lock);
+        pthread_mutex_lock(&candidates_lock);
+        live_candidates--;
+        pthread_mutex_unlock(&candidates_lock);
+        free(candidate->episode_id);
+        free(candidate);
+        return false;
+    }
+    pthread_detach(thread);
+
+    return true;
+}
+
+StreamInfo* stream_race_resolve(ProviderType provider, const char *episode_id) {
+    const ProviderAPI *api = get_provider_api(provider);
+    if (!episode_id || !api || !api->get_episode_stream) {
+        return NULL;
+    }
+
+    // Nothing to race: a single query with the provider's defaults
+    if (!api->stream_servers || !api->stream_servers[0]) {
+        StreamInfo *stream = api->get_episode_stream(episode_id, NULL, NULL);
+        if (stream) stream->provider = provider;
+        return stream;
+    }
+
+    // Category-major order, so every server of the preferred category goes first
+    const char *servers[STREAM_RACE_MAX_CANDIDATES];
+    const char *categories[STREAM_RACE_MAX_CANDIDATES];
+    int count = 0;
+    const char *const no_categories[] = { NULL };
+    const char *const *category_list = api->stream_categories && api->stream_categories[0]
+                                       ? api->stream_categories : no_categories;
+    int category_count = 1;
+    while (category_list[category_count - 1] && category_list[category_count]) category_count++;
+
+    for (int c = 0; c < category_count && count < STREAM_RACE_MAX_CANDIDATES; c++) {
+        for (int s = 0; api->stream_servers[s] && count < STREAM_RACE_MAX_CANDIDATES; s++) {
+            servers[count] = api->stream_servers[s];
+            categories[count] = category_list[c];
+            count++;
+        }
+    }
+
+    RaceState *race = calloc(1, sizeof(RaceState));
+    if (!race) {
+        fprintf(stderr, "Failed to allocate memory for stream race\n");
+        return NULL;
+    }
+
+    if (pipe(race->pipe_fds) != 0) {
+        fprintf(stderr, "Failed to create stream race pipe\n");
+        free(race);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(race->pipe_fds[i], F_SETFL, O_NONBLOCK);
+        fcntl(race->pipe_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    pthread_mutex_init(&race->lock, NULL);
+    race->refs = 1;
+    race->provider = provider;
+
+    int started = 0;
+    long long next_start = 0;
+    StreamInfo *winner = NULL;
+    const char *category = NULL;
+
+    while (1) {
+        pthread_mutex_lock(&race->lock);
+        winner = race->winner;
+        category = race->winner_category;
+        race->winner = NULL;
+        int finished = race->finished;
+        pthread_mutex_unlock(&race->lock);
+
+        if (winner || finished == count) {
+            break;
+        }
+
+        // Hedge after the delay, or at once when everything so far failed
+        long long now = monotonic_ms();
+        if (started < count && (now >= next_start || finished == started)) {
+            if (!start_candidate(race, episode_id, servers[started], categories[started])) {
+                pthread_mutex_lock(&race->lock);
+                race->finished++;
+                pthread_mutex_unlock(&race->lock);
+            }
+            started++;
+            next_start = now + STREAM_RACE_HEDGE_MS;
+            continue;
+        }
+
+        int timeout = STREAM_RACE_TICK_MS;
+        if (started < count && next_start - now < timeout) {
+            timeout = (int)(next_start - now);
+        }
+        if (!http_wait_fd(race->pipe_fds[0], timeout)) {
+            break; // Aborted by the caller's wait hook
+        }
+
+        char buffer[64];
+        while (read(race->pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+            // Drain wake-ups
+        }
+    }
+
+    // Candidates still running notice this on their next wait tick
+    pthread_mutex_lock(&race->lock);
+    race->cancelled = true;
+    pthread_mutex_unlock(&race->lock);
+    release_race(race);
+
+    if (winner) {
+        winner->provider = provider;
+        winner->category = category;
+    }
+    return winner;
+}
+
+void stream_race_shutdown() {
+    pthread_mutex_lock(&candidates_lock);
+    while (live_candidates > 0) {
+        pthread_cond_wait(&candidates_done, &candidates_lock);
+    }
+    pthread_mutex_unlock(&candidates_lock);
+}
@@ -0,0 +1,28 @@
+#ifndef STREAM_RACE_H
+#define STREAM_RACE_H
+
+#include "anime.h"
+
+// How long a candidate gets before the next one joins the race
+#define STREAM_RACE_HEDGE_MS 750
+
+/**
+ * Resolve an episode's streams by racing the provider's servers
+ * Candidates (every server of every category, preferred first) are started
+ * one hedging delay apart, or right away when the previous ones failed. The
+ * first answer with a playable source wins and the others are cancelled.
+ * The winner's category is recorded in StreamInfo.category, so callers can
+ * tell when the preferred one (e.g. sub) had nothing and another was used.
+ * Each candidate runs on a thread of its own rather than a pool worker, so
+ * a race started from a pool task never waits on work queued behind it.
+ * Providers without a server list are queried once with their defaults.
+ * @param provider Provider to query
+ * @param episode_id Episode to resolve
+ * @return Streaming information (free with the provider's free_stream_info) or NULL
+ */
+StreamInfo* stream_race_resolve(ProviderType provider, const char *episode_id);
+
+// Wait for the cancelled candidates of finished races to stop (before http_cleanup)
+void stream_race_shutdown();
+
+#endif /* STREAM_RACE_H */
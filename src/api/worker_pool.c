@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "worker_pool.h"
+#include "http.h"
+
+typedef struct WorkerJob {
+    struct WorkerJob *queued;            // Submission queue, guarded by queue_lock
+    _Atomic(struct WorkerJob*) next;     // Completion queue
+    WorkerTaskFn run;
+    WorkerDoneFn done;
+    void *ctx;
+} WorkerJob;
+
+static pthread_t workers[WORKER_POOL_SIZE];
+static int worker_count = 0;
+
+// Tasks waiting for a worker, oldest first
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+static WorkerJob *queue_head = NULL;
+static WorkerJob *queue_tail = NULL;
+static bool running = false;
+
+// Finished tasks: an intrusive multi-producer single-consumer queue.
+// Workers push by swapping completed_head, so finishing never takes a lock
+// the UI thread could hold; only the dispatching thread touches
+// completed_tail. The stub keeps the queue non-empty between pushes.
+static WorkerJob stub;
+static _Atomic(WorkerJob*) completed_head = &stub;
+static WorkerJob *completed_tail = &stub;
+static int wake_fds[2] = { -1, -1 };
+
+static void push_completed(WorkerJob *job) {
+    atomic_store_explicit(&job->next, NULL, memory_order_relaxed);
+    WorkerJob *prev = atomic_exchange_explicit(&completed_head, job, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, job, memory_order_release);
+}
+
+// Take the oldest finished task; NULL when empty or a push is half done
+// (the pusher's wake-up byte follows, so the caller looks again later)
+static WorkerJob* pop_completed() {
+    WorkerJob *tail = completed_tail;
+    WorkerJob *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &stub) {
+        if (!next) return NULL;
+        completed_tail = tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next) {
+        completed_tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load_explicit(&completed_head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    // tail is the last job: put the stub behind it so it can be handed out
+    push_completed(&stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        completed_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static void* worker_thread(void *arg) {
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&queue_lock);
+        while (!queue_head && running) {
+            pthread_cond_wait(&queue_ready, &queue_lock);
+        }
+        WorkerJob *job = queue_head;
+        if (!job) {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        queue_head = job->queued;
+        if (!queue_head) queue_tail = NULL;
+        pthread_mutex_unlock(&queue_lock);
+
+        job->run(job->ctx);
+
+        // The next task starts without the previous one's hook, token or priority
+        http_set_wait_hook(NULL, -1, NULL);
+        http_set_cancel_token(NULL);
+        http_set_background(false);
+
+        if (!job->done) {
+            free(job);
+            continue;
+        }
+
+        push_completed(job);
+
+        // If the pipe is full a wake-up is already queued
+        char byte = 1;
+        ssize_t written = write(wake_fds[1], &byte, 1);
+        (void)written;
+    }
+
+    http_thread_cleanup();
+    return NULL;
+}
+
+bool worker_pool_init(int threads) {
+    if (running) return true;
+    if (threads <= 0 || threads > WORKER_POOL_SIZE) threads = WORKER_POOL_SIZE;
+
+    if (pipe(wake_fds) != 0) {
+        fprintf(stderr, "Failed to create worker pool pipe\n");
+        wake_fds[0] = wake_fds[1] = -1;
+        return false;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(wake_fds[i], F_SETFL, O_NONBLOCK);
+        fcntl(wake_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    running = true;
+    for (worker_count = 0; worker_count < threads; worker_count++) {
+        if (pthread_create(&workers[worker_count], NULL, worker_thread, NULL) != 0) {
+            fprintf(stderr, "Failed to start worker thread %d\n", worker_count);
+            break;
+        }
+    }
+
+    if (worker_count == 0) {
+        running = false;
+        close(wake_fds[0]);
+        close(wake_fds[1]);
+        wake_fds[0] = wake_fds[1] = -1;
+        return false;
+    }
+    return true;
+}
+
+void worker_pool_shutdown() {
+    pthread_mutex_lock(&queue_lock);
+    bool was_running = running;
+    running = false;
+    pthread_cond_broadcast(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+
+    if (!was_running) return;
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    worker_count = 0;
+
+    worker_pool_dispatch();
+    close(wake_fds[0]);
+    close(wake_fds[1]);
+    wake_fds[0] = wake_fds[1] = -1;
+}
+
+bool worker_pool_submit(WorkerTaskFn run, WorkerDoneFn done, void *ctx) {
+    if (!run) return false;
+
+    WorkerJob *job = malloc(sizeof(WorkerJob));
+    if (!job) {
+        fprintf(stderr, "Failed to allocate memory for worker task\n");
+        return false;
+    }
+    job->queued = NULL;
+    job->run = run;
+    job->done = done;
+    job->ctx = ctx;
+
+    pthread_mutex_lock(&queue_lock);
+    if (!running) {
+        pthread_mutex_unlock(&queue_lock);
+        free(job);
+        return false;
+    }
+    if (queue_tail) {
+        queue_tail->queued = job;
+    } else {
+        queue_head = job;
+    }
+    queue_tail = job;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+    return true;
+}
+
+int worker_pool_fd() {
+    return wake_fds[0];
+}
+
+int worker_pool_dispatch() {
+    if (wake_fds[0] < 0) return 0;
+
+    // Drain the wake-ups first: a push finishing after this leaves a new byte
+    char buffer[64];
+    while (read(wake_fds[0], buffer, sizeof(buffer)) > 0) {
+    }
+
+    int dispatched = 0;
+    WorkerJob *job;
+    while ((job = pop_completed()) != NULL) {
+        job->done(job->ctx);
+        free(job);
+        dispatched++;
+    }
+    return dispatched;
+}
@@ -0,0 +1,50 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdbool.h>
+
+// Fixed set of threads running provider calls, parses and downloads
+// Tasks run in submission order on whichever worker is free. A task must
+// never wait for another pool task: long tasks such as downloads can hold
+// every worker, and the task waited for would stay queued behind them.
+// Work a task has to wait for runs on its own thread (see stream_race).
+#define WORKER_POOL_SIZE 8
+
+// Work run on a pool thread; requests it starts share the thread's handles
+typedef void (*WorkerTaskFn)(void *ctx);
+
+// Completion run on the thread that calls worker_pool_dispatch
+typedef void (*WorkerDoneFn)(void *ctx);
+
+/**
+ * Start the pool threads
+ * @param threads Number of workers (WORKER_POOL_SIZE when not positive)
+ * @return true when at least one worker started
+ */
+bool worker_pool_init(int threads);
+
+// Run the queued tasks to the end, stop the workers and dispatch the last completions
+void worker_pool_shutdown();
+
+/**
+ * Queue a task
+ * The worker's wait hook, cancellation token and background flag are
+ * cleared after the task, so a task sets up its own (see http_set_cancel_token).
+ * @param run Work to do on a pool thread
+ * @param done Completion for the dispatching thread (NULL for none)
+ * @param ctx Passed to both
+ * @return false when the pool is not running (neither function is called)
+ */
+bool worker_pool_submit(WorkerTaskFn run, WorkerDoneFn done, void *ctx);
+
+// Descriptor that becomes readable when completions are waiting (-1 if not running)
+int worker_pool_fd();
+
+/**
+ * Run the completions of finished tasks on the calling thread
+ * Only one thread, the UI thread, dispatches.
+ * @return Number of completions run
+ */
+int worker_pool_dispatch();
+
+#endif /* WORKER_POOL_H */
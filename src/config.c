@@ -3,14 +3,15 @@
 #include <string.h>
 #include "config.h"
 #include "utils/memory.h"
+#include "utils/fs.h"
 
 #define CONFIG_FILE_PATH "anime-cli.conf"
 
 // Global configuration instance
 Config app_config;
 
-// Currently active provider
-static ProviderType current_provider;
+// Currently active provider; pool workers read it while the UI thread may change it
+static _Atomic ProviderType current_provider;
 
 void config_init() {
     // Set default configuration
@@ -19,12 +20,19 @@ void config_init() {
     app_config.mpv_additional_args = safe_strdup("--force-window=immediate --cache=yes");
     app_config.download_directory = safe_strdup("./downloads");
     app_config.cache_enabled = true;
+    app_config.zero_copy_strings = false;
+    app_config.metrics_enabled = false;
     
     // Set initial provider to default
     current_provider = app_config.default_provider;
     
     // Try to load from config file
     config_load();
+    
+    const char *metrics = getenv("ANIME_CLI_METRICS");
+    if (metrics && *metrics && strcmp(metrics, "0") != 0) {
+        app_config.metrics_enabled = true;
+    }
 }
 
 bool config_save() {
@@ -38,6 +46,8 @@ bool config_save() {
     fprintf(config_file, "mpv_additional_args=%s\n", app_config.mpv_additional_args);
     fprintf(config_file, "download_directory=%s\n", app_config.download_directory);
     fprintf(config_file, "cache_enabled=%d\n", app_config.cache_enabled);
+    fprintf(config_file, "zero_copy_strings=%d\n", app_config.zero_copy_strings);
+    fprintf(config_file, "metrics_enabled=%d\n", app_config.metrics_enabled);
     
     fclose(config_file);
     return true;
@@ -71,6 +81,18 @@ bool config_load() {
             continue;
         }
         
+        int zero_copy_value;
+        if (sscanf(line, "zero_copy_strings=%d", &zero_copy_value) == 1) {
+            app_config.zero_copy_strings = (zero_copy_value != 0);
+            continue;
+        }
+        
+        int metrics_value;
+        if (sscanf(line, "metrics_enabled=%d", &metrics_value) == 1) {
+            app_config.metrics_enabled = (metrics_value != 0);
+            continue;
+        }
+        
         if (sscanf(line, "mpv_additional_args=%[^\n]", value) == 1) {
             free(app_config.mpv_additional_args);
             app_config.mpv_additional_args = safe_strdup(value);
@@ -94,6 +116,27 @@ void config_cleanup() {
     free(app_config.download_directory);
 }
 
+bool config_state_path(const char *name, char *path, size_t size) {
+    const char *xdg = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    char dir[1024];
+    
+    if (xdg && *xdg) {
+        snprintf(dir, sizeof(dir), "%s/anime-cli", xdg);
+    } else if (home && *home) {
+        snprintf(dir, sizeof(dir), "%s/.local/state/anime-cli", home);
+    } else {
+        return false;
+    }
+    
+    if (!make_dirs(dir)) {
+        fprintf(stderr, "Failed to create state directory %s\n", dir);
+        return false;
+    }
+    
+    return snprintf(path, size, "%s/%s", dir, name) < (int)size;
+}
+
 ProviderType get_current_provider() {
     return current_provider;
 }
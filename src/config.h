@@ -10,6 +10,8 @@ typedef struct {
     char *mpv_additional_args;
     char *download_directory;
     bool cache_enabled;
+    bool zero_copy_strings;  // Point parsed strings into the response instead of copying (keeps the whole response alive)
+    bool metrics_enabled;    // Write the session's network metrics on exit (also ANIME_CLI_METRICS=1)
 } Config;
 
 // Global configuration
@@ -27,6 +29,17 @@ bool config_load();
 // Free configuration resources
 void config_cleanup();
 
+/**
+ * Path of a file kept between runs, such as the log
+ * Files live in $XDG_STATE_HOME/anime-cli (or ~/.local/state/anime-cli),
+ * which is created on first use.
+ * @param name File name
+ * @param path Buffer receiving the path
+ * @param size Size of the buffer
+ * @return false if no state directory is available
+ */
+bool config_state_path(const char *name, char *path, size_t size);
+
 // Get currently active provider
 ProviderType get_current_provider();
 
@@ -8,6 +8,9 @@
 #include "api/api.h"
 #include "api/anime.h"
 #include "api/manga.h"
+#include "api/metrics.h"
+
+#define METRICS_FILE_NAME "metrics.json"
 
 int main(int argc, char *argv[]) {
     (void)argc;  // Suppress unused parameter warning
@@ -27,6 +30,11 @@ int main(int argc, char *argv[]) {
             break;
         }
         
+        if (content_option == CONTENT_SELECTION_STATS) {
+            ui_stats_screen();
+            continue;
+        }
+        
         // Select provider for the chosen content type
         ProviderSelectionResult provider_result;
         
@@ -34,7 +42,7 @@ int main(int argc, char *argv[]) {
             provider_result = ui_provider_selection(CONTENT_ANIME);
             if (!provider_result.canceled) {
                 set_current_provider(provider_result.selected_provider);
-                anime_ui_main_loop();
+                anime_ui_main_loop(provider_result.federated);
             }
         } else if (content_option == CONTENT_SELECTION_MANGA) {
             provider_result = ui_provider_selection(CONTENT_MANGA);
@@ -47,6 +55,14 @@ int main(int argc, char *argv[]) {
     
     // Clean up systems
     ui_cleanup();
+    
+    // Keep the session's timings for offline comparison when asked to
+    char metrics_path[1100];
+    if (app_config.metrics_enabled &&
+        config_state_path(METRICS_FILE_NAME, metrics_path, sizeof(metrics_path)) &&
+        metrics_dump_json(metrics_path)) {
+        printf("Network metrics written to %s\n", metrics_path);
+    }
     api_cleanup();
     config_cleanup();
     
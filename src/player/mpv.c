@@ -0,0 +1,466 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <json-c/json.h>
+#include "mpv.h"
+#include "../utils/memory.h"
+
+#define MPV_MAX_ARGS 64
+#define MPV_CONNECT_ATTEMPTS 100
+#define MPV_CONNECT_DELAY_MS 50
+#define MPV_READ_BUFFER 65536
+#define MPV_QUIT_WAIT_MS 1000
+#define MPV_SOCKET_NAME "mpv.sock"
+
+// Property observer ids
+#define MPV_OBSERVE_POSITION 1
+#define MPV_OBSERVE_DURATION 2
+
+struct MpvPlayer {
+    pid_t pid;
+    int fd;
+    char socket_dir[96];     // Private directory (mode 0700) holding the socket
+    char socket_path[108];
+    bool running;
+    bool reaped;
+
+    // Partial line received from the socket
+    char *buffer;
+    size_t buffered;
+
+    double position;
+    double duration;
+
+    // Subtitles to add once the loading file is ready
+    char **pending_subs;
+    bool *pending_select;
+    int pending_count;
+};
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void clear_pending_subs(MpvPlayer *player) {
+    for (int i = 0; i < player->pending_count; i++) {
+        free(player->pending_subs[i]);
+    }
+    free(player->pending_subs);
+    free(player->pending_select);
+    player->pending_subs = NULL;
+    player->pending_select = NULL;
+    player->pending_count = 0;
+}
+
+// Send {"command": [...]} as one line; takes ownership of the array
+static bool send_json_command(MpvPlayer *player, struct json_object *command) {
+    if (!player || !player->running) {
+        json_object_put(command);
+        return false;
+    }
+
+    struct json_object *message = json_object_new_object();
+    json_object_object_add(message, "command", command);
+
+    const char *text = json_object_to_json_string_ext(message, JSON_C_TO_STRING_PLAIN);
+    size_t len = strlen(text);
+    char *line = safe_malloc(len + 2);
+    memcpy(line, text, len);
+    line[len++] = '\n';
+    line[len] = '\0';
+    json_object_put(message);
+
+    // The player may have gone away; never let that raise SIGPIPE
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(player->fd, line + sent, len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            sleep_ms(1);
+            continue;
+        }
+        if (n <= 0) break;
+        sent += n;
+    }
+
+    free(line);
+    return sent == len;
+}
+
+static bool send_command(MpvPlayer *player, const char **args, int count) {
+    struct json_object *command = json_object_new_array();
+    for (int i = 0; i < count; i++) {
+        json_object_array_add(command, json_object_new_string(args[i]));
+    }
+    return send_json_command(player, command);
+}
+
+// Observer ids must be sent as numbers
+static bool observe_property(MpvPlayer *player, int id, const char *name) {
+    struct json_object *command = json_object_new_array();
+    json_object_array_add(command, json_object_new_string("observe_property"));
+    json_object_array_add(command, json_object_new_int(id));
+    json_object_array_add(command, json_object_new_string(name));
+    return send_json_command(player, command);
+}
+
+static bool set_property(MpvPlayer *player, const char *name, const char *value) {
+    const char *args[] = { "set_property", name, value };
+    return send_command(player, args, 3);
+}
+
+static bool connect_socket(MpvPlayer *player) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", player->socket_path);
+
+    // mpv creates the socket shortly after starting
+    for (int attempt = 0; attempt < MPV_CONNECT_ATTEMPTS; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            player->fd = fd;
+            return true;
+        }
+        close(fd);
+
+        if (waitpid(player->pid, NULL, WNOHANG) == player->pid) {
+            player->reaped = true;
+            return false;
+        }
+        sleep_ms(MPV_CONNECT_DELAY_MS);
+    }
+
+    return false;
+}
+
+// Put the IPC socket in a fresh directory only we can enter, under
+// $XDG_RUNTIME_DIR when set, so no other user can take its path first
+static bool make_socket_dir(MpvPlayer *player) {
+    const char *bases[] = { getenv("XDG_RUNTIME_DIR"), "/tmp" };
+
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        if (!bases[i] || bases[i][0] != '/') continue;
+
+        int len = snprintf(player->socket_dir, sizeof(player->socket_dir),
+                           "%s/anime-cli-mpv-XXXXXX", bases[i]);
+        if (len < 0 || (size_t)len >= sizeof(player->socket_dir)) continue;
+
+        if (mkdtemp(player->socket_dir)) {
+            snprintf(player->socket_path, sizeof(player->socket_path), "%s/%s",
+                     player->socket_dir, MPV_SOCKET_NAME);
+            return true;
+        }
+    }
+
+    player->socket_dir[0] = '\0';
+    return false;
+}
+
+static void remove_socket_dir(MpvPlayer *player) {
+    if (!player->socket_dir[0]) return;
+
+    unlink(player->socket_path);
+    rmdir(player->socket_dir);
+}
+
+MpvPlayer* mpv_player_start(const char *extra_args) {
+    MpvPlayer *player = calloc(1, sizeof(MpvPlayer));
+    if (!player) {
+        fprintf(stderr, "Failed to allocate memory for player\n");
+        return NULL;
+    }
+
+    player->fd = -1;
+    player->position = -1;
+    player->duration = -1;
+    if (!make_socket_dir(player)) {
+        fprintf(stderr, "Failed to create mpv IPC directory: %s\n", strerror(errno));
+        free(player);
+        return NULL;
+    }
+    player->buffer = safe_malloc(MPV_READ_BUFFER);
+
+    char ipc_arg[160];
+    snprintf(ipc_arg, sizeof(ipc_arg), "--input-ipc-server=%s", player->socket_path);
+
+    // Idle with a window so later episodes reuse the same process
+    char *argv[MPV_MAX_ARGS];
+    int argc = 0;
+    argv[argc++] = "mpv";
+    argv[argc++] = "--idle=yes";
+    argv[argc++] = "--force-window=yes";
+    argv[argc++] = "--no-terminal";
+    argv[argc++] = "--cache=yes";
+    argv[argc++] = "--demuxer-max-bytes=150M";
+    argv[argc++] = "--sub-visibility=yes";
+    argv[argc++] = ipc_arg;
+
+    char *extra = extra_args ? safe_strdup(extra_args) : NULL;
+    char *saveptr = NULL;
+    for (char *tok = extra ? strtok_r(extra, " \t", &saveptr) : NULL;
+         tok && argc < MPV_MAX_ARGS - 1;
+         tok = strtok_r(NULL, " \t", &saveptr)) {
+        argv[argc++] = tok;
+    }
+    argv[argc] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Keep mpv away from the ncurses terminal
+        int devnull = open("/dev/null", O_RDWR);
+        if (devnull >= 0) {
+            dup2(devnull, STDIN_FILENO);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            if (devnull > STDERR_FILENO) close(devnull);
+        }
+        setsid();
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    free(extra);
+
+    if (pid < 0) {
+        fprintf(stderr, "Failed to start mpv: %s\n", strerror(errno));
+        remove_socket_dir(player);
+        free(player->buffer);
+        free(player);
+        return NULL;
+    }
+
+    player->pid = pid;
+    player->running = true;
+
+    if (!connect_socket(player)) {
+        fprintf(stderr, "Failed to connect to mpv IPC socket %s\n", player->socket_path);
+        mpv_player_quit(player);
+        return NULL;
+    }
+
+    observe_property(player, MPV_OBSERVE_POSITION, "time-pos");
+    observe_property(player, MPV_OBSERVE_DURATION, "duration");
+
+    return player;
+}
+
+// Thumbnail tracks are listed as subtitles but are not meant for display
+static bool is_usable_subtitle(const Subtitle *subtitle) {
+    return subtitle->url && subtitle->lang && strstr(subtitle->url, "thumbnails") == NULL;
+}
+
+bool mpv_player_load(MpvPlayer *player, const StreamInfo *stream) {
+    if (!player || !stream || !stream->sources || stream->sources_count == 0) {
+        return false;
+    }
+
+    // Headers apply to every request the next file makes
+    char header[1024] = "";
+    if (stream->referer) {
+        snprintf(header, sizeof(header), "Referer: %s", stream->referer);
+    }
+    set_property(player, "http-header-fields", header);
+    if (stream->user_agent) {
+        set_property(player, "user-agent", stream->user_agent);
+    }
+
+    // Subtitles can only be attached once the file is open
+    clear_pending_subs(player);
+    if (stream->subtitles_count > 0) {
+        player->pending_subs = calloc(stream->subtitles_count, sizeof(char*));
+        player->pending_select = calloc(stream->subtitles_count, sizeof(bool));
+    }
+
+    bool selected = false;
+    for (int i = 0; player->pending_subs && player->pending_select && i < stream->subtitles_count; i++) {
+        if (!is_usable_subtitle(&stream->subtitles[i])) continue;
+
+        int n = player->pending_count++;
+        player->pending_subs[n] = safe_strdup(stream->subtitles[i].url);
+        if (!selected && strstr(stream->subtitles[i].lang, "English") != NULL) {
+            player->pending_select[n] = true;
+            selected = true;
+        }
+    }
+
+    player->position = -1;
+    player->duration = -1;
+
+    const char *args[] = { "loadfile", stream->sources[0].url, "replace" };
+    return send_command(player, args, 3);
+}
+
+bool mpv_player_set_pause(MpvPlayer *player, bool paused) {
+    return set_property(player, "pause", paused ? "yes" : "no");
+}
+
+bool mpv_player_stop(MpvPlayer *player) {
+    clear_pending_subs(player);
+    const char *args[] = { "stop" };
+    return send_command(player, args, 1);
+}
+
+int mpv_player_fd(const MpvPlayer *player) {
+    return player && player->running ? player->fd : -1;
+}
+
+static void add_pending_subs(MpvPlayer *player) {
+    for (int i = 0; i < player->pending_count; i++) {
+        const char *args[] = { "sub-add", player->pending_subs[i],
+                               player->pending_select[i] ? "select" : "auto" };
+        send_command(player, args, 3);
+    }
+    clear_pending_subs(player);
+}
+
+// Translate one IPC message into an event
+static MpvEvent handle_message(MpvPlayer *player, const char *line) {
+    struct json_object *message = json_tokener_parse(line);
+    if (!message) return MPV_EVENT_NONE;
+
+    MpvEvent result = MPV_EVENT_NONE;
+    struct json_object *field;
+
+    if (json_object_object_get_ex(message, "event", &field)) {
+        const char *event = json_object_get_string(field);
+
+        if (strcmp(event, "file-loaded") == 0) {
+            add_pending_subs(player);
+            result = MPV_EVENT_FILE_LOADED;
+        } else if (strcmp(event, "end-file") == 0) {
+            // Replacing the file ends the old one with reason "stop"
+            struct json_object *reason;
+            if (json_object_object_get_ex(message, "reason", &reason) &&
+                strcmp(json_object_get_string(reason), "eof") == 0) {
+                result = MPV_EVENT_END_OF_FILE;
+            }
+        } else if (strcmp(event, "property-change") == 0) {
+            struct json_object *id, *data;
+            double value = -1;
+            if (json_object_object_get_ex(message, "data", &data) &&
+                !json_object_is_type(data, json_type_null)) {
+                value = json_object_get_double(data);
+            }
+
+            if (json_object_object_get_ex(message, "id", &id)) {
+                int observer = json_object_get_int(id);
+                if (observer == MPV_OBSERVE_POSITION) {
+                    player->position = value;
+                    result = MPV_EVENT_PROGRESS;
+                } else if (observer == MPV_OBSERVE_DURATION) {
+                    player->duration = value;
+                    result = MPV_EVENT_PROGRESS;
+                }
+            }
+        } else if (strcmp(event, "shutdown") == 0) {
+            result = MPV_EVENT_SHUTDOWN;
+        }
+    }
+
+    json_object_put(message);
+    return result;
+}
+
+static MpvEvent handle_shutdown(MpvPlayer *player) {
+    if (player->running) {
+        player->running = false;
+        close(player->fd);
+        player->fd = -1;
+        player->reaped = waitpid(player->pid, NULL, WNOHANG) == player->pid;
+    }
+    return MPV_EVENT_SHUTDOWN;
+}
+
+MpvEvent mpv_player_next_event(MpvPlayer *player) {
+    if (!player || !player->running) {
+        return MPV_EVENT_NONE;
+    }
+
+    while (1) {
+        // Complete lines already buffered come first
+        char *newline;
+        while ((newline = memchr(player->buffer, '\n', player->buffered))) {
+            *newline = '\0';
+            MpvEvent event = handle_message(player, player->buffer);
+
+            size_t consumed = newline - player->buffer + 1;
+            memmove(player->buffer, newline + 1, player->buffered - consumed);
+            player->buffered -= consumed;
+
+            if (event == MPV_EVENT_SHUTDOWN) {
+                return handle_shutdown(player);
+            }
+            if (event != MPV_EVENT_NONE) {
+                return event;
+            }
+        }
+
+        // Drop a runaway line rather than overflowing the buffer
+        if (player->buffered == MPV_READ_BUFFER) {
+            player->buffered = 0;
+        }
+
+        ssize_t n = recv(player->fd, player->buffer + player->buffered,
+                         MPV_READ_BUFFER - player->buffered, 0);
+        if (n > 0) {
+            player->buffered += n;
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            return handle_shutdown(player);
+        } else if (errno == EAGAIN) {
+            return MPV_EVENT_NONE;
+        }
+    }
+}
+
+double mpv_player_position(const MpvPlayer *player) {
+    return player ? player->position : -1;
+}
+
+double mpv_player_duration(const MpvPlayer *player) {
+    return player ? player->duration : -1;
+}
+
+bool mpv_player_running(const MpvPlayer *player) {
+    return player && player->running;
+}
+
+void mpv_player_quit(MpvPlayer *player) {
+    if (!player) return;
+
+    if (player->running && player->fd >= 0) {
+        const char *args[] = { "quit" };
+        send_command(player, args, 1);
+        close(player->fd);
+    }
+
+    if (!player->reaped) {
+        // Give mpv a moment to exit on its own before forcing it
+        int waited = 0;
+        while (waitpid(player->pid, NULL, WNOHANG) == 0) {
+            if (waited >= MPV_QUIT_WAIT_MS) {
+                kill(player->pid, SIGTERM);
+                waitpid(player->pid, NULL, 0);
+                break;
+            }
+            sleep_ms(MPV_CONNECT_DELAY_MS);
+            waited += MPV_CONNECT_DELAY_MS;
+        }
+    }
+
+    remove_socket_dir(player);
+    clear_pending_subs(player);
+    free(player->buffer);
+    free(player);
+}
@@ -0,0 +1,60 @@
+#ifndef MPV_H
+#define MPV_H
+
+#include <stdbool.h>
+#include "../api/anime.h"
+
+// mpv process controlled over its JSON IPC socket
+typedef struct MpvPlayer MpvPlayer;
+
+// Events reported by the player
+typedef enum {
+    MPV_EVENT_NONE,         // Nothing left to report
+    MPV_EVENT_FILE_LOADED,  // A file started playing
+    MPV_EVENT_END_OF_FILE,  // The current file played to its end
+    MPV_EVENT_PROGRESS,     // Position or duration changed
+    MPV_EVENT_SHUTDOWN      // The player exited (e.g. window closed)
+} MpvEvent;
+
+/**
+ * Spawn an idle mpv instance and connect to its IPC socket
+ * The process outlives individual episodes; files are switched with loadfile.
+ * @param extra_args Additional space-separated mpv options, or NULL
+ * @return Player handle (release with mpv_player_quit) or NULL on error
+ */
+MpvPlayer* mpv_player_start(const char *extra_args);
+
+/**
+ * Play a stream, replacing whatever is playing
+ * Headers are applied before the load; subtitles are added with sub-add
+ * once the file is loaded, English selected by default.
+ * @return false if the command could not be sent
+ */
+bool mpv_player_load(MpvPlayer *player, const StreamInfo *stream);
+
+// Pause or resume playback
+bool mpv_player_set_pause(MpvPlayer *player, bool paused);
+
+// Stop playback and leave the window idle
+bool mpv_player_stop(MpvPlayer *player);
+
+// Socket to poll; readable whenever mpv_player_next_event has work to do
+int mpv_player_fd(const MpvPlayer *player);
+
+/**
+ * Read pending IPC messages without blocking
+ * Call repeatedly until it returns MPV_EVENT_NONE.
+ */
+MpvEvent mpv_player_next_event(MpvPlayer *player);
+
+// Playback position and duration of the current file in seconds (-1 if unknown)
+double mpv_player_position(const MpvPlayer *player);
+double mpv_player_duration(const MpvPlayer *player);
+
+// Check whether the mpv process is still alive
+bool mpv_player_running(const MpvPlayer *player);
+
+// Close mpv and release the handle
+void mpv_player_quit(MpvPlayer *player);
+
+#endif /* MPV_H */
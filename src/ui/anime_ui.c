@@ -5,14 +5,27 @@
 #include "anime_ui.h"
 #include "common/input.h"
 #include "common/display.h"
+#include "common/filter.h"
+#include "common/list_view.h"
+#include "common/preview.h"
 #include "../api/providers/aniwatch.h"
 #include "../api/providers/zoro.h"
 #include "../api/anime.h"
+#include "../api/federated.h"
+#include "../api/info_prefetch.h"
+#include "../api/metrics.h"
+#include "../api/worker_pool.h"
+#include "../api/stream_prefetch.h"
+#include "../api/episode_download.h"
+#include "../player/mpv.h"
 #include "../config.h"
 
 #define MAX_QUERY_LENGTH 256
 #define ENTER_KEY 10
 #define ESC_KEY 27
+#define BACKSPACE_KEY 127
+#define STREAM_WAIT_TICK_MS 100
+#define DOWNLOAD_REFRESH_MS 500
 
 char* anime_ui_get_search_query() {
     clear();
@@ -24,8 +37,35 @@ char* anime_ui_get_search_query() {
     return ui_get_text_input(MAX_QUERY_LENGTH);
 }
 
-void* anime_ui_select_anime(SearchResult *results) {
-    if (!results || results->total_results <= 0) {
+// List the providers that returned a federated result, e.g. " [AniWatch, Zoro]"
+static const char* format_sources(unsigned sources, char *buffer, size_t size) {
+    size_t len = snprintf(buffer, size, " [");
+    for (int p = 0; p < PROVIDER_COUNT && len < size; p++) {
+        if (sources & (1u << p)) {
+            len += snprintf(buffer + len, size - len, len > 2 ? ", %s" : "%s", provider_type_to_string(p));
+        }
+    }
+    if (len < size) {
+        snprintf(buffer + len, size - len, "]");
+    }
+    return buffer;
+}
+
+// Selection list shared by single-provider and federated searches
+// Provider calls in the shape ui_run_loading runs them
+static void* load_search(const char *query) { return anime_search(query); }
+static void release_search(void *results) { anime_free_search_results(results); }
+static void* load_info(const char *id) { return anime_open_info(id); }
+static void release_info(void *info) { anime_free_info(info); }
+static void* fetch_info(ProviderType provider, const char *id) { return anime_get_info_from(provider, id); }
+static void* load_stream(const char *episode_id) { return anime_get_episode_stream(episode_id, NULL); }
+static void release_stream(void *stream) { anime_free_stream_info(stream); }
+
+static void* select_anime(SearchResult *results, FederatedSearch *search) {
+    if (search) {
+        federated_search_update(search);
+        results = (SearchResult*)federated_search_results(search);
+    } else if (!results || results->total_results <= 0) {
         ui_show_error("No results found.");
         return NULL;
     }
@@ -34,87 +74,136 @@ void* anime_ui_select_anime(SearchResult *results) {
     int scroll_offset = 0;
     int max_display = LINES - 5;
     int c;
-    char filter[MAX_QUERY_LENGTH] = "";
-    int filter_pos = 0;
-    bool filtering = false;
+    TitleFilter *filter = title_filter_new();
+    ListView *view = list_view_new();
+    
+    // Results the highlight rests on are fetched whole, for the preview and a quick ENTER
+    InfoPrefetch *prefetch = info_prefetch_new(INFO_PREFETCH_CAPACITY, fetch_info, release_info);
+    int hovered = -1;
+    double hovered_since = 0;
+    bool hover_requested = false;
     
     while (1) {
-        clear();
+        int pending = search ? federated_search_pending(search) : 0;
+        if (search && pending == 0 && results->total_results == 0) {
+            ui_show_error("No results found.");
+            break;
+        }
+        
+        // Rows are positions in the filtered list, not result indices
+        title_filter_sync(filter, results);
+        int rows = title_filter_count(filter);
+        
+        int index = choice < rows ? title_filter_item(filter, choice) : -1;
+        if (index != hovered) {
+            hovered = index;
+            hovered_since = metrics_now_ms();
+            hover_requested = false;
+        }
+        ProviderType provider = search && hovered >= 0 ? federated_search_provider(search, hovered) : results->provider;
+        const char *hovered_id = hovered >= 0 ? results->results[hovered].id : NULL;
+        
+        // Fetch once the highlight stayed put for PREVIEW_DWELL_MS
+        int timeout = -1;
+        if (prefetch && hovered_id && !hover_requested) {
+            double left = PREVIEW_DWELL_MS - (metrics_now_ms() - hovered_since);
+            if (left <= 0) {
+                info_prefetch_request(prefetch, provider, hovered_id);
+                hover_requested = true;
+            } else {
+                timeout = (int)left + 1;
+            }
+        }
+        
+        list_view_begin(view);
         int line = 1;
         
         // Show title
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Select anime:");
-        attroff(COLOR_PAIR(1) | A_BOLD);
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Select anime:");
+        
+        // Results keep streaming in while providers answer
+        if (pending > 0) {
+            list_view_print(view, line, 1, COLOR_PAIR(2), "Waiting for %d more provider%s...",
+                            pending, pending == 1 ? "" : "s");
+        }
         line++;
         
         // Display filter if active
-        if (filtering) {
-            attron(COLOR_PAIR(2));
-            mvprintw(line++, 1, "Filter: %s", filter);
-            attroff(COLOR_PAIR(2));
+        if (title_filter_active(filter)) {
+            list_view_print(view, line++, 1, COLOR_PAIR(2), "Filter: %s", title_filter_query(filter));
         }
         
         // Display results
+        list_view_scroll(view, line, max_display, scroll_offset);
         int displayed = 0;
-        for (int i = scroll_offset; i < results->total_results && displayed < max_display; i++) {
-            // Skip if filtering and doesn't match
-            if (filtering && filter[0] != '\0' && 
-                strcasestr(results->results[i].title, filter) == NULL) {
-                continue;
-            }
+        for (int row = scroll_offset; row < rows && displayed < max_display; row++) {
+            int i = title_filter_item(filter, row);
+            char sources[64] = "";
+            if (search) format_sources(federated_search_sources(search, i), sources, sizeof(sources));
             
-            if (i == choice) {
-                attron(A_REVERSE | COLOR_PAIR(2));
-                mvprintw(line++, 1, "> %s (%d episodes)", 
-                         results->results[i].title,
-                         results->results[i].episodes_or_chapters);
-                attroff(A_REVERSE | COLOR_PAIR(2));
+            if (row == choice) {
+                list_view_print(view, line++, 1, A_REVERSE | COLOR_PAIR(2), "> %s (%d episodes)%s",
+                                results->results[i].title, results->results[i].episodes_or_chapters, sources);
             } else {
-                mvprintw(line++, 3, "%s (%d episodes)", 
-                         results->results[i].title,
-                         results->results[i].episodes_or_chapters);
+                list_view_print(view, line++, 3, A_NORMAL, "%s (%d episodes)%s",
+                                results->results[i].title, results->results[i].episodes_or_chapters, sources);
             }
             displayed++;
         }
         
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        mvprintw(line, 1, "Type to filter results, ESC to clear filter, Ctrl+C to quit");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
+        list_view_print(view, line, 1, COLOR_PAIR(1), "Type to filter results, ESC to clear filter or go back, Ctrl+C to quit");
+        
+        const AnimeInfo *preview = info_prefetch_peek(prefetch, provider, hovered_id);
+        bool preview_loading = info_prefetch_loading(prefetch, provider, hovered_id);
+        if (preview || preview_loading) {
+            PreviewInfo details = { 0 };
+            if (preview) {
+                details.title = preview->title;
+                details.status = preview->status;
+                details.genres = preview->genres;
+                details.genres_count = preview->genres_count;
+                details.count = preview->total_episodes;
+                details.count_label = "episodes";
+                details.description = preview->description;
+            }
+            preview_draw(view, 1, LINES - 3, preview ? &details : NULL, preview_loading);
+        }
         
-        refresh();
+        list_view_end(view);
         
-        c = getch();
+        int fds[] = { search ? federated_search_fd(search) : -1, worker_pool_fd() };
+        c = ui_getch_wait(fds, 2, timeout);
+        
+        // The highlight rested long enough, or another provider or a prefetch answered
+        if (c == UI_KEY_TIMEOUT) {
+            continue;
+        }
+        if (c == UI_KEY_UPDATE) {
+            if (search) federated_search_update(search);
+            worker_pool_dispatch();
+            continue;
+        }
         
-        // Handle filtering mode
+        // Handle filtering mode; the match set narrows as characters are typed
         if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || 
             (c >= '0' && c <= '9') || c == ' ' || c == '-') {
-            filtering = true;
-            if (filter_pos < MAX_QUERY_LENGTH - 1) {
-                filter[filter_pos++] = c;
-                filter[filter_pos] = '\0';
-            }
-            choice = scroll_offset; // Reset selection to first visible item
+            title_filter_push(filter, c);
+            choice = scroll_offset = 0; // Start over at the first match
             continue;
         }
         
-        if (filtering && c == KEY_BACKSPACE) {
-            if (filter_pos > 0) {
-                filter[--filter_pos] = '\0';
-                if (filter_pos == 0) {
-                    filtering = false;
-                }
-            }
+        if (title_filter_active(filter) && (c == KEY_BACKSPACE || c == BACKSPACE_KEY)) {
+            title_filter_pop(filter);
+            choice = scroll_offset = 0;
             continue;
         }
         
-        if (filtering && c == ESC_KEY) {
-            filtering = false;
-            filter[0] = '\0';
-            filter_pos = 0;
+        if (title_filter_active(filter) && c == ESC_KEY) {
+            title_filter_clear(filter);
+            choice = scroll_offset = 0;
             continue;
         }
         
@@ -124,12 +213,12 @@ void* anime_ui_select_anime(SearchResult *results) {
                 if (choice < scroll_offset) scroll_offset = choice;
                 break;
             case KEY_DOWN:
-                if (choice < results->total_results - 1) choice++;
+                if (choice < rows - 1) choice++;
                 if (choice >= scroll_offset + max_display) scroll_offset = choice - max_display + 1;
                 break;
             case KEY_NPAGE: // Page Down
                 choice += max_display;
-                if (choice >= results->total_results) choice = results->total_results - 1;
+                if (choice >= rows) choice = rows > 0 ? rows - 1 : 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
             case KEY_PPAGE: // Page Up
@@ -137,22 +226,84 @@ void* anime_ui_select_anime(SearchResult *results) {
                 if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
-            case ENTER_KEY:
-                // Get provider API and request detailed anime info
-                const ProviderAPI* api = get_provider_api(get_current_provider());
-                return api->get_anime_info(results->results[choice].id);
+            case ENTER_KEY: {
+                if (index < 0) break;
+                
+                // Federated items are served by the provider that returned them
+                if (search) {
+                    set_current_provider(provider);
+                }
+                
+                // A prefetched info opens at once; otherwise request it, and
+                // episodes keep arriving while they are listed
+                AnimeInfo *info = info_prefetch_take(prefetch, provider, hovered_id);
+                if (!info) {
+                    ui_show_loading("Loading anime info...");
+                    info = ui_run_loading(load_info, hovered_id, release_info);
+                    if (!info && ui_loading_cancelled()) {
+                        list_view_invalidate(view); // ESC: back to the results
+                        break;
+                    }
+                }
+                info_prefetch_free(prefetch);
+                title_filter_free(filter);
+                list_view_free(view);
+                return info;
+            }
+            case ESC_KEY:
             case 'q':
+                info_prefetch_free(prefetch);
+                title_filter_free(filter);
+                list_view_free(view);
                 return NULL;
         }
     }
     
+    info_prefetch_free(prefetch);
+    title_filter_free(filter);
+    list_view_free(view);
     return NULL;
 }
 
+void* anime_ui_select_anime(SearchResult *results) {
+    return select_anime(results, NULL);
+}
+
+void* anime_ui_select_federated(FederatedSearch *search) {
+    return select_anime(NULL, search);
+}
+
 // ... existing code ...
 
+// Index the episodes that arrived since the last redraw by number and title
+static void sync_episode_filter(TitleFilter *filter, const AnimeInfo *anime) {
+    char text[512];
+    while (title_filter_size(filter) < anime->total_episodes) {
+        const Episode *episode = &anime->episodes[title_filter_size(filter)];
+        snprintf(text, sizeof(text), "%d %s", episode->number, episode->title ? episode->title : "");
+        if (!title_filter_add(filter, text)) break;
+    }
+    title_filter_refresh(filter);
+}
+
+// Queue state on one line; nothing until the first episode is queued
+static void draw_downloads(ListView *view, int y, const DownloadStatus *downloads) {
+    if (downloads->active) {
+        char bytes[16], speed[16];
+        ui_format_bytes(bytes, sizeof(bytes), downloads->bytes);
+        ui_format_bytes(speed, sizeof(speed), downloads->bytes_per_second);
+        list_view_print(view, y, 1, COLOR_PAIR(2), "Downloading %s: %d/%d segments, %s at %s/s, %d queued",
+                        downloads->current, downloads->segments_done, downloads->segments_total,
+                        bytes, speed, downloads->queued);
+    } else if (downloads->queued > 0 || downloads->completed > 0 || downloads->failed > 0) {
+        list_view_print(view, y, 1, COLOR_PAIR(2), "Downloads: %d done, %d failed, %d queued",
+                        downloads->completed, downloads->failed, downloads->queued);
+    }
+}
+
 void* anime_ui_select_episode(AnimeInfo *anime) {
-    if (!anime || !anime->episodes || anime->total_episodes <= 0) {
+    anime_info_update(anime);
+    if (!anime || (!anime_info_loading(anime) && anime->total_episodes <= 0)) {
         ui_show_error("No episodes available for this anime.");
         return NULL;
     }
@@ -161,74 +312,122 @@ void* anime_ui_select_episode(AnimeInfo *anime) {
     int scroll_offset = 0;
     int max_display = LINES - 7; // Reserve space for header and info
     int c;
+    TitleFilter *filter = title_filter_new();
+    bool filtering = false; // '/' was pressed, typed keys go to the filter
+    ListView *view = list_view_new();
     
     while (1) {
-        clear();
+        // Episodes on screen are handed over as soon as they arrive
+        bool loading = anime_info_loading(anime);
+        anime_info_request(anime, scroll_offset + max_display);
+        if (!loading && anime->total_episodes <= 0) {
+            ui_show_error("No episodes available for this anime.");
+            break;
+        }
+        
+        // Rows are positions in the filtered list, not episode indices
+        sync_episode_filter(filter, anime);
+        int rows = title_filter_count(filter);
+        
+        list_view_begin(view);
         int line = 1;
         
         // Show title and info
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Anime: %s", anime->title);
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Anime: %s", anime->title);
         if (anime->status)
-            mvprintw(line++, 1, "Status: %s", anime->status);
-        attroff(A_BOLD);
-        mvprintw(line++, 1, "Episodes: %d", anime->total_episodes);
-        attroff(COLOR_PAIR(1));
-        line++;
+            list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Status: %s", anime->status);
+        if (loading)
+            list_view_print(view, line++, 1, COLOR_PAIR(1), "Episodes: %d so far, loading...", anime->total_episodes);
+        else if (anime->sub_episodes > 0 || anime->dub_episodes > 0)
+            list_view_print(view, line++, 1, COLOR_PAIR(1), "Episodes: %d (sub %d, dub %d)",
+                            anime->total_episodes, anime->sub_episodes, anime->dub_episodes);
+        else
+            list_view_print(view, line++, 1, COLOR_PAIR(1), "Episodes: %d", anime->total_episodes);
+        
+        DownloadStatus downloads;
+        download_queue_status(&downloads);
+        draw_downloads(view, line++, &downloads);
         
         // Show episode selection title
-        attron(COLOR_PAIR(2) | A_BOLD);
-        mvprintw(line++, 1, "Select episode:");
-        attroff(COLOR_PAIR(2) | A_BOLD);
+        if (filtering)
+            list_view_print(view, line++, 1, COLOR_PAIR(2) | A_BOLD, "Select episode: /%s", title_filter_query(filter));
+        else
+            list_view_print(view, line++, 1, COLOR_PAIR(2) | A_BOLD, "Select episode:");
         
         // Display episodes
+        list_view_scroll(view, line, max_display, scroll_offset);
         int displayed = 0;
-        for (int i = scroll_offset; i < anime->total_episodes && displayed < max_display; i++) {
-            if (i == choice) {
-                attron(A_REVERSE | COLOR_PAIR(2));
-                if (anime->episodes[i].title)
-                    mvprintw(line++, 1, "> Episode %d: %s", 
-                             anime->episodes[i].number,
-                             anime->episodes[i].title);
-                else
-                    mvprintw(line++, 1, "> Episode %d", 
-                             anime->episodes[i].number);
-                attroff(A_REVERSE | COLOR_PAIR(2));
-            } else {
-                if (anime->episodes[i].title)
-                    mvprintw(line++, 3, "Episode %d: %s", 
-                             anime->episodes[i].number,
-                             anime->episodes[i].title);
-                else
-                    mvprintw(line++, 3, "Episode %d", 
-                             anime->episodes[i].number);
-            }
+        for (int row = scroll_offset; row < rows && displayed < max_display; row++) {
+            Episode *episode = &anime->episodes[title_filter_item(filter, row)];
+            bool selected = row == choice;
+            attr_t attrs = selected ? A_REVERSE | COLOR_PAIR(2) : A_NORMAL;
+            
+            if (episode->title)
+                list_view_print(view, line++, selected ? 1 : 3, attrs, "%sEpisode %d: %s",
+                                selected ? "> " : "", episode->number, episode->title);
+            else
+                list_view_print(view, line++, selected ? 1 : 3, attrs, "%sEpisode %d",
+                                selected ? "> " : "", episode->number);
             displayed++;
         }
         
+        // Rows of the window that have not arrived yet
+        if (loading && displayed < max_display) {
+            list_view_print(view, line++, 3, A_DIM, "Loading episodes...");
+        }
+        
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        mvprintw(line, 1, "Press 'q' to go back, Ctrl+C to quit");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select, "
+                                                         "'d' to download, 'D' to download this and later episodes");
+        list_view_print(view, line, 1, COLOR_PAIR(1), filtering ? "Type to filter episodes, ESC to stop filtering, Ctrl+C to quit"
+                                                                : "Press '/' to filter, 'q' or ESC to go back, Ctrl+C to quit");
+        
+        list_view_end(view);
+        
+        // Keep the download line moving while the queue works
+        int fds[] = { anime_info_fd(anime) };
+        c = ui_getch_wait(fds, 1, downloads.active || downloads.queued > 0 ? DOWNLOAD_REFRESH_MS : -1);
         
-        refresh();
+        // While filtering, typed characters narrow the list to the best matches
+        if (filtering && c >= ' ' && c <= '~') {
+            title_filter_push(filter, c);
+            choice = scroll_offset = 0;
+            continue;
+        }
         
-        c = getch();
+        if (filtering && (c == KEY_BACKSPACE || c == BACKSPACE_KEY)) {
+            if (!title_filter_pop(filter)) filtering = false;
+            choice = scroll_offset = 0;
+            continue;
+        }
+        
+        if (filtering && c == ESC_KEY) {
+            title_filter_clear(filter);
+            filtering = false;
+            choice = scroll_offset = 0;
+            continue;
+        }
         
         switch (c) {
+            case UI_KEY_UPDATE:
+                anime_info_update(anime);
+                break;
+            case '/':
+                filtering = true;
+                break;
             case KEY_UP:
                 if (choice > 0) choice--;
                 if (choice < scroll_offset) scroll_offset = choice;
                 break;
             case KEY_DOWN:
-                if (choice < anime->total_episodes - 1) choice++;
+                if (choice < rows - 1) choice++;
                 if (choice >= scroll_offset + max_display) scroll_offset = choice - max_display + 1;
                 break;
             case KEY_NPAGE: // Page Down
                 choice += max_display;
-                if (choice >= anime->total_episodes) choice = anime->total_episodes - 1;
+                if (choice >= rows) choice = rows - 1;
+                if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
             case KEY_PPAGE: // Page Up
@@ -236,149 +435,283 @@ void* anime_ui_select_episode(AnimeInfo *anime) {
                 if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
-            case ENTER_KEY:
+            case ENTER_KEY: {
                 // Get the episode ID and fetch stream info
-                return anime->episodes[choice].id;
+                if (choice >= rows) break;
+                char *id = anime->episodes[title_filter_item(filter, choice)].id;
+                title_filter_free(filter);
+                list_view_free(view);
+                return id;
+            }
+            case 'd':
+            case 'D': {
+                // 'D' queues the rest of the season that has arrived so far
+                if (choice >= rows) break;
+                int first = title_filter_item(filter, choice);
+                int last = c == 'D' ? anime->total_episodes - 1 : first;
+                for (int i = first; i <= last; i++) {
+                    const Episode *episode = &anime->episodes[i];
+                    if (!download_queue_add(anime->provider, episode->id, anime->title, episode->number)) break;
+                }
+                break;
+            }
+            case ESC_KEY: // Going back also stops the episodes still loading
             case 'q':
+                title_filter_free(filter);
+                list_view_free(view);
                 return NULL;
         }
     }
     
+    title_filter_free(filter);
+    list_view_free(view);
     return NULL;
 }
 
-void anime_ui_play_episode(StreamInfo *stream) {
-    if (!stream || !stream->sources || stream->sources_count == 0) {
-        ui_show_error("No streaming sources available.");
+// Shared mpv instance, started with the first episode
+static MpvPlayer *player = NULL;
+
+// Streams of the episode after the one playing, resolved ahead of time
+static StreamPrefetch *speculative = NULL;
+
+static MpvPlayer* get_player() {
+    if (player && !mpv_player_running(player)) {
+        mpv_player_quit(player);
+        player = NULL;
+    }
+    if (!player) {
+        player = mpv_player_start(app_config.mpv_additional_args);
+    }
+    return player;
+}
+
+static void format_time(char *buffer, size_t size, double seconds) {
+    if (seconds < 0) {
+        snprintf(buffer, size, "--:--");
         return;
     }
+    int total = (int)seconds;
+    if (total >= 3600) {
+        snprintf(buffer, size, "%d:%02d:%02d", total / 3600, (total / 60) % 60, total % 60);
+    } else {
+        snprintf(buffer, size, "%02d:%02d", total / 60, total % 60);
+    }
+}
+
+// Redrawn on every player update, so normally only the position row is sent
+static void draw_now_playing(ListView *view, AnimeInfo *anime, int index, const StreamInfo *stream,
+                             bool paused, bool autoplay) {
+    list_view_begin(view);
+    int line = 1;
     
-    // Save current terminal state and exit ncurses mode
-    endwin();
+    list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Now playing: %s", anime->title);
     
-    printf("Loading episode...\n");
+    Episode *episode = &anime->episodes[index];
+    if (episode->title)
+        list_view_print(view, line++, 1, A_NORMAL, "Episode %d: %s", episode->number, episode->title);
+    else
+        list_view_print(view, line++, 1, A_NORMAL, "Episode %d", episode->number);
     
-    // Build mpv command with URL and headers
-    char command[4096] = {0};
+    const char *missing = anime_stream_missing_category(stream);
+    if (missing) {
+        list_view_print(view, line++, 1, COLOR_PAIR(3), "Playing %s: no %s stream was available",
+                        stream->category, missing);
+    }
+    line++;
     
-    // Basic mpv command with video URL and improved options
-    snprintf(command, sizeof(command), 
-             "mpv --force-window=immediate --cache=yes --demuxer-max-bytes=150M \"%s\"", 
-             stream->sources[0].url);
-
-    // Add headers if provided
-    if (stream->referer) {
-        char header_cmd[512];
-        snprintf(header_cmd, sizeof(header_cmd), 
-                 " --http-header-fields=\"Referer: %s\"", stream->referer);
-        strcat(command, header_cmd);
+    char position[16], duration[16];
+    format_time(position, sizeof(position), mpv_player_position(player));
+    format_time(duration, sizeof(duration), mpv_player_duration(player));
+    list_view_print(view, line++, 1, COLOR_PAIR(2), "%s / %s%s", position, duration, paused ? "  (paused)" : "");
+    line++;
+    
+    const char *next_state = "none";
+    if (index + 1 < anime->total_episodes) {
+        next_state = !speculative ? "not resolved" :
+                     stream_prefetch_wait(speculative, 0) ? "resolved" : "resolving";
     }
+    list_view_print(view, line++, 1, A_NORMAL, "Autoplay: %s", autoplay ? "on" : "off");
+    list_view_print(view, line++, 1, A_NORMAL, "Next episode: %s", next_state);
+    
+    line = LINES - 2;
+    list_view_print(view, line++, 1, COLOR_PAIR(1), "SPACE to pause, 'n' for next episode, 'a' to toggle autoplay");
+    list_view_print(view, line, 1, COLOR_PAIR(1), "Press 'q' to stop and go back");
+    
+    list_view_end(view);
+}
 
-    if (stream->user_agent) {
-        char ua_cmd[512];
-        snprintf(ua_cmd, sizeof(ua_cmd), 
-                 " --user-agent=\"%s\"", stream->user_agent);
-        strcat(command, ua_cmd);
+// Keep the following episode resolved, replacing results that expired
+static void speculate_next(AnimeInfo *anime, int index) {
+    if (index + 1 >= anime->total_episodes) return;
+    
+    const char *next_id = anime->episodes[index + 1].id;
+    if (stream_prefetch_matches(speculative, next_id) && !stream_prefetch_expired(speculative)) {
+        return;
     }
+    
+    stream_prefetch_free(speculative);
+    speculative = stream_prefetch_start(next_id);
+}
 
-    // Add subtitle support with improved handling
-    if (stream->subtitles && stream->subtitles_count > 0) {
-        // Find English subtitle for default selection
-        int english_sub_index = -1;
-        
-        for (int i = 0; i < stream->subtitles_count; i++) {
-            if (stream->subtitles[i].url && stream->subtitles[i].lang) {
-                // Skip thumbnail VTT files
-                if (strstr(stream->subtitles[i].url, "thumbnails") != NULL) {
-                    continue;
-                }
-                
-                // Look for English subtitles
-                if (strstr(stream->subtitles[i].lang, "English") != NULL) {
-                    english_sub_index = i;
-                }
+// Get an episode's streams, skipping the round trip when they were resolved ahead
+static StreamInfo* get_episode_stream(const char *episode_id) {
+    if (stream_prefetch_matches(speculative, episode_id)) {
+        // Already in flight: waiting for it beats starting over
+        while (!stream_prefetch_wait(speculative, STREAM_WAIT_TICK_MS)) {
+            if (!ui_wait_tick(NULL)) {
+                return NULL; // ESC
             }
         }
+        ui_clear_activity();
         
-        // Add all valid subtitle files
-        int valid_sub_count = 0;
-        for (int i = 0; i < stream->subtitles_count; i++) {
-            if (stream->subtitles[i].url && stream->subtitles[i].lang) {
-                // Skip thumbnail VTT files
-                if (strstr(stream->subtitles[i].url, "thumbnails") != NULL) {
-                    continue;
-                }
-                
-                valid_sub_count++;
-                char sub_cmd[1024];
-                // Only use --sub-file without --sub-name for better compatibility
-                snprintf(sub_cmd, sizeof(sub_cmd), 
-                        " --sub-file=\"%s\"", 
-                        stream->subtitles[i].url);
-                strcat(command, sub_cmd);
-                
-                // Print language info to console for reference
-                printf("Subtitle %d: %s\n", valid_sub_count, stream->subtitles[i].lang);
-            }
+        StreamInfo *stream = stream_prefetch_take(speculative);
+        stream_prefetch_free(speculative);
+        speculative = NULL;
+        if (stream) {
+            return stream;
         }
+    }
+    
+    // Failed or expired speculation gets one fresh attempt
+    return ui_run_loading(load_stream, episode_id, release_stream);
+}
+
+void anime_ui_play_episode(AnimeInfo *anime, int index, StreamInfo *stream) {
+    if (!stream || !stream->sources || stream->sources_count == 0) {
+        ui_show_error("No streaming sources available.");
+        return;
+    }
+    
+    if (!get_player()) {
+        ui_show_error("Failed to start mpv. Make sure it is installed.");
+        return;
+    }
+    
+    // The first episode belongs to the caller, later ones to this loop
+    StreamInfo *owned_stream = NULL;
+    bool autoplay = true;
+    bool paused = false;
+    ListView *view = list_view_new();
+    
+    mpv_player_load(player, stream);
+    speculate_next(anime, index);
+    
+    while (1) {
+        // The rest of a long list may still be arriving
+        anime_info_update(anime);
+        bool has_next = index + 1 < anime->total_episodes;
+        bool advance = false;
+        
+        draw_now_playing(view, anime, index, owned_stream ? owned_stream : stream, paused, autoplay);
         
-        // Select English subtitle by default if found
-        if (english_sub_index >= 0) {
-            char sid_cmd[32];
-            // Convert from index to 1-based sid number, accounting for valid subs
-            int sid = 1;
-            for (int i = 0; i < english_sub_index; i++) {
-                if (stream->subtitles[i].url && 
-                    stream->subtitles[i].lang && 
-                    strstr(stream->subtitles[i].url, "thumbnails") == NULL) {
-                    sid++;
+        int c = ui_getch_watch(mpv_player_fd(player));
+        
+        if (c == UI_KEY_UPDATE) {
+            MpvEvent event;
+            while ((event = mpv_player_next_event(player)) != MPV_EVENT_NONE) {
+                if (event == MPV_EVENT_SHUTDOWN) {
+                    // Window closed: the next episode starts a fresh player
+                    mpv_player_quit(player);
+                    player = NULL;
+                    anime_free_stream_info(owned_stream);
+                    list_view_free(view);
+                    return;
+                }
+                if (event == MPV_EVENT_END_OF_FILE && autoplay && has_next) {
+                    advance = true;
                 }
             }
-            snprintf(sid_cmd, sizeof(sid_cmd), " --sid=%d", sid);
-            strcat(command, sid_cmd);
-            printf("Default subtitle: English (sid=%d)\n", sid);
+            
+            // Tokens in the resolved links may run out during a long episode
+            speculate_next(anime, index);
+        } else if (c == ' ') {
+            paused = !paused;
+            mpv_player_set_pause(player, paused);
+        } else if (c == 'a') {
+            autoplay = !autoplay;
+        } else if (c == 'n' && has_next) {
+            advance = true;
+        } else if (c == 'q') {
+            mpv_player_stop(player);
+            break;
         }
         
-        // Enable subtitle visibility by default
-        strcat(command, " --sub-visibility=yes");
+        if (!advance) continue;
+        
+        ui_show_loading("Getting stream data...");
+        list_view_invalidate(view);
+        StreamInfo *next_stream = get_episode_stream(anime->episodes[index + 1].id);
+        if (!next_stream && ui_loading_cancelled()) {
+            continue; // ESC: keep playing the current episode
+        }
+        if (!next_stream || next_stream->sources_count == 0) {
+            ui_show_error("Failed to get streaming link.");
+            anime_free_stream_info(next_stream);
+            continue;
+        }
+        
+        // Same player, just a new file: no cold start between episodes
+        anime_free_stream_info(owned_stream);
+        owned_stream = next_stream;
+        paused = false;
+        index++;
+        mpv_player_load(player, owned_stream);
+        speculate_next(anime, index);
     }
     
-    // Execute the command
-    system(command);
-    
-    printf("Returning to episode selection. Press Enter to continue...\n");
-    getchar();
-    
-    // Restore terminal state
-    refresh();
+    anime_free_stream_info(owned_stream);
+    list_view_free(view);
 }
 
-void anime_ui_main_loop() {
+void anime_ui_main_loop(bool federated) {
     while (1) {
         // Get search query
         char *query = anime_ui_get_search_query();
         if (!query || strlen(query) == 0) {
             free(query);
+            
+            // Close the player window along with the anime menu
+            mpv_player_quit(player);
+            player = NULL;
             return; // Return to main menu
         }
         
-        // Show loading indicator
-        ui_show_loading("Searching anime...");
-        
-        // Search for anime
-        SearchResult *results = anime_search(query);
-        free(query);
+        AnimeInfo *selected_anime = NULL;
         
-        if (!results || results->total_results == 0) {
-            ui_show_error("No anime found matching your query.");
-            if (results) anime_free_search_results(results);
-            continue;
+        if (federated) {
+            // Query every anime provider at once, results stream into the list
+            FederatedSearch *search = federated_search_start(CONTENT_ANIME, query);
+            free(query);
+            
+            if (!search) {
+                ui_show_error("Failed to start search.");
+                continue;
+            }
+            
+            selected_anime = anime_ui_select_federated(search);
+            federated_search_free(search);
+        } else {
+            // Show loading indicator
+            ui_show_loading("Searching anime...");
+            
+            // Search for anime
+            SearchResult *results = ui_run_loading(load_search, query, release_search);
+            free(query);
+            
+            if (!results && ui_loading_cancelled()) {
+                continue; // ESC: back to the search prompt
+            }
+            if (!results || results->total_results == 0) {
+                ui_show_error("No anime found matching your query.");
+                if (results) anime_free_search_results(results);
+                continue;
+            }
+            
+            // Let user select an anime
+            selected_anime = anime_ui_select_anime(results);
+            anime_free_search_results(results);
         }
         
-        // Let user select an anime
-        AnimeInfo *selected_anime = anime_ui_select_anime(results);
-        anime_free_search_results(results);
-        
         if (!selected_anime) {
             continue; // Return to search
         }
@@ -392,11 +725,20 @@ void anime_ui_main_loop() {
             if (episode_id) {
                 // Get streaming link for the episode
                 ui_show_loading("Getting stream data...");
-                StreamInfo *stream_info = anime_get_episode_stream(episode_id, NULL);
+                StreamInfo *stream_info = get_episode_stream(episode_id);
+                
+                int index = 0;
+                while (index < selected_anime->total_episodes - 1 &&
+                       strcmp(selected_anime->episodes[index].id, episode_id) != 0) {
+                    index++;
+                }
                 
+                if (!stream_info && ui_loading_cancelled()) {
+                    continue; // ESC: back to the episode list
+                }
                 if (stream_info && stream_info->sources_count > 0) {
-                    // Play the episode
-                    anime_ui_play_episode(stream_info);
+                    // Play the episode, continuing with the next ones on autoplay
+                    anime_ui_play_episode(selected_anime, index, stream_info);
                     anime_free_stream_info(stream_info);
                     // After playing, we'll loop back to episode selection
                 } else {
@@ -410,6 +752,8 @@ void anime_ui_main_loop() {
         }
         
         // Clean up anime info before returning to search
+        stream_prefetch_free(speculative);
+        speculative = NULL;
         anime_free_info(selected_anime);
     }
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef ANIME_UI_H
 #define ANIME_UI_H
 
+#include <stdbool.h>
 #include "../api/anime.h"
+#include "../api/federated.h"
 
 // Get search query from user
 char* anime_ui_get_search_query();
@@ -9,13 +11,23 @@ char* anime_ui_get_search_query();
 // Display anime search results and let user select one
 void* anime_ui_select_anime(SearchResult *results);
 
+// Display results of a federated search as providers answer and let user select one
+void* anime_ui_select_federated(FederatedSearch *search);
+
 // Display anime episodes and let user select one
 void* anime_ui_select_episode(AnimeInfo *anime);
 
-// Play episode with streaming information
-void anime_ui_play_episode(StreamInfo *stream);
+/**
+ * Play an episode in the shared mpv window and show what is playing
+ * The next episode's streams are resolved in the background while this one
+ * plays; with autoplay on they are loaded into the same player at the end.
+ * @param anime The anime the episode belongs to
+ * @param index Index of the episode in anime->episodes
+ * @param stream Stream of that episode (still owned by the caller)
+ */
+void anime_ui_play_episode(AnimeInfo *anime, int index, StreamInfo *stream);
 
-// Main anime UI loop
-void anime_ui_main_loop();
+// Main anime UI loop; federated searches query every anime provider at once
+void anime_ui_main_loop(bool federated);
 
 #endif /* ANIME_UI_H */
\ No newline at end of file
@@ -1,10 +1,33 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <poll.h>
 #include <ncurses.h>
 #include "display.h"
+#include "input.h"
 #include "../../config.h"
+#include "../../api/http.h"
+#include "../../api/cancel.h"
+#include "../../api/metrics.h"
+#include "../../api/worker_pool.h"
+#include "../../utils/memory.h"
+
+#define TRANSFERS_LINE 6      // First row of the transfer list on the loading screen
+#define LOAD_TICK_MS 100       // Longest wait between key checks while a call runs
+#define TRANSFERS_MAX 32
+#define PROGRESS_BAR_WIDTH 20
+
+// The loading screen is up and transfers are listed under its message
+static bool loading_shown = false;
+static double loading_started_ms = 0;
+static double last_refresh_ms = 0;
+
+// ESC on the loading screen cancels this; requests the UI thread starts meanwhile carry it
+static CancelToken *loading_cancel = NULL;
 
 void ui_show_error(const char *message) {
+    ui_end_loading();
     clear();
     attron(COLOR_PAIR(3) | A_BOLD);
     mvprintw(1, 1, "Error:");
@@ -13,7 +36,7 @@ void ui_show_error(const char *message) {
     mvprintw(4, 1, "Press any key to continue...");
     attroff(COLOR_PAIR(3));
     refresh();
-    getch();
+    ui_getch();
 }
 
 void ui_show_loading(const char *message) {
@@ -21,6 +44,198 @@ void ui_show_loading(const char *message) {
     attron(COLOR_PAIR(2));
     mvprintw(1, 1, "%s", message ? message : "Loading...");
     attroff(COLOR_PAIR(2));
+    attron(COLOR_PAIR(1));
+    mvprintw(3, 1, "Press ESC to cancel");
+    attroff(COLOR_PAIR(1));
+    refresh();
+    
+    loading_shown = true;
+    loading_started_ms = metrics_now_ms();
+    
+    // Each loading screen is one operation ESC can cancel
+    cancel_token_free(loading_cancel);
+    loading_cancel = cancel_token_new();
+    http_set_cancel_token(loading_cancel);
+}
+
+void ui_end_loading() {
+    loading_shown = false;
+    http_set_cancel_token(NULL);
+    cancel_token_free(loading_cancel);
+    loading_cancel = NULL;
+}
+
+void ui_cancel_loading() {
+    cancel_token_cancel(loading_cancel);
+}
+
+bool ui_loading_cancelled() {
+    return cancel_token_cancelled(loading_cancel);
+}
+
+// A provider call the loading screen waits for
+typedef struct {
+    UiLoadFn load;
+    UiReleaseFn release;
+    char *arg;
+    CancelToken *cancel;
+    void *result;    // Set on the worker, read after dispatch
+
+    // UI thread only
+    bool finished;
+    bool abandoned;  // ESC went back; the completion frees the result
+} LoadJob;
+
+static void free_load_job(LoadJob *job) {
+    free(job->arg);
+    cancel_token_free(job->cancel);
+    free(job);
+}
+
+static void run_load_job(void *ctx) {
+    LoadJob *job = ctx;
+    http_set_cancel_token(job->cancel);
+    job->result = job->load(job->arg);
+}
+
+static void finish_load_job(void *ctx) {
+    LoadJob *job = ctx;
+    if (!job->abandoned) {
+        job->finished = true;
+        return;
+    }
+
+    if (job->result && job->release) {
+        job->release(job->result);
+    }
+    free_load_job(job);
+}
+
+void* ui_run_loading(UiLoadFn load, const char *arg, UiReleaseFn release) {
+    // Results of calls abandoned earlier are released here at the latest
+    worker_pool_dispatch();
+
+    LoadJob *job = calloc(1, sizeof(LoadJob));
+    if (!job) {
+        fprintf(stderr, "Failed to allocate memory for loading job\n");
+        return NULL;
+    }
+    job->load = load;
+    job->release = release;
+    job->arg = safe_strdup(arg);
+    job->cancel = cancel_token_ref(loading_cancel);
+
+    if (!worker_pool_submit(run_load_job, finish_load_job, job)) {
+        // Without the pool the call blocks here, with ui_wait_tick as its wait hook
+        free_load_job(job);
+        return load(arg);
+    }
+
+    int tick = app_config.ui_refresh_rate > 0 && app_config.ui_refresh_rate < LOAD_TICK_MS ?
+               app_config.ui_refresh_rate : LOAD_TICK_MS;
+    while (1) {
+        struct pollfd pfds[2] = {
+            { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 },
+            { .fd = worker_pool_fd(), .events = POLLIN, .revents = 0 }
+        };
+        poll(pfds, 2, tick);
+
+        worker_pool_dispatch();
+        if (job->finished) break;
+
+        if (!ui_wait_tick(NULL)) {
+            job->abandoned = true;
+            return NULL; // ESC
+        }
+    }
+    ui_clear_activity();
+
+    void *result = job->result;
+    free_load_job(job);
+    return result;
+}
+
+bool ui_refresh_due() {
+    double now = metrics_now_ms();
+    if (now - last_refresh_ms < app_config.ui_refresh_rate) {
+        return false;
+    }
+    last_refresh_ms = now;
+    return true;
+}
+
+void ui_format_bytes(char *buffer, size_t size, double bytes) {
+    static const char *units[] = { "B", "KB", "MB", "GB" };
+    int unit = 0;
+    while (bytes >= 1024 && unit < 3) {
+        bytes /= 1024;
+        unit++;
+    }
+    snprintf(buffer, size, unit == 0 ? "%.0f %s" : "%.1f %s", bytes, units[unit]);
+}
+
+void ui_draw_transfers() {
+    if (!loading_shown) return;
+    
+    HttpTransferProgress transfers[TRANSFERS_MAX];
+    int count = http_progress_snapshot(transfers, TRANSFERS_MAX);
+    
+    int y, x;
+    getyx(stdscr, y, x);
+    move(TRANSFERS_LINE, 0);
+    clrtobot();
+    
+    // Totals over what is in flight right now
+    double bytes = 0, rate = 0;
+    for (int i = 0; i < count; i++) {
+        bytes += transfers[i].downloaded;
+        rate += transfers[i].bytes_per_second;
+    }
+    char received[16], speed[16];
+    ui_format_bytes(received, sizeof(received), bytes);
+    ui_format_bytes(speed, sizeof(speed), rate);
+    
+    int line = TRANSFERS_LINE;
+    attron(COLOR_PAIR(1));
+    mvprintw(line++, 1, "%.1fs elapsed, %d transfer%s in flight, %s at %s/s",
+             (metrics_now_ms() - loading_started_ms) / 1000.0,
+             count, count == 1 ? "" : "s", received, speed);
+    attroff(COLOR_PAIR(1));
+    line++;
+    
+    for (int i = 0; i < count && line < LINES - 1; i++, line++) {
+        HttpTransferProgress *transfer = &transfers[i];
+        
+        move(line, 1);
+        if (transfer->total > 0) {
+            long long percentage = transfer->downloaded * 100 / transfer->total;
+            ui_draw_progress_bar(percentage > 100 ? 100 : (int)percentage, PROGRESS_BAR_WIDTH);
+        } else {
+            // Length unknown: the byte count alone shows it moving
+            attron(COLOR_PAIR(2));
+            printw("[%*s]", PROGRESS_BAR_WIDTH, "");
+            attroff(COLOR_PAIR(2));
+        }
+        
+        char done[16], total[16];
+        ui_format_bytes(done, sizeof(done), transfer->downloaded);
+        ui_format_bytes(total, sizeof(total), transfer->total);
+        ui_format_bytes(speed, sizeof(speed), transfer->bytes_per_second);
+        
+        // Scheme and query string add nothing; the end of the path says most
+        const char *url = strstr(transfer->url, "://");
+        url = url ? url + 3 : transfer->url;
+        int url_len = (int)strcspn(url, "?");
+        int column = PROGRESS_BAR_WIDTH + 9;
+        int room = COLS - column - 44;
+        if (room < 0) room = 0;
+        const char *shown = url_len > room ? url + url_len - room : url;
+        mvprintw(line, column, "%9s / %-9s %10s/s %6.1fs  %.*s", done,
+                 transfer->total > 0 ? total : "?", speed, transfer->elapsed_ms / 1000.0,
+                 (int)(url + url_len - shown), shown);
+    }
+    
+    move(y, x);
     refresh();
 }
 
@@ -40,6 +255,31 @@ void ui_draw_progress_bar(int percentage, int width) {
     attroff(COLOR_PAIR(2));
 }
 
+void ui_draw_activity() {
+    static const char spinner[] = "|/-\\";
+    static int frame = 0;
+    
+    int y, x;
+    getyx(stdscr, y, x);
+    
+    attron(COLOR_PAIR(2) | A_BOLD);
+    mvprintw(0, COLS - 3, "[%c]", spinner[frame]);
+    attroff(COLOR_PAIR(2) | A_BOLD);
+    frame = (frame + 1) % 4;
+    
+    // Keep the cursor where the screen left it
+    move(y, x);
+    refresh();
+}
+
+void ui_clear_activity() {
+    int y, x;
+    getyx(stdscr, y, x);
+    mvprintw(0, COLS - 3, "   ");
+    move(y, x);
+    refresh();
+}
+
 void display_search_result_item(int y, int x, const SearchResultItem *item, bool selected) {
     if (selected) {
         attron(A_REVERSE);
@@ -1,13 +1,55 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <stdbool.h>
+
 // Display error message
 void ui_show_error(const char *message);
 
-// Display loading message
+// Display loading message; transfers in flight are listed under it until another screen takes over
 void ui_show_loading(const char *message);
 
+// The loading screen was replaced by another screen
+void ui_end_loading();
+
+// Abort the requests of the loading screen's operation (ESC)
+void ui_cancel_loading();
+
+// Check whether the loading screen's operation was cancelled, to go back instead of reporting an error
+bool ui_loading_cancelled();
+
+// Blocking call run on the worker pool by ui_run_loading, and how to free what it returns
+typedef void* (*UiLoadFn)(const char *arg);
+typedef void (*UiReleaseFn)(void *result);
+
+/**
+ * Run a blocking provider call on the worker pool behind the loading screen
+ * The UI thread keeps reading keys and listing transfers meanwhile. ESC
+ * cancels the call's requests and returns NULL at once (ui_loading_cancelled
+ * tells); a result arriving after that is released.
+ * @param load Call to run; its requests carry the loading screen's cancel token
+ * @param arg Argument for load, copied so the caller may free it right away
+ * @param release Frees a result nobody waits for any more
+ * @return The call's result, or NULL on failure or ESC
+ */
+void* ui_run_loading(UiLoadFn load, const char *arg, UiReleaseFn release);
+
+// Check whether Config.ui_refresh_rate milliseconds passed since the last repaint of live state
+bool ui_refresh_due();
+
+// List the transfers in flight with their progress, rate and elapsed time under the loading message
+void ui_draw_transfers();
+
+// Human-readable byte count, e.g. "1.4 MB"
+void ui_format_bytes(char *buffer, size_t size, double bytes);
+
 // Draw a progress bar
 void ui_draw_progress_bar(int percentage, int width);
 
+// Animate the network activity spinner in the top-right corner
+void ui_draw_activity();
+
+// Remove the network activity spinner
+void ui_clear_activity();
+
 #endif /* DISPLAY_H */
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "filter.h"
+#include "../../utils/fuzzy.h"
+#include "../../utils/memory.h"
+
+// Case-folded title with its character mask, computed once per title
+typedef struct {
+    const char *text;
+    size_t len;
+    uint64_t mask;
+} FilterTitle;
+
+// A matching title and how well it matched
+typedef struct {
+    int index;
+    int score;
+    int length;
+} FilterMatch;
+
+// Titles matching one prefix of the query, in title order
+typedef struct {
+    FilterMatch *matches;
+    int count;
+    int capacity;
+    int indexed;   // Titles this level has been tested against
+} FilterLevel;
+
+struct TitleFilter {
+    Arena *arena;  // Folded titles
+    FilterTitle *titles;
+    int title_count;
+    int title_capacity;
+
+    char query[TITLE_FILTER_MAX_QUERY + 1];
+    int query_len;
+
+    // levels[n] holds the titles matching the first n characters of the query
+    FilterLevel levels[TITLE_FILTER_MAX_QUERY + 1];
+
+    // Matches of the current level, best first
+    FilterMatch *ranked;
+    int ranked_count;
+    int ranked_capacity;
+};
+
+TitleFilter* title_filter_new() {
+    TitleFilter *filter = calloc(1, sizeof(TitleFilter));
+    if (!filter) {
+        fprintf(stderr, "Failed to allocate memory for filter\n");
+        return NULL;
+    }
+
+    filter->arena = arena_create(0);
+    return filter;
+}
+
+static bool append_match(FilterLevel *level, int index, int score, int length) {
+    if (level->count == level->capacity) {
+        int capacity = level->capacity ? level->capacity * 2 : 64;
+        FilterMatch *matches = realloc(level->matches, capacity * sizeof(FilterMatch));
+        if (!matches) {
+            fprintf(stderr, "Failed to grow filter matches\n");
+            return false;
+        }
+        level->matches = matches;
+        level->capacity = capacity;
+    }
+
+    level->matches[level->count++] = (FilterMatch){ index, score, length };
+    return true;
+}
+
+// Sort key: best score first, then the shorter title
+static uint32_t rank_key(const FilterMatch *match) {
+    int score = match->score;
+    if (score > INT16_MAX) score = INT16_MAX;
+    if (score < INT16_MIN) score = INT16_MIN;
+    uint32_t length = match->length < UINT16_MAX ? (uint32_t)match->length : UINT16_MAX;
+    return (uint32_t)(INT16_MAX - score) << 16 | length;
+}
+
+// Order the current level's matches for display
+// A stable radix sort keeps equal matches in result order; tens of
+// thousands of matches re-rank on every keystroke, where qsort was the bottleneck.
+static void rank(TitleFilter *filter) {
+    FilterLevel *level = &filter->levels[filter->query_len];
+    if (filter->query_len == 0) return;  // Nothing typed: results keep their order
+
+    if (level->count > filter->ranked_capacity) {
+        // The second half is scratch space for the sort
+        FilterMatch *ranked = realloc(filter->ranked, 2 * level->capacity * sizeof(FilterMatch));
+        if (!ranked) {
+            fprintf(stderr, "Failed to grow filter ranking\n");
+            filter->ranked_count = 0;
+            return;
+        }
+        filter->ranked = ranked;
+        filter->ranked_capacity = level->capacity;
+    }
+
+    int count = level->count;
+    FilterMatch *from = level->matches;
+    FilterMatch *to = filter->ranked;
+    FilterMatch *scratch = filter->ranked + filter->ranked_capacity;
+
+    // One pass per key byte; the last pass lands in ranked
+    for (int shift = 0; shift < 32; shift += 8) {
+        int offsets[257] = { 0 };
+        for (int m = 0; m < count; m++) {
+            offsets[((rank_key(&from[m]) >> shift) & 0xFF) + 1]++;
+        }
+        for (int b = 0; b < 256; b++) {
+            offsets[b + 1] += offsets[b];
+        }
+
+        FilterMatch *out = shift == 24 ? to : (from == scratch ? to : scratch);
+        for (int m = 0; m < count; m++) {
+            out[offsets[(rank_key(&from[m]) >> shift) & 0xFF]++] = from[m];
+        }
+        from = out;
+    }
+    filter->ranked_count = count;
+}
+
+// Test the titles a level has not seen yet against its prefix of the query
+static bool extend_level(TitleFilter *filter, int length) {
+    FilterLevel *level = &filter->levels[length];
+    if (level->indexed == filter->title_count) return false;
+
+    char prefix[TITLE_FILTER_MAX_QUERY + 1];
+    memcpy(prefix, filter->query, length);
+    prefix[length] = '\0';
+    FuzzyPattern pattern;
+    fuzzy_pattern_init(&pattern, prefix);
+
+    for (; level->indexed < filter->title_count; level->indexed++) {
+        const FilterTitle *title = &filter->titles[level->indexed];
+        int score;
+        if (!fuzzy_match(&pattern, title->text, title->len, title->mask, &score)) continue;
+        if (!append_match(level, level->indexed, score, (int)title->len)) break;
+    }
+    return true;
+}
+
+bool title_filter_add(TitleFilter *filter, const char *title) {
+    if (!filter) return false;
+
+    if (filter->title_count == filter->title_capacity) {
+        int capacity = filter->title_capacity ? filter->title_capacity * 2 : 64;
+        FilterTitle *titles = realloc(filter->titles, capacity * sizeof(FilterTitle));
+        if (!titles) {
+            fprintf(stderr, "Failed to grow filter index\n");
+            return false;
+        }
+        filter->titles = titles;
+        filter->title_capacity = capacity;
+    }
+
+    size_t len = title ? strlen(title) : 0;
+    char *folded = arena_alloc(filter->arena, len + 1);
+    fuzzy_fold(folded, title ? title : "", len);
+    folded[len] = '\0';
+
+    FilterTitle *entry = &filter->titles[filter->title_count++];
+    entry->text = folded;
+    entry->len = len;
+    entry->mask = fuzzy_char_mask(folded, len);
+    return true;
+}
+
+int title_filter_size(const TitleFilter *filter) {
+    return filter ? filter->title_count : 0;
+}
+
+void title_filter_refresh(TitleFilter *filter) {
+    // Shorter prefixes catch up when the query is widened again
+    if (filter && extend_level(filter, filter->query_len)) {
+        rank(filter);
+    }
+}
+
+void title_filter_sync(TitleFilter *filter, const SearchResult *results) {
+    if (!filter || !results) return;
+
+    while (filter->title_count < results->total_results) {
+        if (!title_filter_add(filter, results->results[filter->title_count].title)) break;
+    }
+    title_filter_refresh(filter);
+}
+
+bool title_filter_push(TitleFilter *filter, char c) {
+    if (!filter || filter->query_len == TITLE_FILTER_MAX_QUERY) return false;
+
+    FilterLevel *parent = &filter->levels[filter->query_len];
+    filter->query[filter->query_len++] = c;
+    filter->query[filter->query_len] = '\0';
+
+    FuzzyPattern pattern;
+    fuzzy_pattern_init(&pattern, filter->query);
+
+    // A title matching the longer query also matches the shorter one
+    FilterLevel *level = &filter->levels[filter->query_len];
+    level->count = 0;
+    level->indexed = parent->indexed;
+    for (int m = 0; m < parent->count; m++) {
+        const FilterTitle *title = &filter->titles[parent->matches[m].index];
+        int score;
+        if (!fuzzy_match(&pattern, title->text, title->len, title->mask, &score)) continue;
+        if (!append_match(level, parent->matches[m].index, score, (int)title->len)) break;
+    }
+
+    rank(filter);
+    return true;
+}
+
+bool title_filter_pop(TitleFilter *filter) {
+    if (!filter || filter->query_len == 0) return false;
+
+    filter->query[--filter->query_len] = '\0';
+    extend_level(filter, filter->query_len);
+    rank(filter);
+    return true;
+}
+
+void title_filter_clear(TitleFilter *filter) {
+    if (!filter || filter->query_len == 0) return;
+
+    filter->query_len = 0;
+    filter->query[0] = '\0';
+    extend_level(filter, 0);
+}
+
+const char* title_filter_query(const TitleFilter *filter) {
+    return filter ? filter->query : "";
+}
+
+bool title_filter_active(const TitleFilter *filter) {
+    return filter && filter->query_len > 0;
+}
+
+int title_filter_count(const TitleFilter *filter) {
+    if (!filter) return 0;
+    return filter->query_len == 0 ? filter->levels[0].count : filter->ranked_count;
+}
+
+int title_filter_item(const TitleFilter *filter, int row) {
+    if (filter->query_len == 0) {
+        return filter->levels[0].matches[row].index;
+    }
+    return filter->ranked[row].index;
+}
+
+void title_filter_free(TitleFilter *filter) {
+    if (!filter) return;
+
+    for (int i = 0; i <= TITLE_FILTER_MAX_QUERY; i++) {
+        free(filter->levels[i].matches);
+    }
+    free(filter->ranked);
+    free(filter->titles);
+    arena_destroy(filter->arena);
+    free(filter);
+}
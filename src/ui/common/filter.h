@@ -0,0 +1,74 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdbool.h>
+#include "../../api/api.h"
+
+// Type-to-filter state of a selection list: the typed query and the rows
+// matching it, ranked by fuzzy match quality
+typedef struct TitleFilter TitleFilter;
+
+// Longest query the filter accepts
+#define TITLE_FILTER_MAX_QUERY 255
+
+// Create an empty filter; every row matches until characters are typed
+TitleFilter* title_filter_new();
+
+/**
+ * Index the next row's title
+ * The title is case-folded once here; call title_filter_refresh after a
+ * batch of rows to test them against the current query.
+ * @param title Text the row is matched by (copied)
+ * @return false if the index could not grow
+ */
+bool title_filter_add(TitleFilter *filter, const char *title);
+
+// Number of rows indexed so far
+int title_filter_size(const TitleFilter *filter);
+
+// Match the rows added since the last refresh against the current query
+void title_filter_refresh(TitleFilter *filter);
+
+/**
+ * Index the results added since the last call and refresh
+ * Result lists only ever grow at the end (federated and lazy results append).
+ * @param results Results the filter rows refer to
+ */
+void title_filter_sync(TitleFilter *filter, const SearchResult *results);
+
+/**
+ * Append a character to the query
+ * The query matches titles containing its characters in order, not
+ * necessarily adjacent. Only the rows matching the shorter query are tested again.
+ * @return false if the query is already at TITLE_FILTER_MAX_QUERY
+ */
+bool title_filter_push(TitleFilter *filter, char c);
+
+/**
+ * Remove the last character of the query
+ * The match set of the shorter query is kept, so widening costs nothing
+ * beyond testing results that arrived since it was built.
+ * @return false if the query was already empty
+ */
+bool title_filter_pop(TitleFilter *filter);
+
+// Clear the query so that every row matches again
+void title_filter_clear(TitleFilter *filter);
+
+// Query typed so far
+const char* title_filter_query(const TitleFilter *filter);
+
+// Check whether a query is being typed
+bool title_filter_active(const TitleFilter *filter);
+
+// Number of rows matching the query
+int title_filter_count(const TitleFilter *filter);
+
+// Index of the row at a position of the filtered list, best match first
+// (rows keep their order while no query is typed)
+int title_filter_item(const TitleFilter *filter, int row);
+
+// Release a filter
+void title_filter_free(TitleFilter *filter);
+
+#endif /* FILTER_H */
@@ -3,7 +3,28 @@
 #include <string.h>
 #include <ncurses.h>
 #include <ctype.h>
+#include <unistd.h>
+#include <poll.h>
 #include "input.h"
+#include "display.h"
+#include "../../api/http.h"
+#include "../../api/metrics.h"
+
+#define ESC_KEY 27
+#define UI_TICK_MS 100
+#define PENDING_KEYS_SIZE 32
+
+// Keys typed while a blocking request was running
+static int pending_keys[PENDING_KEYS_SIZE];
+static int pending_key_count = 0;
+
+// Read a key without blocking; returns ERR if none is pending
+static int read_key_nonblocking() {
+    nodelay(stdscr, TRUE);
+    int c = getch();
+    nodelay(stdscr, FALSE);
+    return c;
+}
 
 char* ui_get_text_input(int max_length) {
     char *input = malloc(max_length);
@@ -11,6 +32,7 @@ char* ui_get_text_input(int max_length) {
         return NULL;
     }
     
+    ui_end_loading();
     echo(); // Show user input
     getstr(input);
     noecho();
@@ -25,9 +47,132 @@ bool ui_get_confirmation(const char *prompt) {
     
     int c;
     do {
-        c = getch();
+        c = ui_getch();
         c = tolower(c);
     } while (c != 'y' && c != 'n');
     
     return (c == 'y');
-}
\ No newline at end of file
+}
+
+int ui_getch() {
+    // Whatever screen waits for a key has replaced the loading screen
+    ui_end_loading();
+    
+    // Keys typed during a blocking load come first
+    if (pending_key_count > 0) {
+        int c = pending_keys[0];
+        memmove(pending_keys, pending_keys + 1, (pending_key_count - 1) * sizeof(int));
+        pending_key_count--;
+        return c;
+    }
+
+    if (http_pending() == 0) {
+        return getch();
+    }
+
+    // Poll the network and the keyboard together until a key arrives
+    while (1) {
+        int c = read_key_nonblocking();
+        if (c != ERR) {
+            ui_clear_activity();
+            return c;
+        }
+
+        if (http_poll(UI_TICK_MS, STDIN_FILENO) > 0) {
+            if (ui_refresh_due()) ui_draw_activity();
+        } else {
+            ui_clear_activity();
+            return getch();
+        }
+    }
+}
+
+// Check whether any of the descriptors is readable, without waiting
+static bool any_readable(const int *fds, int count) {
+    for (int i = 0; i < count; i++) {
+        if (fds[i] < 0) continue;
+        struct pollfd pfd = { .fd = fds[i], .events = POLLIN, .revents = 0 };
+        if (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ui_getch_watch(int fd) {
+    return ui_getch_wait(&fd, 1, -1);
+}
+
+int ui_getch_wait(const int *fds, int count, int timeout_ms) {
+    int watched = 0;
+    for (int i = 0; i < count; i++) {
+        if (fds[i] >= 0) watched++;
+    }
+    if (watched == 0 && timeout_ms < 0) {
+        return ui_getch();
+    }
+    ui_end_loading();
+
+    if (pending_key_count > 0) {
+        return ui_getch();
+    }
+
+    double deadline = metrics_now_ms() + timeout_ms;
+    while (1) {
+        if (any_readable(fds, count)) {
+            return UI_KEY_UPDATE;
+        }
+
+        int c = read_key_nonblocking();
+        if (c != ERR) {
+            return c;
+        }
+
+        int tick = UI_TICK_MS;
+        if (timeout_ms >= 0) {
+            double left = deadline - metrics_now_ms();
+            if (left <= 0) {
+                return UI_KEY_TIMEOUT;
+            }
+            if (left < tick) tick = (int)left + 1;
+        }
+
+        // Keep our own requests moving while waiting for any source
+        if (http_pending() > 0) {
+            http_poll(tick, STDIN_FILENO);
+        } else {
+            struct pollfd pfds[1 + UI_WAIT_MAX_FDS];
+            int nfds = 0;
+            pfds[nfds++] = (struct pollfd){ .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 };
+            for (int i = 0; i < count && nfds <= UI_WAIT_MAX_FDS; i++) {
+                if (fds[i] >= 0) {
+                    pfds[nfds++] = (struct pollfd){ .fd = fds[i], .events = POLLIN, .revents = 0 };
+                }
+            }
+            poll(pfds, nfds, tick);
+        }
+    }
+}
+
+bool ui_wait_tick(void *ctx) {
+    (void)ctx;
+    int c;
+
+    while ((c = read_key_nonblocking()) != ERR) {
+        if (c == ESC_KEY) {
+            ui_cancel_loading();
+            ui_clear_activity();
+            return false;
+        }
+        if (pending_key_count < PENDING_KEYS_SIZE) {
+            pending_keys[pending_key_count++] = c;
+        }
+    }
+
+    // Socket activity wakes this up far more often than the screen needs repainting
+    if (ui_refresh_due()) {
+        ui_draw_activity();
+        ui_draw_transfers();
+    }
+    return true;
+}
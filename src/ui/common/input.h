@@ -2,6 +2,16 @@
 #define INPUT_H
 
 #include <stdbool.h>
+#include <ncurses.h>
+
+// Returned by ui_getch_watch when the watched descriptor becomes readable
+#define UI_KEY_UPDATE (KEY_MAX + 1)
+
+// Returned by ui_getch_wait when its timeout passed without a key
+#define UI_KEY_TIMEOUT (KEY_MAX + 2)
+
+// Most descriptors ui_getch_wait watches at once
+#define UI_WAIT_MAX_FDS 4
 
 // Get text input from user
 char* ui_get_text_input(int max_length);
@@ -9,4 +19,23 @@ char* ui_get_text_input(int max_length);
 // Get yes/no confirmation from user
 bool ui_get_confirmation(const char *prompt);
 
+// Read a key while keeping background requests moving
+int ui_getch();
+
+// Read a key, or return UI_KEY_UPDATE as soon as fd becomes readable
+int ui_getch_watch(int fd);
+
+/**
+ * Read a key, or return as soon as a descriptor is readable or time is up
+ * @param fds Descriptors to watch; negative entries are skipped
+ * @param count Number of entries in fds (at most UI_WAIT_MAX_FDS are polled)
+ * @param timeout_ms Longest wait, or -1 to wait for a key or descriptor only
+ * @return The key, UI_KEY_UPDATE or UI_KEY_TIMEOUT
+ */
+int ui_getch_wait(const int *fds, int count, int timeout_ms);
+
+// Wait hook for blocking requests: animates activity and lists transfers
+// at Config.ui_refresh_rate, ESC aborts
+bool ui_wait_tick(void *ctx);
+
 #endif /* INPUT_H */
\ No newline at end of file
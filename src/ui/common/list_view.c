@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "list_view.h"
+
+// Text placed on a row
+typedef struct {
+    char *text;
+    size_t capacity;
+    int x;
+    attr_t attrs;
+    bool set;       // Blank when false
+} ViewText;
+
+// One screen row as last stated: the main text and a side pane cutting it off
+typedef struct {
+    ViewText main;
+    ViewText side;
+} ViewRow;
+
+struct ListView {
+    int lines;      // Screen size the rows were laid out for
+    int cols;
+    ViewRow *shown; // What the screen shows
+    ViewRow *next;  // Frame being built
+    bool invalid;   // Screen contents unknown, repaint everything
+
+    // Scrolling list of the shown frame and of the next one
+    bool shown_scroll;
+    int shown_top;
+    int shown_height;
+    int shown_first;
+    bool next_scroll;
+    int next_top;
+    int next_height;
+    int next_first;
+};
+
+static void free_rows(ViewRow *rows, int count) {
+    if (!rows) return;
+    for (int i = 0; i < count; i++) {
+        free(rows[i].main.text);
+        free(rows[i].side.text);
+    }
+    free(rows);
+}
+
+// Lay the rows out for the current terminal size
+static bool fit_screen(ListView *view) {
+    if (view->shown && view->lines == LINES && view->cols == COLS) {
+        return true;
+    }
+
+    free_rows(view->shown, view->lines);
+    free_rows(view->next, view->lines);
+    view->lines = LINES;
+    view->cols = COLS;
+    view->shown = calloc(view->lines, sizeof(ViewRow));
+    view->next = calloc(view->lines, sizeof(ViewRow));
+    view->invalid = true;
+    view->shown_scroll = false;
+
+    if (!view->shown || !view->next) {
+        fprintf(stderr, "Failed to allocate list view rows\n");
+        free(view->shown);
+        free(view->next);
+        view->shown = view->next = NULL;
+        view->lines = 0;
+        return false;
+    }
+    return true;
+}
+
+ListView* list_view_new() {
+    ListView *view = calloc(1, sizeof(ListView));
+    if (!view) {
+        fprintf(stderr, "Failed to allocate memory for list view\n");
+        return NULL;
+    }
+
+    fit_screen(view);
+    return view;
+}
+
+void list_view_begin(ListView *view) {
+    if (!view || !fit_screen(view)) return;
+
+    for (int y = 0; y < view->lines; y++) {
+        view->next[y].main.set = false;
+        view->next[y].side.set = false;
+    }
+    view->next_scroll = false;
+}
+
+static void set_text(ViewText *row, int x, attr_t attrs, const char *format, va_list args) {
+    va_list retry;
+    va_copy(retry, args);
+    int len = vsnprintf(row->text, row->capacity, format, args);
+    if (len < 0) {
+        va_end(retry);
+        return;
+    }
+
+    if ((size_t)len >= row->capacity) {
+        size_t capacity = len + 1 > 64 ? (size_t)len + 1 : 64;
+        char *text = realloc(row->text, capacity);
+        if (!text) {
+            fprintf(stderr, "Failed to grow list view row\n");
+            va_end(retry);
+            return;
+        }
+        row->text = text;
+        row->capacity = capacity;
+        vsnprintf(row->text, row->capacity, format, retry);
+    }
+    va_end(retry);
+
+    row->x = x;
+    row->attrs = attrs;
+    row->set = true;
+}
+
+void list_view_print(ListView *view, int y, int x, attr_t attrs, const char *format, ...) {
+    if (!view || y < 0 || y >= view->lines) return;
+
+    va_list args;
+    va_start(args, format);
+    set_text(&view->next[y].main, x, attrs, format, args);
+    va_end(args);
+}
+
+void list_view_print_side(ListView *view, int y, int x, attr_t attrs, const char *format, ...) {
+    if (!view || y < 0 || y >= view->lines) return;
+
+    va_list args;
+    va_start(args, format);
+    set_text(&view->next[y].side, x, attrs, format, args);
+    va_end(args);
+}
+
+void list_view_scroll(ListView *view, int top, int height, int first) {
+    if (!view) return;
+
+    view->next_scroll = true;
+    view->next_top = top;
+    view->next_height = height;
+    view->next_first = first;
+}
+
+static bool texts_equal(const ViewText *a, const ViewText *b) {
+    if (a->set != b->set) return false;
+    if (!a->set) return true;
+    return a->x == b->x && a->attrs == b->attrs && strcmp(a->text, b->text) == 0;
+}
+
+static bool rows_equal(const ViewRow *a, const ViewRow *b) {
+    return texts_equal(&a->main, &b->main) && texts_equal(&a->side, &b->side);
+}
+
+static void paint_text(int y, const ViewText *text, int end) {
+    if (!text->set || text->x >= end) return;
+
+    attrset(text->attrs);
+    mvaddnstr(y, text->x, text->text, end - text->x);
+    attrset(A_NORMAL);
+}
+
+static void paint_row(const ListView *view, int y, const ViewRow *row) {
+    move(y, 0);
+    clrtoeol();
+
+    int side_x = row->side.set && row->side.x < view->cols ? row->side.x : view->cols;
+    paint_text(y, &row->main, side_x);
+    paint_text(y, &row->side, view->cols);
+}
+
+// Scroll the terminal's list region and the record of what it shows along with it
+static void scroll_shown(ListView *view, int top, int height, int delta) {
+    setscrreg(top, top + height - 1);
+    scrollok(stdscr, TRUE);
+    scrl(delta);
+    scrollok(stdscr, FALSE);
+    setscrreg(0, view->lines - 1);
+
+    // Rows that left the region become the blank rows scrolled in at the other end
+    ViewRow moved[height];
+    int shift = delta > 0 ? delta : height + delta;
+    for (int i = 0; i < height; i++) {
+        moved[i] = view->shown[top + (i + shift) % height];
+    }
+    int blank_from = delta > 0 ? height - delta : 0;
+    int blank_to = delta > 0 ? height : -delta;
+    for (int i = blank_from; i < blank_to; i++) {
+        moved[i].main.set = false;
+        moved[i].side.set = false;
+    }
+    memcpy(view->shown + top, moved, height * sizeof(ViewRow));
+}
+
+void list_view_end(ListView *view) {
+    if (!view || !view->shown) return;
+
+    if (view->invalid) {
+        erase();
+        for (int y = 0; y < view->lines; y++) {
+            view->shown[y].main.set = false;
+            view->shown[y].side.set = false;
+        }
+    } else if (view->next_scroll && view->shown_scroll &&
+               view->next_top == view->shown_top && view->next_height == view->shown_height) {
+        int top = view->next_top;
+        int height = view->next_height;
+        if (top + height > view->lines) height = view->lines - top;
+
+        int delta = view->next_first - view->shown_first;
+        if (top >= 0 && height > 1 && delta != 0 && abs(delta) < height) {
+            scroll_shown(view, top, height, delta);
+        }
+    }
+
+    for (int y = 0; y < view->lines; y++) {
+        if (!rows_equal(&view->shown[y], &view->next[y])) {
+            paint_row(view, y, &view->next[y]);
+        }
+    }
+
+    // The frame just painted is what the screen shows now; its old buffers are reused
+    ViewRow *shown = view->shown;
+    view->shown = view->next;
+    view->next = shown;
+    view->shown_scroll = view->next_scroll;
+    view->shown_top = view->next_top;
+    view->shown_height = view->next_height;
+    view->shown_first = view->next_first;
+    view->invalid = false;
+
+    refresh();
+}
+
+void list_view_invalidate(ListView *view) {
+    if (view) {
+        view->invalid = true;
+    }
+}
+
+void list_view_free(ListView *view) {
+    if (!view) return;
+
+    free_rows(view->shown, view->lines);
+    free_rows(view->next, view->lines);
+    free(view);
+}
@@ -0,0 +1,59 @@
+#ifndef LIST_VIEW_H
+#define LIST_VIEW_H
+
+#include <stdbool.h>
+#include <ncurses.h>
+
+// Retained-mode screen of text rows for the list screens
+// Each frame states every row; only the rows that differ from the previous
+// frame are repainted, so an arrow press costs two rows instead of the screen.
+typedef struct ListView ListView;
+
+// Create a view; its first frame replaces whatever the screen shows
+ListView* list_view_new();
+
+// Start a frame; rows not printed before list_view_end are left blank
+void list_view_begin(ListView *view);
+
+/**
+ * Set the content of a screen row for this frame
+ * Text is cut at the right edge rather than wrapping onto the next row.
+ * @param y Screen row
+ * @param x Column the text starts at
+ * @param attrs Attributes for the whole text (e.g. A_REVERSE | COLOR_PAIR(2))
+ * @param format printf-style format
+ */
+void list_view_print(ListView *view, int y, int x, attr_t attrs, const char *format, ...);
+
+/**
+ * Set the side pane part of a screen row for this frame
+ * The row's main text is cut where the side text starts, so a pane can sit
+ * beside the list on the same rows.
+ * @param y Screen row
+ * @param x Column the pane starts at
+ * @param attrs Attributes for the side text
+ * @param format printf-style format
+ */
+void list_view_print_side(ListView *view, int y, int x, attr_t attrs, const char *format, ...);
+
+/**
+ * Declare the scrolling part of this frame
+ * Rows top to top + height - 1 show consecutive items starting at first.
+ * When first moved by less than a screenful since the last frame, the
+ * terminal scrolls the region and only the rows scrolled into view are sent.
+ * @param top First screen row of the list
+ * @param height Number of rows of the list
+ * @param first Index of the item on the top row
+ */
+void list_view_scroll(ListView *view, int top, int height, int first);
+
+// Repaint the rows that changed since the last frame and refresh
+void list_view_end(ListView *view);
+
+// Repaint every row on the next frame (e.g. after another screen drew over this one)
+void list_view_invalidate(ListView *view);
+
+// Release a view (the screen keeps showing its last frame)
+void list_view_free(ListView *view);
+
+#endif /* LIST_VIEW_H */
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include <ncurses.h>
+#include "preview.h"
+
+#define PREVIEW_BORDER "| "
+#define PREVIEW_GENRES_MAX 256
+
+int preview_pane_x() {
+    return COLS >= PREVIEW_MIN_COLS ? COLS * 3 / 5 : -1;
+}
+
+// State the next line of text that fits width, moving *text past it
+static int print_wrapped(ListView *view, int y, int x, int width, attr_t attrs, const char **text) {
+    const char *start = *text;
+    while (*start == ' ' || *start == '\n') start++;
+
+    int len = 0;
+    int cut = 0;
+    while (start[len] && start[len] != '\n' && len < width) {
+        if (start[len] == ' ') cut = len;
+        len++;
+    }
+    // Break at the last space unless the word alone is wider than the pane
+    if (start[len] && start[len] != '\n' && start[len] != ' ' && cut > 0) {
+        len = cut;
+    }
+
+    list_view_print_side(view, y, x, attrs, PREVIEW_BORDER "%.*s", len, start);
+    *text = start + len;
+    return len;
+}
+
+void preview_draw(ListView *view, int top, int bottom, const PreviewInfo *info, bool loading) {
+    int x = preview_pane_x();
+    if (x < 0 || top > bottom) return;
+
+    int width = COLS - x - (int)strlen(PREVIEW_BORDER) - 1;
+    int y = top;
+
+    if (!info) {
+        list_view_print_side(view, y++, x, COLOR_PAIR(2), PREVIEW_BORDER "%s",
+                             loading ? "Loading preview..." : "");
+    } else {
+        const char *title = info->title ? info->title : "";
+        while (*title && y <= bottom && y < top + 2) {
+            print_wrapped(view, y++, x, width, COLOR_PAIR(1) | A_BOLD, &title);
+        }
+
+        if (info->status && y <= bottom) {
+            list_view_print_side(view, y++, x, A_NORMAL, PREVIEW_BORDER "Status: %s", info->status);
+        }
+        if (y <= bottom) {
+            list_view_print_side(view, y++, x, A_NORMAL, PREVIEW_BORDER "%d %s",
+                                 info->count, info->count_label);
+        }
+
+        if (info->genres_count > 0 && y <= bottom) {
+            char genres[PREVIEW_GENRES_MAX];
+            size_t len = 0;
+            for (int i = 0; i < info->genres_count && len < sizeof(genres); i++) {
+                len += snprintf(genres + len, sizeof(genres) - len, i > 0 ? ", %s" : "%s", info->genres[i]);
+            }
+            const char *text = genres;
+            while (*text && y <= bottom && y < top + 6) {
+                print_wrapped(view, y++, x, width, COLOR_PAIR(2), &text);
+            }
+        }
+
+        if (y <= bottom) {
+            list_view_print_side(view, y++, x, A_NORMAL, PREVIEW_BORDER);
+        }
+
+        const char *text = info->description ? info->description : "";
+        while (*text && y <= bottom) {
+            print_wrapped(view, y++, x, width, A_NORMAL, &text);
+            while (*text == ' ' || *text == '\n') text++;
+        }
+    }
+
+    // The border runs down to the bottom of the pane
+    while (y <= bottom) {
+        list_view_print_side(view, y++, x, A_NORMAL, PREVIEW_BORDER);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef PREVIEW_H
+#define PREVIEW_H
+
+#include <stdbool.h>
+#include "list_view.h"
+
+// Narrowest terminal that shows a preview pane beside a result list
+#define PREVIEW_MIN_COLS 100
+
+// How long the highlight rests on a result before its info is fetched
+#define PREVIEW_DWELL_MS 300
+
+// Details of the highlighted result, borrowed from its info
+typedef struct {
+    const char *title;
+    const char *status;
+    char **genres;
+    int genres_count;
+    int count;                  // Episodes or chapters
+    const char *count_label;    // "episodes" or "chapters"
+    const char *description;
+} PreviewInfo;
+
+// Column the pane starts at, or -1 when the terminal is too narrow for one
+int preview_pane_x();
+
+/**
+ * State the preview pane as the side part of rows top to bottom
+ * @param view View of the list screen
+ * @param top First row of the pane
+ * @param bottom Last row of the pane
+ * @param info Details to show, or NULL while loading is true
+ * @param loading The details are still being fetched
+ */
+void preview_draw(ListView *view, int top, int bottom, const PreviewInfo *info, bool loading);
+
+#endif /* PREVIEW_H */
@@ -5,12 +5,21 @@
 #include "manga_ui.h"
 #include "common/input.h"
 #include "common/display.h"
+#include "common/filter.h"
+#include "common/list_view.h"
+#include "common/preview.h"
 #include "../config.h"
 #include "../api/manga.h"
+#include "../api/prefetch.h"
+#include "../api/info_prefetch.h"
+#include "../api/metrics.h"
+#include "../api/worker_pool.h"
 #include "../utils/memory.h"
 
 #define MAX_QUERY_LENGTH 256
 #define ENTER_KEY 10
+#define VIEWER_START_PAGES 3   // Pages on disk before the viewer opens
+#define VIEWER_WAIT_TICK_MS 100
 #define ESC_KEY 27
 #define BACKSPACE_KEY 127
 
@@ -24,6 +33,13 @@ char* manga_ui_get_search_query() {
     return ui_get_text_input(MAX_QUERY_LENGTH);
 }
 
+// Provider calls in the shape ui_run_loading runs them
+static void* load_search(const char *query) { return manga_search(query); }
+static void release_search(void *results) { manga_free_search_results(results); }
+static void* load_info(const char *id) { return manga_open_info(id); }
+static void release_info(void *info) { manga_free_info(info); }
+static void* fetch_info(ProviderType provider, const char *id) { return manga_get_info_from(provider, id); }
+
 void* manga_ui_select_manga(SearchResult *results) {
     if (!results || results->total_results <= 0) {
         ui_show_error("No results found.");
@@ -34,87 +50,119 @@ void* manga_ui_select_manga(SearchResult *results) {
     int scroll_offset = 0;
     int max_display = LINES - 5;
     int c;
-    char filter[MAX_QUERY_LENGTH] = "";
-    int filter_pos = 0;
-    bool filtering = false;
+    TitleFilter *filter = title_filter_new();
+    title_filter_sync(filter, results);
+    ListView *view = list_view_new();
+    
+    // As in the anime list, a result the highlight rests on is fetched ahead
+    InfoPrefetch *prefetch = info_prefetch_new(INFO_PREFETCH_CAPACITY, fetch_info, release_info);
+    int hovered = -1;
+    double hovered_since = 0;
+    bool hover_requested = false;
     
     while (1) {
-        clear();
+        // Rows are positions in the filtered list, not result indices
+        int rows = title_filter_count(filter);
+        
+        int index = choice < rows ? title_filter_item(filter, choice) : -1;
+        if (index != hovered) {
+            hovered = index;
+            hovered_since = metrics_now_ms();
+            hover_requested = false;
+        }
+        const char *hovered_id = hovered >= 0 ? results->results[hovered].id : NULL;
+        
+        int timeout = -1;
+        if (prefetch && hovered_id && !hover_requested) {
+            double left = PREVIEW_DWELL_MS - (metrics_now_ms() - hovered_since);
+            if (left <= 0) {
+                info_prefetch_request(prefetch, results->provider, hovered_id);
+                hover_requested = true;
+            } else {
+                timeout = (int)left + 1;
+            }
+        }
+        
+        list_view_begin(view);
         int line = 1;
         
         // Show title
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Select manga:");
-        attroff(COLOR_PAIR(1) | A_BOLD);
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Select manga:");
         line++;
         
         // Display filter if active
-        if (filtering) {
-            attron(COLOR_PAIR(2));
-            mvprintw(line++, 1, "Filter: %s", filter);
-            attroff(COLOR_PAIR(2));
+        if (title_filter_active(filter)) {
+            list_view_print(view, line++, 1, COLOR_PAIR(2), "Filter: %s", title_filter_query(filter));
         }
         
         // Display results
+        list_view_scroll(view, line, max_display, scroll_offset);
         int displayed = 0;
-        for (int i = scroll_offset; i < results->total_results && displayed < max_display; i++) {
-            // Skip if filtering and doesn't match
-            if (filtering && filter[0] != '\0' && 
-                strcasestr(results->results[i].title, filter) == NULL) {
-                continue;
-            }
+        for (int row = scroll_offset; row < rows && displayed < max_display; row++) {
+            int i = title_filter_item(filter, row);
             
-            if (i == choice) {
-                attron(A_REVERSE | COLOR_PAIR(2));
-                mvprintw(line++, 1, "> %s (%d chapters)", 
-                         results->results[i].title,
-                         results->results[i].episodes_or_chapters);
-                attroff(A_REVERSE | COLOR_PAIR(2));
+            if (row == choice) {
+                list_view_print(view, line++, 1, A_REVERSE | COLOR_PAIR(2), "> %s (%d chapters)",
+                                results->results[i].title, results->results[i].episodes_or_chapters);
             } else {
-                mvprintw(line++, 3, "%s (%d chapters)", 
-                         results->results[i].title,
-                         results->results[i].episodes_or_chapters);
+                list_view_print(view, line++, 3, A_NORMAL, "%s (%d chapters)",
+                                results->results[i].title, results->results[i].episodes_or_chapters);
             }
             displayed++;
         }
         
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        mvprintw(line, 1, "Type to filter results, ESC to clear filter, 'q' to go back");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
+        list_view_print(view, line, 1, COLOR_PAIR(1), "Type to filter results, ESC to clear filter or go back");
         
-        refresh();
+        const MangaInfo *preview = info_prefetch_peek(prefetch, results->provider, hovered_id);
+        bool preview_loading = info_prefetch_loading(prefetch, results->provider, hovered_id);
+        if (preview || preview_loading) {
+            PreviewInfo details = { 0 };
+            if (preview) {
+                details.title = preview->title;
+                details.status = preview->status;
+                details.genres = preview->genres;
+                details.genres_count = preview->genres_count;
+                details.count = preview->total_chapters;
+                details.count_label = "chapters";
+                details.description = preview->description;
+            }
+            preview_draw(view, 1, LINES - 3, preview ? &details : NULL, preview_loading);
+        }
         
-        c = getch();
+        list_view_end(view);
         
-        // Handle filtering mode
+        int fd = worker_pool_fd();
+        c = ui_getch_wait(&fd, 1, timeout);
+        
+        // The dwell time passed, or a prefetch finished
+        if (c == UI_KEY_TIMEOUT) {
+            continue;
+        }
+        if (c == UI_KEY_UPDATE) {
+            worker_pool_dispatch();
+            continue;
+        }
+        
+        // Handle filtering mode; the match set narrows as characters are typed
         if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || 
             (c >= '0' && c <= '9') || c == ' ' || c == '-') {
-            filtering = true;
-            if (filter_pos < MAX_QUERY_LENGTH - 1) {
-                filter[filter_pos++] = c;
-                filter[filter_pos] = '\0';
-            }
-            choice = scroll_offset; // Reset selection to first visible item
+            title_filter_push(filter, c);
+            choice = scroll_offset = 0; // Start over at the first match
             continue;
         }
         
-        if (filtering && (c == KEY_BACKSPACE || c == BACKSPACE_KEY)) {
-            if (filter_pos > 0) {
-                filter[--filter_pos] = '\0';
-                if (filter_pos == 0) {
-                    filtering = false;
-                }
-            }
+        if (title_filter_active(filter) && (c == KEY_BACKSPACE || c == BACKSPACE_KEY)) {
+            title_filter_pop(filter);
+            choice = scroll_offset = 0;
             continue;
         }
         
-        if (filtering && c == ESC_KEY) {
-            filtering = false;
-            filter[0] = '\0';
-            filter_pos = 0;
+        if (title_filter_active(filter) && c == ESC_KEY) {
+            title_filter_clear(filter);
+            choice = scroll_offset = 0;
             continue;
         }
         
@@ -124,12 +172,12 @@ void* manga_ui_select_manga(SearchResult *results) {
                 if (choice < scroll_offset) scroll_offset = choice;
                 break;
             case KEY_DOWN:
-                if (choice < results->total_results - 1) choice++;
+                if (choice < rows - 1) choice++;
                 if (choice >= scroll_offset + max_display) scroll_offset = choice - max_display + 1;
                 break;
             case KEY_NPAGE: // Page Down
                 choice += max_display;
-                if (choice >= results->total_results) choice = results->total_results - 1;
+                if (choice >= rows) choice = rows > 0 ? rows - 1 : 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
             case KEY_PPAGE: // Page Up
@@ -137,97 +185,173 @@ void* manga_ui_select_manga(SearchResult *results) {
                 if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
-            case ENTER_KEY:
-                // Get provider API and request detailed manga info
-                const ProviderAPI* api = get_provider_api(get_current_provider());
-                return api->get_manga_info(results->results[choice].id);
+            case ENTER_KEY: {
+                if (index < 0) break;
+                
+                // A prefetched info opens at once; otherwise request it, and
+                // chapters keep arriving while they are listed
+                MangaInfo *info = info_prefetch_take(prefetch, results->provider, hovered_id);
+                if (!info) {
+                    ui_show_loading("Loading manga info...");
+                    info = ui_run_loading(load_info, hovered_id, release_info);
+                    if (!info && ui_loading_cancelled()) {
+                        list_view_invalidate(view); // ESC: back to the results
+                        break;
+                    }
+                }
+                info_prefetch_free(prefetch);
+                title_filter_free(filter);
+                list_view_free(view);
+                return info;
+            }
+            case ESC_KEY:
             case 'q':
+                info_prefetch_free(prefetch);
+                title_filter_free(filter);
+                list_view_free(view);
                 return NULL;
         }
     }
     
+    info_prefetch_free(prefetch);
+    title_filter_free(filter);
+    list_view_free(view);
     return NULL;
 }
 
-void* manga_ui_select_chapter(MangaInfo *manga) {
-    if (!manga || !manga->chapters || manga->total_chapters <= 0) {
+// Index the chapters that arrived since the last redraw by number and title
+static void sync_chapter_filter(TitleFilter *filter, const MangaInfo *manga) {
+    char text[512];
+    while (title_filter_size(filter) < manga->total_chapters) {
+        const MangaChapter *chapter = &manga->chapters[title_filter_size(filter)];
+        snprintf(text, sizeof(text), "%d %s", chapter->number, chapter->title ? chapter->title : "");
+        if (!title_filter_add(filter, text)) break;
+    }
+    title_filter_refresh(filter);
+}
+
+int manga_ui_select_chapter(MangaInfo *manga, int initial_choice) {
+    manga_info_update(manga);
+    if (!manga || (!manga_info_loading(manga) && manga->total_chapters <= 0)) {
         ui_show_error("No chapters available for this manga.");
-        return NULL;
+        return -1;
     }
     
-    int choice = 0;
-    int scroll_offset = 0;
     int max_display = LINES - 7; // Leave space for header and info
+    int choice = 0;
+    if (initial_choice > 0 && initial_choice < manga->total_chapters) {
+        choice = initial_choice;
+    }
+    int scroll_offset = choice >= max_display ? choice - max_display + 1 : 0;
     int c;
+    TitleFilter *filter = title_filter_new();
+    bool filtering = false; // '/' was pressed, typed keys go to the filter
+    ListView *view = list_view_new();
     
     while (1) {
-        clear();
+        // Chapters on screen are handed over as soon as they arrive
+        bool loading = manga_info_loading(manga);
+        manga_info_request(manga, scroll_offset + max_display);
+        if (!loading && manga->total_chapters <= 0) {
+            ui_show_error("No chapters available for this manga.");
+            break;
+        }
+        
+        // Rows are positions in the filtered list, not chapter indices
+        sync_chapter_filter(filter, manga);
+        int rows = title_filter_count(filter);
+        
+        list_view_begin(view);
         int line = 1;
         
         // Show title and info
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Manga: %s", manga->title);
-        attroff(A_BOLD);
-        mvprintw(line++, 1, "Status: %s", manga->status ? manga->status : "Unknown");
-        mvprintw(line++, 1, "Total Chapters: %d", manga->total_chapters);
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Manga: %s", manga->title);
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Status: %s",
+                        manga->status ? manga->status : loading ? "Loading..." : "Unknown");
+        if (loading)
+            list_view_print(view, line++, 1, COLOR_PAIR(1), "Total Chapters: %d so far, loading...", manga->total_chapters);
+        else
+            list_view_print(view, line++, 1, COLOR_PAIR(1), "Total Chapters: %d", manga->total_chapters);
         line++;
         
         // Show chapter selection title
-        attron(COLOR_PAIR(2) | A_BOLD);
-        mvprintw(line++, 1, "Select chapter:");
-        attroff(COLOR_PAIR(2) | A_BOLD);
+        if (filtering)
+            list_view_print(view, line++, 1, COLOR_PAIR(2) | A_BOLD, "Select chapter: /%s", title_filter_query(filter));
+        else
+            list_view_print(view, line++, 1, COLOR_PAIR(2) | A_BOLD, "Select chapter:");
         
         // Display chapters
+        list_view_scroll(view, line, max_display, scroll_offset);
         int displayed = 0;
-        for (int i = scroll_offset; i < manga->total_chapters && displayed < max_display; i++) {
-            if (i == choice) {
-                attron(A_REVERSE | COLOR_PAIR(2));
-                if (manga->chapters[i].title && strlen(manga->chapters[i].title) > 0) {
-                    mvprintw(line++, 1, "> Chapter %d: %s", 
-                             manga->chapters[i].number, 
-                             manga->chapters[i].title);
-                } else {
-                    mvprintw(line++, 1, "> Chapter %d", 
-                             manga->chapters[i].number);
-                }
-                attroff(A_REVERSE | COLOR_PAIR(2));
+        for (int row = scroll_offset; row < rows && displayed < max_display; row++) {
+            MangaChapter *chapter = &manga->chapters[title_filter_item(filter, row)];
+            bool selected = row == choice;
+            attr_t attrs = selected ? A_REVERSE | COLOR_PAIR(2) : A_NORMAL;
+            
+            if (chapter->title && strlen(chapter->title) > 0) {
+                list_view_print(view, line++, selected ? 1 : 3, attrs, "%sChapter %d: %s",
+                                selected ? "> " : "", chapter->number, chapter->title);
             } else {
-                if (manga->chapters[i].title && strlen(manga->chapters[i].title) > 0) {
-                    mvprintw(line++, 3, "Chapter %d: %s", 
-                             manga->chapters[i].number,
-                             manga->chapters[i].title);
-                } else {
-                    mvprintw(line++, 3, "Chapter %d", 
-                             manga->chapters[i].number);
-                }
+                list_view_print(view, line++, selected ? 1 : 3, attrs, "%sChapter %d",
+                                selected ? "> " : "", chapter->number);
             }
             displayed++;
         }
         
+        // Rows of the window that have not arrived yet
+        if (loading && displayed < max_display) {
+            list_view_print(view, line++, 3, A_DIM, "Loading chapters...");
+        }
+        
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        mvprintw(line, 1, "Press 'q' to go back, Ctrl+C to quit");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
+        list_view_print(view, line, 1, COLOR_PAIR(1), filtering ? "Type to filter chapters, ESC to stop filtering, Ctrl+C to quit"
+                                                                : "Press '/' to filter, 'q' or ESC to go back, Ctrl+C to quit");
         
-        refresh();
+        list_view_end(view);
         
-        c = getch();
+        c = ui_getch_watch(manga_info_fd(manga));
+        
+        // While filtering, typed characters narrow the list to the best matches
+        if (filtering && c >= ' ' && c <= '~') {
+            title_filter_push(filter, c);
+            choice = scroll_offset = 0;
+            continue;
+        }
+        
+        if (filtering && (c == KEY_BACKSPACE || c == BACKSPACE_KEY)) {
+            if (!title_filter_pop(filter)) filtering = false;
+            choice = scroll_offset = 0;
+            continue;
+        }
+        
+        if (filtering && c == ESC_KEY) {
+            title_filter_clear(filter);
+            filtering = false;
+            choice = scroll_offset = 0;
+            continue;
+        }
         
         switch (c) {
+            case UI_KEY_UPDATE:
+                manga_info_update(manga);
+                break;
+            case '/':
+                filtering = true;
+                break;
             case KEY_UP:
                 if (choice > 0) choice--;
                 if (choice < scroll_offset) scroll_offset = choice;
                 break;
             case KEY_DOWN:
-                if (choice < manga->total_chapters - 1) choice++;
+                if (choice < rows - 1) choice++;
                 if (choice >= scroll_offset + max_display) scroll_offset = choice - max_display + 1;
                 break;
             case KEY_NPAGE: // Page Down
                 choice += max_display;
-                if (choice >= manga->total_chapters) choice = manga->total_chapters - 1;
+                if (choice >= rows) choice = rows - 1;
+                if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
             case KEY_PPAGE: // Page Up
@@ -235,40 +359,46 @@ void* manga_ui_select_chapter(MangaInfo *manga) {
                 if (choice < 0) choice = 0;
                 scroll_offset = choice - (choice % max_display);
                 break;
-            case ENTER_KEY:
-                const ProviderAPI* api = get_provider_api(get_current_provider());
-                return api->get_chapter_pages(manga->chapters[choice].id);
+            case ENTER_KEY: {
+                if (choice >= rows) break;
+                int index = title_filter_item(filter, choice);
+                title_filter_free(filter);
+                list_view_free(view);
+                return index;
+            }
+            case ESC_KEY: // Going back also stops the chapters still loading
             case 'q':
-                return NULL;
+                title_filter_free(filter);
+                list_view_free(view);
+                return -1;
         }
     }
     
-    return NULL;
+    title_filter_free(filter);
+    list_view_free(view);
+    return -1;
 }
 
-// Update the manga_ui_view_chapter function
-void manga_ui_view_chapter(ChapterPages *pages) {
-    if (!pages || !pages->page_urls || pages->page_count <= 0) {
-        ui_show_error("No pages available for this chapter.");
-        return;
-    }
-    
+// Open the viewer on pages [first, last); false if it could not be started
+static bool launch_viewer(PagePrefetch *prefetch, int first, int last) {
     // Save current terminal state
     endwin();
     
-    // Create a temporary file with all image URLs
+    // Create a temporary file with the image paths
     FILE *temp_file = tmpfile();
     if (!temp_file) {
         fprintf(stderr, "Failed to create temporary file\n");
         
         // Restore terminal state
         refresh();
-        return;
+        return false;
     }
     
-    // Write image URLs to temp file
-    for (int i = 0; i < pages->page_count; i++) {
-        fprintf(temp_file, "%s\n", pages->page_urls[i]);
+    // Only files on disk: viewers drop entries they cannot open, and
+    // loading remotely would skip the referer and download pages twice
+    for (int i = first; i < last; i++) {
+        const char *path = prefetch_page_path(prefetch, i);
+        if (path) fprintf(temp_file, "%s\n", path);
     }
     fflush(temp_file);
     
@@ -321,6 +451,77 @@ void manga_ui_view_chapter(ChapterPages *pages) {
     
     // Restore terminal state
     refresh();
+    return true;
+}
+
+// Wait, with progress, until the pages from first on can be shown; false on ESC
+static bool wait_for_pages(PagePrefetch *prefetch, int first) {
+    ui_show_loading(first == 0 ? "Downloading pages..." : "Downloading more pages...");
+    while (!prefetch_wait(prefetch, first, VIEWER_START_PAGES, VIEWER_WAIT_TICK_MS)) {
+        if (!ui_wait_tick(NULL)) {
+            return false; // ESC
+        }
+        
+        int count = prefetch_page_count(prefetch);
+        if (count > 0) {
+            mvprintw(4, 1, "Pages downloaded: %d/%d", prefetch_pages_finished(prefetch), count);
+            refresh();
+        }
+    }
+    ui_clear_activity();
+    return true;
+}
+
+void manga_ui_view_chapter(PagePrefetch *prefetch) {
+    int first = 0;
+    
+    while (1) {
+        // Open the viewer as soon as the next pages are on disk
+        if (!wait_for_pages(prefetch, first)) {
+            return;
+        }
+        
+        int page_count = prefetch_page_count(prefetch);
+        if (page_count <= 0) {
+            ui_show_error("No pages available for this chapter.");
+            return;
+        }
+        
+        // Everything on disk up to the first page still downloading
+        int last = first + prefetch_pages_ready(prefetch, first);
+        bool any = false;
+        for (int i = first; i < last && !any; i++) {
+            any = prefetch_page_path(prefetch, i) != NULL;
+        }
+        if (!any) {
+            ui_show_error(first == 0 ? "Failed to download chapter pages." : "Failed to download the remaining pages.");
+            return;
+        }
+        
+        if (!launch_viewer(prefetch, first, last) || last >= page_count) {
+            return;
+        }
+        
+        char prompt[128];
+        snprintf(prompt, sizeof(prompt), "Pages %d-%d were still downloading. Keep reading?",
+                 last + 1, page_count);
+        if (!ui_get_confirmation(prompt)) {
+            return;
+        }
+        first = last;
+    }
+}
+
+// Next chapter in reading order, by chapter number
+static int next_chapter_index(MangaInfo *manga, int index) {
+    int next = -1;
+    for (int i = 0; i < manga->total_chapters; i++) {
+        if (manga->chapters[i].number > manga->chapters[index].number &&
+            (next < 0 || manga->chapters[i].number < manga->chapters[next].number)) {
+            next = i;
+        }
+    }
+    return next;
 }
 
 void manga_ui_main_loop() {
@@ -336,9 +537,12 @@ void manga_ui_main_loop() {
         ui_show_loading("Searching manga...");
         
         // Search for manga
-        SearchResult *results = manga_search(query);
+        SearchResult *results = ui_run_loading(load_search, query, release_search);
         free(query);
         
+        if (!results && ui_loading_cancelled()) {
+            continue; // ESC: back to the search prompt
+        }
         if (!results || results->total_results == 0) {
             ui_show_error("No manga found matching your query.");
             if (results) manga_free_search_results(results);
@@ -353,16 +557,47 @@ void manga_ui_main_loop() {
             continue; // Return to search
         }
         
-        // Let user select a chapter
-        ChapterPages *chapter_pages = manga_ui_select_chapter(selected_manga);
-        manga_free_info(selected_manga);
+        // Loop for selecting and reading chapters
+        PagePrefetch *next_prefetch = NULL;
+        int next_index = -1;
+        int choice = 0;
         
-        if (!chapter_pages) {
-            continue; // Return to search
+        while (1) {
+            int index = manga_ui_select_chapter(selected_manga, choice);
+            if (index < 0) {
+                break; // Return to search
+            }
+            
+            // Reuse the background download if the reader moved on as expected
+            PagePrefetch *prefetch;
+            if (next_prefetch && index == next_index) {
+                prefetch = next_prefetch;
+            } else {
+                prefetch_free(next_prefetch);
+                prefetch = prefetch_chapter_start(selected_manga->chapters[index].id, NULL, NULL);
+            }
+            next_prefetch = NULL;
+            
+            if (!prefetch) {
+                ui_show_error("Failed to load chapter pages.");
+                continue;
+            }
+            
+            // The next chapter downloads once this one is complete
+            next_index = next_chapter_index(selected_manga, index);
+            if (next_index >= 0) {
+                next_prefetch = prefetch_chapter_start(selected_manga->chapters[next_index].id,
+                                                       NULL, prefetch);
+            }
+            
+            // View the chapter
+            manga_ui_view_chapter(prefetch);
+            prefetch_free(prefetch);
+            
+            choice = next_index >= 0 ? next_index : index;
         }
         
-        // View the chapter
-        manga_ui_view_chapter(chapter_pages);
-        manga_free_chapter_pages(chapter_pages);
+        prefetch_free(next_prefetch);
+        manga_free_info(selected_manga);
     }
 }
\ No newline at end of file
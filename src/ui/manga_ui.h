@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include "../api/manga.h"
+#include "../api/prefetch.h"
 
 /**
  * Prompts the user for a search query
@@ -25,16 +26,21 @@ void* manga_ui_select_manga(SearchResult *results);
  * Allows the user to select a chapter from a manga
  * 
  * @param manga The manga information containing chapters
- * @return A pointer to ChapterPages for the selected chapter, or NULL if cancelled
+ * @param initial_choice Index of the chapter highlighted first
+ * @return Index of the selected chapter, or -1 if cancelled
  */
-void* manga_ui_select_chapter(MangaInfo *manga);
+int manga_ui_select_chapter(MangaInfo *manga, int initial_choice);
 
 /**
  * View the pages of a manga chapter using an external image viewer
+ * The viewer opens on local files once the first pages have downloaded,
+ * and gets every page on disk up to the first one still downloading. When
+ * it closes before the chapter was complete, the reader is offered the
+ * pages that landed meanwhile.
  * 
- * @param pages The chapter pages to view
+ * @param prefetch The chapter's page download
  */
-void manga_ui_view_chapter(ChapterPages *pages);
+void manga_ui_view_chapter(PagePrefetch *prefetch);
 
 /**
  * Main interaction loop for the manga UI
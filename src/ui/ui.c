@@ -2,95 +2,116 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ncurses.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include "ui.h"
 #include "common/display.h"
 #include "common/input.h"
+#include "common/list_view.h"
 #include "../config.h"   // Add this line to include config.h
+#include "../api/http.h"
+#include "../api/metrics.h"
+
+#define LOG_FILE_NAME "anime-cli.log"
+#define STATS_MAX_SOURCES 8
+
+// Terminal stderr, restored when the UI closes
+static int saved_stderr = -1;
 
 void ui_init() {
+    // Diagnostics would scribble over the screen; send them to a log instead
+    char log_path[1100];
+    int log_fd = config_state_path(LOG_FILE_NAME, log_path, sizeof(log_path))
+                 ? open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644) : -1;
+    if (log_fd >= 0) {
+        fflush(stderr);
+        saved_stderr = dup(STDERR_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        close(log_fd);
+    }
+    
     // Initialize ncurses
     initscr();
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
+    idlok(stdscr, TRUE); // Lets list scrolling use the terminal's insert/delete line
     curs_set(1); // Show cursor
     start_color();
     init_pair(1, COLOR_CYAN, COLOR_BLACK);
     init_pair(2, COLOR_GREEN, COLOR_BLACK);
     init_pair(3, COLOR_RED, COLOR_BLACK);
+    
+    // Make a lone ESC usable for cancelling loads
+    set_escdelay(25);
+    
+    // Keep the screen alive while requests are waiting on the network
+    http_set_wait_hook(ui_wait_tick, STDIN_FILENO, NULL);
 }
 
 void ui_cleanup() {
     endwin();
+    
+    if (saved_stderr >= 0) {
+        fflush(stderr);
+        dup2(saved_stderr, STDERR_FILENO);
+        close(saved_stderr);
+        saved_stderr = -1;
+    }
 }
 
 ContentSelectionOption ui_content_selection() {
+    static const char *options[] = { "Anime", "Manga", "Network stats", "Exit" };
+    int option_count = sizeof(options) / sizeof(options[0]);
     int choice = 0;
     int c;
+    ListView *view = list_view_new();
     
     while (1) {
-        clear();
+        list_view_begin(view);
         int line = 1;
         
         // Show title
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Anime CLI");
-        mvprintw(line++, 1, "Select content type:");
-        attroff(COLOR_PAIR(1) | A_BOLD);
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Anime CLI");
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Select content type:");
         line++;
         
         // Display options
-        if (choice == 0) {
-            attron(A_REVERSE | COLOR_PAIR(2));
-            mvprintw(line++, 1, "> Anime");
-            attroff(A_REVERSE | COLOR_PAIR(2));
-        } else {
-            mvprintw(line++, 3, "Anime");
-        }
-        
-        if (choice == 1) {
-            attron(A_REVERSE | COLOR_PAIR(2));
-            mvprintw(line++, 1, "> Manga");
-            attroff(A_REVERSE | COLOR_PAIR(2));
-        } else {
-            mvprintw(line++, 3, "Manga");
-        }
-        
-        if (choice == 2) {
-            attron(A_REVERSE | COLOR_PAIR(2));
-            mvprintw(line++, 1, "> Exit");
-            attroff(A_REVERSE | COLOR_PAIR(2));
-        } else {
-            mvprintw(line++, 3, "Exit");
+        for (int i = 0; i < option_count; i++) {
+            if (i == choice) {
+                list_view_print(view, line++, 1, A_REVERSE | COLOR_PAIR(2), "> %s", options[i]);
+            } else {
+                list_view_print(view, line++, 3, A_NORMAL, "%s", options[i]);
+            }
         }
         
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
         
-        refresh();
+        list_view_end(view);
         
-        c = getch();
+        c = ui_getch();
         
         switch (c) {
             case KEY_UP:
                 if (choice > 0) choice--;
                 break;
             case KEY_DOWN:
-                if (choice < 2) choice++;
+                if (choice < option_count - 1) choice++;
                 break;
             case 10: // Enter key
+                list_view_free(view);
                 switch (choice) {
                     case 0:
                         return CONTENT_SELECTION_ANIME;
                     case 1:
                         return CONTENT_SELECTION_MANGA;
                     case 2:
+                        return CONTENT_SELECTION_STATS;
+                    default:
                         return CONTENT_SELECTION_EXIT;
                 }
-                break;
         }
     }
     
@@ -103,9 +124,10 @@ ProviderSelectionResult ui_provider_selection(ContentType content_type) {
     ProviderSelectionResult result;
     result.selected_provider = get_current_provider();
     result.canceled = false;
+    result.federated = false;
     
-    int count;
-    const char **providers = get_available_providers(content_type, &count);
+    const char *providers[PROVIDER_COUNT];
+    int count = get_available_providers(content_type, providers);
     
     if (count == 0) {
         ui_show_error("No providers available for this content type");
@@ -125,61 +147,58 @@ ProviderSelectionResult ui_provider_selection(ContentType content_type) {
     }
     
     int choice = 0;
+    int all_option = count;     // Search every provider at once
+    int back_option = count + 1;
     int c;
+    ListView *view = list_view_new();
     
     while (1) {
-        clear();
+        list_view_begin(view);
         int line = 1;
         
         // Show title
-        attron(COLOR_PAIR(1) | A_BOLD);
-        mvprintw(line++, 1, "Select Provider for %s:", content_type_to_string(content_type));
-        attroff(COLOR_PAIR(1) | A_BOLD);
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD, "Select Provider for %s:",
+                        content_type_to_string(content_type));
         line++;
         
-        // Display provider options
-        for (int i = 0; i < count; i++) {
+        // Display provider options, then federated search and back
+        for (int i = 0; i <= back_option; i++) {
+            const char *label = i < count ? providers[i] : i == all_option ? "All providers" : "Back";
             if (i == choice) {
-                attron(A_REVERSE | COLOR_PAIR(2));
-                mvprintw(line++, 1, "> %s", providers[i]);
-                attroff(A_REVERSE | COLOR_PAIR(2));
+                list_view_print(view, line++, 1, A_REVERSE | COLOR_PAIR(2), "> %s", label);
             } else {
-                mvprintw(line++, 3, "%s", providers[i]);
+                list_view_print(view, line++, 3, A_NORMAL, "%s", label);
             }
         }
         
-        // Back option
-        if (choice == count) {
-            attron(A_REVERSE | COLOR_PAIR(2));
-            mvprintw(line++, 1, "> Back");
-            attroff(A_REVERSE | COLOR_PAIR(2));
-        } else {
-            mvprintw(line++, 3, "Back");
-        }
-        
         // Display instructions
         line = LINES - 2;
-        attron(COLOR_PAIR(1));
-        mvprintw(line++, 1, "Use UP/DOWN arrows to navigate, ENTER to select");
-        attroff(COLOR_PAIR(1));
+        list_view_print(view, line++, 1, COLOR_PAIR(1), "Use UP/DOWN arrows to navigate, ENTER to select");
         
-        refresh();
+        list_view_end(view);
         
-        c = getch();
+        c = ui_getch();
         
         switch (c) {
             case KEY_UP:
                 if (choice > 0) choice--;
                 break;
             case KEY_DOWN:
-                if (choice < count) choice++;
+                if (choice < back_option) choice++;
                 break;
             case 10: // Enter key
-                if (choice == count) {
+                list_view_free(view);
+                
+                if (choice == back_option) {
                     result.canceled = true;
                     return result;
                 }
                 
+                if (choice == all_option) {
+                    result.federated = true;
+                    return result;
+                }
+                
                 // Find the provider type that matches the selected name
                 for (int i = 0; i < PROVIDER_COUNT; i++) {
                     if (strcmp(provider_type_to_string(i), providers[choice]) == 0) {
@@ -193,4 +212,60 @@ ProviderSelectionResult ui_provider_selection(ContentType content_type) {
                 return result;
         }
     }
+}
+
+void ui_stats_screen() {
+    MetricsSummary summaries[STATS_MAX_SOURCES];
+    ListView *view = list_view_new();
+    
+    while (1) {
+        int count = metrics_summarize(summaries, STATS_MAX_SOURCES);
+        
+        list_view_begin(view);
+        int line = 1;
+        
+        list_view_print(view, line++, 1, COLOR_PAIR(1) | A_BOLD,
+                        "Network stats (milliseconds, DNS/TCP/TLS/TTFB are p50 from request start)");
+        line++;
+        
+        if (count == 0) {
+            list_view_print(view, line++, 1, A_NORMAL, "No requests made yet.");
+        } else {
+            list_view_print(view, line++, 1, A_BOLD,
+                            "%-10s %5s %5s %5s %7s %7s %6s %6s %6s %6s %6s %6s %8s %7s",
+                            "Source", "Req", "Cache", "Fail", "p50", "p95", "DNS", "TCP", "TLS",
+                            "TTFB", "Parse", "Calls", "KB", "Alloc/c");
+            
+            for (int i = 0; i < count; i++) {
+                MetricsSummary *s = &summaries[i];
+                list_view_print(view, line++, 1, A_NORMAL,
+                                "%-10.10s %5d %5d %5d %7.1f %7.1f %6.1f %6.1f %6.1f %6.1f %6.2f %6d %8lld %7.1f",
+                                s->source, s->requests, s->cache_hits, s->failures,
+                                s->total_p50, s->total_p95, s->namelookup_p50, s->connect_p50,
+                                s->appconnect_p50, s->starttransfer_p50, s->parse_p50,
+                                s->calls, s->bytes / 1024, s->allocations_per_call);
+            }
+            
+            line++;
+            list_view_print(view, line++, 1, A_BOLD, "%-10s %9s %9s %9s %9s", "Source", "Call p50",
+                            "Call p95", "Parse p95", "Cache %");
+            for (int i = 0; i < count; i++) {
+                MetricsSummary *s = &summaries[i];
+                list_view_print(view, line++, 1, A_NORMAL, "%-10.10s %9.1f %9.1f %9.2f %8.0f%%", s->source,
+                                s->call_p50, s->call_p95, s->parse_p95,
+                                s->requests ? 100.0 * s->cache_hits / s->requests : 0.0);
+            }
+        }
+        
+        line = LINES - 2;
+        list_view_print(view, line, 1, COLOR_PAIR(1), "Press 'r' to refresh, 'q' to go back");
+        
+        list_view_end(view);
+        
+        int c = ui_getch();
+        if (c == 'q' || c == 27) {
+            list_view_free(view);
+            return;
+        }
+    }
 }
\ No newline at end of file
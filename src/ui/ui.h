@@ -8,6 +8,7 @@
 typedef enum {
     CONTENT_SELECTION_ANIME,
     CONTENT_SELECTION_MANGA,
+    CONTENT_SELECTION_STATS,
     CONTENT_SELECTION_EXIT
 } ContentSelectionOption;
 
@@ -15,6 +16,7 @@ typedef enum {
 typedef struct {
     ProviderType selected_provider;
     bool canceled;
+    bool federated;     // Search every provider of the content type at once
 } ProviderSelectionResult;
 
 // Initialize UI system
@@ -41,4 +43,7 @@ void ui_settings_menu();
 // About screen
 void ui_about_screen();
 
+// Per-provider network timings recorded this session
+void ui_stats_screen();
+
 #endif /* UI_H */
\ No newline at end of file
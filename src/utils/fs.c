@@ -0,0 +1,25 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "fs.h"
+#include "memory.h"
+
+bool make_dirs(const char *path) {
+    if (!path || !path[0]) return false;
+
+    char *tmp = safe_strdup(path);
+    bool ok = true;
+
+    for (char *p = tmp + 1; *p && ok; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            ok = mkdir(tmp, 0755) == 0 || errno == EEXIST;
+            *p = '/';
+        }
+    }
+
+    ok = ok && (mkdir(tmp, 0755) == 0 || errno == EEXIST);
+    free(tmp);
+    return ok;
+}
@@ -0,0 +1,13 @@
+#ifndef FS_H
+#define FS_H
+
+#include <stdbool.h>
+
+/**
+ * Create a directory and any missing parents (mode 0755)
+ * @param path Directory to create
+ * @return true if the directory exists afterwards
+ */
+bool make_dirs(const char *path);
+
+#endif /* FS_H */
@@ -0,0 +1,160 @@
+#include <string.h>
+#include "fuzzy.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Scoring follows fzf's v1 algorithm
+#define SCORE_MATCH 16
+#define SCORE_GAP_START (-3)
+#define SCORE_GAP_EXTENSION (-1)
+#define BONUS_BOUNDARY (SCORE_MATCH / 2)
+#define BONUS_NON_WORD (SCORE_MATCH / 2)
+#define BONUS_LETTER_TO_DIGIT (BONUS_BOUNDARY + SCORE_GAP_EXTENSION)
+#define BONUS_CONSECUTIVE (-(SCORE_GAP_START + SCORE_GAP_EXTENSION))
+#define BONUS_FIRST_CHAR_MULTIPLIER 2
+
+typedef enum {
+    CHAR_NON_WORD,
+    CHAR_LETTER,
+    CHAR_DIGIT
+} CharClass;
+
+void fuzzy_fold(char *dst, const char *src, size_t len) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i before_a = _mm_set1_epi8('A' - 1);
+    const __m128i after_z = _mm_set1_epi8('Z' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(src + i));
+        // Signed compares leave bytes from 0x80 up alone
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, before_a), _mm_cmplt_epi8(chunk, after_z));
+        chunk = _mm_or_si128(chunk, _mm_and_si128(upper, case_bit));
+        _mm_storeu_si128((__m128i *)(dst + i), chunk);
+    }
+#endif
+
+    for (; i < len; i++) {
+        char c = src[i];
+        dst[i] = (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
+    }
+}
+
+static int mask_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    if (c == ' ') return 36;
+    return 37 + c % 27;
+}
+
+uint64_t fuzzy_char_mask(const char *text, size_t len) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < len; i++) {
+        mask |= 1ULL << mask_bit((unsigned char)text[i]);
+    }
+    return mask;
+}
+
+void fuzzy_pattern_init(FuzzyPattern *pattern, const char *query) {
+    size_t len = strlen(query);
+    if (len > FUZZY_MAX_PATTERN) {
+        len = FUZZY_MAX_PATTERN;
+    }
+
+    fuzzy_fold(pattern->text, query, len);
+    pattern->text[len] = '\0';
+    pattern->len = len;
+    pattern->mask = fuzzy_char_mask(pattern->text, len);
+}
+
+static CharClass char_class(unsigned char c) {
+    if ((c >= 'a' && c <= 'z') || c >= 0x80) return CHAR_LETTER;
+    if (c >= '0' && c <= '9') return CHAR_DIGIT;
+    return CHAR_NON_WORD;
+}
+
+// Bonus for a match at a character given the one before it
+static int position_bonus(CharClass previous, CharClass current) {
+    if (previous == CHAR_NON_WORD && current != CHAR_NON_WORD) return BONUS_BOUNDARY;
+    if (previous == CHAR_LETTER && current == CHAR_DIGIT) return BONUS_LETTER_TO_DIGIT;
+    if (current == CHAR_NON_WORD) return BONUS_NON_WORD;
+    return 0;
+}
+
+// Score the pattern against text[start..end], where both ends are matches
+static int window_score(const FuzzyPattern *pattern, const char *text, size_t start, size_t end) {
+    int score = 0;
+    size_t p = 0;
+    bool in_gap = false;
+    int consecutive = 0;
+    int first_bonus = 0;
+    CharClass previous = start > 0 ? char_class((unsigned char)text[start - 1]) : CHAR_NON_WORD;
+
+    for (size_t i = start; i <= end; i++) {
+        CharClass current = char_class((unsigned char)text[i]);
+
+        if (p < pattern->len && text[i] == pattern->text[p]) {
+            int bonus = position_bonus(previous, current);
+            if (consecutive == 0) {
+                first_bonus = bonus;
+            } else {
+                // A run keeps the bonus of the boundary it started at
+                if (bonus >= BONUS_BOUNDARY && bonus > first_bonus) {
+                    first_bonus = bonus;
+                }
+                if (first_bonus > bonus) bonus = first_bonus;
+                if (BONUS_CONSECUTIVE > bonus) bonus = BONUS_CONSECUTIVE;
+            }
+
+            score += SCORE_MATCH + (p == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+            in_gap = false;
+            consecutive++;
+            p++;
+        } else {
+            score += in_gap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+        previous = current;
+    }
+
+    return score;
+}
+
+bool fuzzy_match(const FuzzyPattern *pattern, const char *text, size_t len,
+                 uint64_t mask, int *score) {
+    if (pattern->len == 0) {
+        *score = 0;
+        return true;
+    }
+    if ((pattern->mask & ~mask) != 0 || pattern->len > len) {
+        return false;
+    }
+
+    // Forward: the first place where the whole pattern has occurred, one memchr per character
+    size_t position = 0;
+    for (size_t p = 0; p < pattern->len; p++) {
+        const char *found = memchr(text + position, pattern->text[p], len - position);
+        if (!found) return false;
+        position = found - text + 1;
+    }
+    size_t end = position - 1;
+
+    // Backward: the latest start that still fits the pattern before end
+    size_t start = end;
+    size_t p = pattern->len;
+    for (size_t i = end + 1; i-- > 0;) {
+        if (text[i] == pattern->text[p - 1] && --p == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    *score = window_score(pattern, text, start, end);
+    return true;
+}
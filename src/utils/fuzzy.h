@@ -0,0 +1,53 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest pattern fuzzy_pattern_init accepts; longer queries are truncated
+#define FUZZY_MAX_PATTERN 255
+
+// A query prepared for matching against many candidates
+typedef struct {
+    char text[FUZZY_MAX_PATTERN + 1];  // Case-folded
+    size_t len;
+    uint64_t mask;  // fuzzy_char_mask of text
+} FuzzyPattern;
+
+/**
+ * Fold ASCII letters to lowercase, 16 bytes at a time where SSE2 is available
+ * Bytes outside A-Z, including UTF-8 sequences, are copied unchanged.
+ * @param dst Destination of len bytes (may be src)
+ * @param src Text to fold
+ * @param len Number of bytes
+ */
+void fuzzy_fold(char *dst, const char *src, size_t len);
+
+/**
+ * Bitmask of the characters present in folded text
+ * Letters, digits and space get a bit each, other bytes share the rest.
+ * A candidate can only match if it has every bit of the pattern's mask.
+ */
+uint64_t fuzzy_char_mask(const char *text, size_t len);
+
+// Fold a query and compute its mask
+void fuzzy_pattern_init(FuzzyPattern *pattern, const char *query);
+
+/**
+ * Match a pattern as a subsequence of a candidate and score the match
+ * Like fzf, the shortest window ending at the first complete match is
+ * scored: consecutive characters and characters at word starts score
+ * higher, gaps cost a little. The mask check rejects most candidates
+ * before any scanning.
+ * @param pattern Prepared query
+ * @param text Folded candidate
+ * @param len Length of text
+ * @param mask fuzzy_char_mask of text
+ * @param score Receives the score when matched (higher is better)
+ * @return true if every pattern character occurs in order in text
+ */
+bool fuzzy_match(const FuzzyPattern *pattern, const char *text, size_t len,
+                 uint64_t mask, int *score);
+
+#endif /* FUZZY_H */
@@ -1,9 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include "memory.h"
 
+// Per thread, so concurrent provider calls can be measured separately
+static __thread long allocation_count = 0;
+
 void* safe_malloc(size_t size) {
+    allocation_count++;
     void *ptr = malloc(size);
     if (!ptr) {
         fprintf(stderr, "Memory allocation failed\n");
@@ -15,10 +20,137 @@ void* safe_malloc(size_t size) {
 char* safe_strdup(const char *str) {
     if (!str) return NULL;
     
+    allocation_count++;
     char *dup = strdup(str);
     if (!dup) {
         fprintf(stderr, "Memory allocation failed in strdup\n");
         exit(EXIT_FAILURE);
     }
     return dup;
+}
+
+long memory_allocation_count() {
+    return allocation_count;
+}
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} ArenaBlock;
+
+typedef struct ArenaCleanup {
+    struct ArenaCleanup *next;
+    void (*run)(void *ctx);
+    void *ctx;
+} ArenaCleanup;
+
+struct Arena {
+    ArenaBlock *blocks;      // Current block first
+    size_t next_block_size;
+    ArenaCleanup *cleanups;  // Most recently deferred first
+};
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+static ArenaBlock* arena_new_block(size_t size) {
+    ArenaBlock *block = safe_malloc(sizeof(ArenaBlock) + size);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+Arena* arena_create(size_t block_size) {
+    if (block_size == 0) block_size = ARENA_DEFAULT_BLOCK_SIZE;
+    if (block_size < ARENA_ALIGN(sizeof(Arena))) block_size = ARENA_ALIGN(sizeof(Arena));
+
+    ArenaBlock *block = arena_new_block(block_size);
+    Arena *arena = (Arena *)block->data;
+    block->used = sizeof(Arena);
+
+    arena->blocks = block;
+    arena->cleanups = NULL;
+    arena->next_block_size = block_size < ARENA_MAX_BLOCK_SIZE ? block_size * 2 : block_size;
+    return arena;
+}
+
+// Strings are packed byte-aligned; everything else is aligned for any type
+static void* arena_bump(Arena *arena, size_t size, size_t alignment) {
+    ArenaBlock *current = arena->blocks;
+    size_t offset = (current->used + alignment - 1) & ~(alignment - 1);
+    if (offset <= current->size && current->size - offset >= size) {
+        current->used = offset + size;
+        return (char *)current->data + offset;
+    }
+
+    // Oversized requests get a block of their own behind the current one,
+    // so the space left in the current block is not abandoned
+    if (size > arena->next_block_size / 4) {
+        ArenaBlock *block = arena_new_block(size);
+        block->used = size;
+        block->next = current->next;
+        current->next = block;
+        return block->data;
+    }
+
+    ArenaBlock *block = arena_new_block(arena->next_block_size);
+    if (arena->next_block_size < ARENA_MAX_BLOCK_SIZE) {
+        arena->next_block_size *= 2;
+    }
+    block->next = current;
+    arena->blocks = block;
+
+    block->used = size;
+    return block->data;
+}
+
+void* arena_alloc(Arena *arena, size_t size) {
+    return arena_bump(arena, size, ARENA_ALIGNMENT);
+}
+
+void* arena_calloc(Arena *arena, size_t count, size_t size) {
+    if (size && count > (size_t)-1 / size) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    void *ptr = arena_bump(arena, count * size, ARENA_ALIGNMENT);
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+char* arena_strdup(Arena *arena, const char *str) {
+    if (!str) return NULL;
+
+    size_t len = strlen(str) + 1;
+    char *dup = arena_bump(arena, len, 1);
+    memcpy(dup, str, len);
+    return dup;
+}
+
+void arena_defer(Arena *arena, void (*cleanup)(void *ctx), void *ctx) {
+    ArenaCleanup *entry = arena_alloc(arena, sizeof(ArenaCleanup));
+    entry->run = cleanup;
+    entry->ctx = ctx;
+    entry->next = arena->cleanups;
+    arena->cleanups = entry;
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) return;
+
+    for (ArenaCleanup *entry = arena->cleanups; entry; entry = entry->next) {
+        entry->run(entry->ctx);
+    }
+
+    // The header is only read before the walk, so freeing its block along the way is fine
+    ArenaBlock *block = arena->blocks;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
 }
\ No newline at end of file
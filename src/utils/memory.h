@@ -9,4 +9,42 @@ void* safe_malloc(size_t size);
 // Safe string duplication
 char* safe_strdup(const char *str);
 
+// Number of allocations made through these helpers on the calling thread
+long memory_allocation_count();
+
+// Bump allocator for data that is built once and released as a whole
+typedef struct Arena Arena;
+
+// Size of an arena's first block; later blocks double up to ARENA_MAX_BLOCK_SIZE
+#define ARENA_DEFAULT_BLOCK_SIZE 4096
+#define ARENA_MAX_BLOCK_SIZE (256 * 1024)
+
+/**
+ * Create an arena
+ * The arena header lives in its first block, so an empty arena costs one malloc.
+ * Like safe_malloc, running out of memory terminates the program.
+ * @param block_size Size of the first block (0 for ARENA_DEFAULT_BLOCK_SIZE)
+ * @return The arena (release with arena_destroy)
+ */
+Arena* arena_create(size_t block_size);
+
+// Allocate uninitialised memory aligned for any type; valid until arena_destroy
+void* arena_alloc(Arena *arena, size_t size);
+
+// Allocate zeroed memory for count elements of size bytes
+void* arena_calloc(Arena *arena, size_t count, size_t size);
+
+// Copy a string into the arena (NULL stays NULL)
+char* arena_strdup(Arena *arena, const char *str);
+
+/**
+ * Run a cleanup when the arena is destroyed
+ * Lets an arena own outside resources, such as a retained response buffer
+ * its strings point into. Cleanups run in reverse order of registration.
+ */
+void arena_defer(Arena *arena, void (*cleanup)(void *ctx), void *ctx);
+
+// Run the deferred cleanups, then release every block and with them everything allocated from the arena
+void arena_destroy(Arena *arena);
+
 #endif /* MEMORY_H */
\ No newline at end of file
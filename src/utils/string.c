@@ -22,6 +22,40 @@ char* case_insensitive_strstr(const char *haystack, const char *needle) {
     return NULL;
 }
 
+char* normalize_title(const char *title) {
+    if (!title) return NULL;
+    
+    char *normalized = safe_malloc(strlen(title) + 1);
+    size_t pos = 0;
+    bool separator = false;
+    
+    for (const unsigned char *p = (const unsigned char *)title; *p; p++) {
+        // Bytes of non-ASCII characters are kept, so titles in other scripts stay distinct
+        if (isalnum(*p) || *p >= 0x80) {
+            // Collapse punctuation and whitespace runs into one space
+            if (separator && pos > 0) {
+                normalized[pos++] = ' ';
+            }
+            normalized[pos++] = tolower(*p);
+            separator = false;
+        } else {
+            separator = true;
+        }
+    }
+    
+    normalized[pos] = '\0';
+    return normalized;
+}
+
+uint64_t string_hash(const char *str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 char* url_encode(const char *str) {
     if (!str) return NULL;
     
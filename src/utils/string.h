@@ -2,10 +2,18 @@
 #define STRING_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 // Case-insensitive string search
 char* case_insensitive_strstr(const char *haystack, const char *needle);
 
+// Normalise a title for duplicate detection: lowercase alphanumerics and
+// non-ASCII characters separated by single spaces (must be freed)
+char* normalize_title(const char *title);
+
+// 64-bit FNV-1a hash of a string
+uint64_t string_hash(const char *str);
+
 // URL encode a string
 char* url_encode(const char *str);
 
@@ -0,0 +1,70 @@
+// cache_fallback.c - Serve the stale cached answer when the server errors
+//
+// Run through `make cache-test`, which starts tests/mock/mock_server.py with
+// --fail-after so the search URL below answers once and then returns 503,
+// and points XDG_CACHE_HOME at an empty directory. The first fetch fills the
+// cache, the second one finds it stale and must fall back to it instead of
+// handing out the error; without the cache the error must come through.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <json-c/json.h>
+#include "../src/config.h"
+#include "../src/api/api.h"
+#include "../src/api/http.h"
+
+#define CACHE_TEST_TTL_SECONDS 1
+#define CACHE_TEST_STALE_MS 1100
+
+static bool check(bool ok, const char *what) {
+    printf("%s: %s\n", ok ? "ok" : "FAILED", what);
+    return ok;
+}
+
+// Same answer both times, compared by its serialized form
+static bool same_json(struct json_object *a, struct json_object *b) {
+    return a && b && strcmp(json_object_to_json_string(a), json_object_to_json_string(b)) == 0;
+}
+
+int main() {
+    const char *base = getenv("ANIWATCH_API_BASE_URL");
+    if (!base) {
+        fprintf(stderr, "ANIWATCH_API_BASE_URL is not set; run through `make cache-test`\n");
+        return EXIT_FAILURE;
+    }
+
+    config_init();
+    app_config.cache_enabled = true;
+    api_init();
+
+    char cached_url[512], uncached_url[512];
+    snprintf(cached_url, sizeof(cached_url), "%s/api/v2/hianime/search?q=stale-cache", base);
+    snprintf(uncached_url, sizeof(uncached_url), "%s/api/v2/hianime/search?q=no-cache", base);
+
+    bool passed = true;
+    struct json_object *first = NULL, *second = NULL, *error = NULL;
+
+    passed &= check(http_get_json(cached_url, CACHE_TEST_TTL_SECONDS, &first) && first,
+                    "first fetch answers and fills the cache");
+
+    struct timespec ts = { CACHE_TEST_STALE_MS / 1000, (CACHE_TEST_STALE_MS % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+
+    passed &= check(http_get_json(cached_url, CACHE_TEST_TTL_SECONDS, &second) && same_json(first, second),
+                    "503 on a stale entry serves the cached answer");
+
+    http_get_json(uncached_url, 0, &error);  // Answered once, like the cached URL
+    if (error) json_object_put(error);
+    error = NULL;
+    passed &= check(!http_get_json(uncached_url, 0, &error) && !error,
+                    "503 without a cached answer fails");
+
+    if (first) json_object_put(first);
+    if (second) json_object_put(second);
+    if (error) json_object_put(error);
+    api_cleanup();
+    config_cleanup();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
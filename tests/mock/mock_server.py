@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""Local stand-in for the AniWatch (hianime) and consumet APIs.
+
+Replays the JSON fixtures in tests/mock/fixtures for every endpoint the
+providers call, plus the images, subtitles and HLS playlists those fixtures
+point at. Latency, jitter, bandwidth caps and errors can be injected so the
+real provider code can be benchmarked offline.
+
+Point the client at it with:
+
+    ANIWATCH_API_BASE_URL=http://127.0.0.1:8731
+    ZORO_API_BASE_URL=http://127.0.0.1:8731/anime/zoro
+    MANGADEX_API_BASE_URL=http://127.0.0.1:8731/manga/mangadex
+
+With --record, requests are forwarded to the real API once and the answers
+are stored as the fixtures for later runs.
+"""
+
+import argparse
+import hashlib
+import os
+import random
+import re
+import sys
+import threading
+import time
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlsplit
+
+FIXTURE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures")
+CHUNK_SIZE = 16384
+
+# (path pattern, fixture, upstream family); first match wins
+ROUTES = [
+    (r"^/api/v2/hianime/search$", "hianime_search.json", "aniwatch"),
+    (r"^/api/v2/hianime/anime/[^/]+/episodes$", "hianime_episodes.json", "aniwatch"),
+    (r"^/api/v2/hianime/anime/[^/]+$", "hianime_info.json", "aniwatch"),
+    (r"^/api/v2/hianime/episode/sources$", "hianime_sources.json", "aniwatch"),
+    (r"^/anime/zoro/info$", "zoro_info.json", "consumet"),
+    (r"^/anime/zoro/watch$", "zoro_watch.json", "consumet"),
+    (r"^/anime/zoro/[^/]+$", "zoro_search.json", "consumet"),
+    (r"^/manga/mangadex/info/[^/]+$", "mangadex_info.json", "consumet"),
+    (r"^/manga/mangadex/read/[^/]+$", "mangadex_read.json", "consumet"),
+    (r"^/manga/mangadex/[^/]+$", "mangadex_search.json", "consumet"),
+]
+
+
+def parse_pairs(values, convert):
+    pairs = []
+    for value in values or []:
+        key, sep, amount = value.rpartition("=")
+        if not sep:
+            raise SystemExit(f"expected PATTERN=VALUE, got {value!r}")
+        pairs.append((key, convert(amount)))
+    return pairs
+
+
+def synthetic_bytes(name, size):
+    """Deterministic filler so repeated runs transfer identical bodies."""
+    seed = hashlib.sha256(name.encode()).digest()
+    return (seed * (size // len(seed) + 1))[:size]
+
+
+class MockHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "anime-cli-mock/1"
+
+    # Headers and body go out in separate writes; don't let Nagle hold the body back
+    disable_nagle_algorithm = True
+
+    def log_message(self, fmt, *args):
+        if self.server.options.verbose:
+            sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    # Fault injection
+
+    def injected_delay(self):
+        options = self.server.options
+        delay = options.latency
+        if options.jitter:
+            delay += self.server.random.uniform(-options.jitter, options.jitter)
+        for pattern, extra in options.slow:
+            if pattern in self.path:
+                delay += extra
+        return max(delay, 0) / 1000.0
+
+    def injected_failure(self):
+        """Return an error status, 0 to drop the connection, or None."""
+        options = self.server.options
+        for pattern in options.fail:
+            if pattern in self.path:
+                return options.error_status
+        for pattern, allowed in options.fail_after:
+            if pattern in self.path:
+                with self.server.served_lock:
+                    served = self.server.served.get(pattern, 0)
+                    self.server.served[pattern] = served + 1
+                if served >= allowed:
+                    return options.error_status
+        roll = self.server.random.random()
+        if roll < options.drop_rate:
+            return 0
+        if roll < options.drop_rate + options.error_rate:
+            return options.error_status
+        return None
+
+    # Responses
+
+    def send_body(self, status, body, content_type):
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+
+        bandwidth = self.server.options.bandwidth
+        if not bandwidth:
+            self.wfile.write(body)
+            return
+
+        # Paced in chunks so slow links look like slow links to curl
+        started = time.monotonic()
+        for offset in range(0, len(body), CHUNK_SIZE):
+            self.wfile.write(body[offset:offset + CHUNK_SIZE])
+            self.wfile.flush()
+            due = started + (offset + CHUNK_SIZE) / bandwidth
+            pause = due - time.monotonic()
+            if pause > 0:
+                time.sleep(pause)
+
+    def send_error_status(self, status):
+        body = b'{"success":false,"message":"injected error"}'
+        self.send_body(status, body, "application/json")
+
+    def base_url(self):
+        host = self.headers.get("Host") or "%s:%d" % self.server.server_address[:2]
+        return "http://" + host
+
+    def fixture(self, name, family):
+        path = os.path.join(FIXTURE_DIR, name)
+        upstream = self.server.options.record.get(family)
+        if upstream:
+            return self.record(path, upstream)
+
+        with open(path, "rb") as f:
+            body = f.read()
+        return body.replace(b"{{BASE}}", self.base_url().encode())
+
+    def record(self, path, upstream):
+        request = urllib.request.Request(upstream.rstrip("/") + self.path,
+                                         headers={"User-Agent": "anime-cli-mock/1"})
+        with urllib.request.urlopen(request, timeout=30) as response:
+            body = response.read()
+        with self.server.record_lock, open(path, "wb") as f:
+            f.write(body)
+        return body
+
+    def hls(self, path):
+        options = self.server.options
+        if path.endswith("/master.m3u8"):
+            variant = path.rsplit("/", 1)[0] + "/index.m3u8"
+            return ("#EXTM3U\n#EXT-X-STREAM-INF:BANDWIDTH=2000000,RESOLUTION=1280x720\n%s\n"
+                    % variant).encode(), "application/vnd.apple.mpegurl"
+        if path.endswith("/index.m3u8"):
+            lines = ["#EXTM3U", "#EXT-X-VERSION:3", "#EXT-X-TARGETDURATION:4",
+                     "#EXT-X-MEDIA-SEQUENCE:0"]
+            for i in range(options.segments):
+                lines.append("#EXTINF:4.000,")
+                lines.append("seg-%03d.ts" % i)
+            lines.append("#EXT-X-ENDLIST")
+            return ("\n".join(lines) + "\n").encode(), "application/vnd.apple.mpegurl"
+        if path.endswith(".ts"):
+            return synthetic_bytes(path, options.segment_size), "video/mp2t"
+        return None, None
+
+    def do_GET(self):
+        path = urlsplit(self.path).path
+
+        if path == "/health":
+            self.send_body(200, b"ok\n", "text/plain")
+            return
+
+        time.sleep(self.injected_delay())
+
+        failure = self.injected_failure()
+        if failure == 0:
+            self.close_connection = True
+            self.connection.shutdown(2)
+            return
+        if failure is not None:
+            self.send_error_status(failure)
+            return
+
+        for pattern, name, family in ROUTES:
+            if re.match(pattern, path):
+                try:
+                    body = self.fixture(name, family)
+                except (OSError, ValueError) as e:
+                    self.log_message("fixture %s unavailable: %s", name, e)
+                    self.send_error_status(502)
+                    return
+                self.send_body(200, body, "application/json")
+                return
+
+        if path.startswith("/images/"):
+            body = b"\xff\xd8\xff\xe0" + synthetic_bytes(path, self.server.options.image_size - 4)
+            self.send_body(200, body, "image/jpeg")
+            return
+
+        if path.startswith("/subs/"):
+            body = b"WEBVTT\n\n00:00:01.000 --> 00:00:04.000\nMock subtitle\n"
+            self.send_body(200, body, "text/vtt")
+            return
+
+        if path.startswith("/hls/"):
+            body, content_type = self.hls(path)
+            if body is not None:
+                self.send_body(200, body, content_type)
+                return
+
+        self.send_body(404, b'{"message":"not found"}', "application/json")
+
+
+def wait_for_server(host, port, timeout):
+    """Poll /health until a server on host:port answers; False after timeout seconds."""
+    url = "http://%s:%d/health" % (host, port)
+    opener = urllib.request.build_opener(urllib.request.ProxyHandler({}))
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            with opener.open(url, timeout=1) as response:
+                if response.status == 200:
+                    return True
+        except OSError:
+            pass
+        time.sleep(0.05)
+    return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8731)
+    parser.add_argument("--latency", type=float, default=0, help="delay before every response, ms")
+    parser.add_argument("--jitter", type=float, default=0, help="uniform +/- variation of the delay, ms")
+    parser.add_argument("--bandwidth", type=float, default=0, help="per-response cap, bytes/s (0 = unlimited)")
+    parser.add_argument("--error-rate", type=float, default=0, help="fraction of requests answered with --error-status")
+    parser.add_argument("--error-status", type=int, default=503)
+    parser.add_argument("--drop-rate", type=float, default=0, help="fraction of connections closed without a response")
+    parser.add_argument("--slow", action="append", metavar="PATTERN=MS",
+                        help="extra delay for requests whose path contains PATTERN (repeatable)")
+    parser.add_argument("--fail", action="append", default=[], metavar="PATTERN",
+                        help="always fail requests whose path contains PATTERN (repeatable)")
+    parser.add_argument("--fail-after", action="append", metavar="PATTERN=N",
+                        help="answer the first N requests whose path contains PATTERN, fail the rest (repeatable)")
+    parser.add_argument("--image-size", type=int, default=150000, help="bytes per image")
+    parser.add_argument("--segments", type=int, default=60, help="HLS segments per episode")
+    parser.add_argument("--segment-size", type=int, default=200000, help="bytes per HLS segment")
+    parser.add_argument("--record", action="append", metavar="FAMILY=URL",
+                        help="forward aniwatch or consumet requests to URL and store the fixtures")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--verbose", action="store_true")
+    parser.add_argument("--wait", type=float, metavar="SECONDS",
+                        help="do not serve: wait for a server already starting on --port, then exit")
+    options = parser.parse_args()
+
+    if options.wait is not None:
+        if wait_for_server(options.host, options.port, options.wait):
+            return
+        sys.exit("mock server on port %d did not come up within %gs" % (options.port, options.wait))
+
+    options.slow = parse_pairs(options.slow, float)
+    options.record = dict(parse_pairs(options.record, str))
+    options.fail_after = parse_pairs(options.fail_after, int)
+
+    server = ThreadingHTTPServer((options.host, options.port), MockHandler)
+    server.daemon_threads = True
+    server.options = options
+    server.random = random.Random(options.seed)
+    server.record_lock = threading.Lock()
+    server.served = {}
+    server.served_lock = threading.Lock()
+
+    print("mock server listening on http://%s:%d" % server.server_address[:2], flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,215 @@
+// stress_providers.c - Hammer every provider from many threads at once
+//
+// Run through `make stress`, which builds this and the API layer with
+// ThreadSanitizer, starts tests/mock/mock_server.py and points the
+// *_API_BASE_URL variables at it. Each thread walks every provider in turn:
+// search, info with its lazily loaded list, then a stream race or a chapter's
+// pages. Any data race aborts the run; a failed flow makes it exit non-zero.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
+#include "../src/config.h"
+#include "../src/api/api.h"
+#include "../src/api/anime.h"
+#include "../src/api/manga.h"
+#include "../src/api/http.h"
+#include "../src/api/stream_race.h"
+
+#define STRESS_DEFAULT_THREADS 8
+#define STRESS_DEFAULT_ITERATIONS 5
+#define STRESS_SERVER_WAIT_MS 5000
+#define STRESS_LIST_WAIT_MS 100
+
+typedef struct {
+    int index;
+    int iterations;
+    int flows;
+    int failures;
+} StressThread;
+
+// Wait until the mock server answers its health check
+static bool wait_for_server() {
+    const char *base = getenv("ANIWATCH_API_BASE_URL");
+    if (!base) {
+        fprintf(stderr, "ANIWATCH_API_BASE_URL is not set; run through `make stress`\n");
+        return false;
+    }
+
+    char url[512];
+    snprintf(url, sizeof(url), "%s/health", base);
+
+    for (int waited = 0; waited < STRESS_SERVER_WAIT_MS; waited += 100) {
+        HttpResponse response;
+        bool ok = http_get(url, &response);
+        long status = response.status_code;
+        http_response_free(&response);
+        if (ok && status == 200) {
+            return true;
+        }
+
+        struct timespec ts = { 0, 100 * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+
+    fprintf(stderr, "Mock server at %s did not come up\n", base);
+    return false;
+}
+
+// Let a list that loads on the pool finish, as the list screens do
+static void wait_for_list(int (*fd)(const void *info), bool (*loading)(const void *info),
+                          bool (*update)(void *info), void *info) {
+    while (loading(info)) {
+        struct pollfd pfd = { .fd = fd(info), .events = POLLIN, .revents = 0 };
+        poll(&pfd, 1, STRESS_LIST_WAIT_MS);
+        update(info);
+    }
+    update(info);
+}
+
+static int anime_fd(const void *info) { return anime_info_fd(info); }
+static bool anime_loading(const void *info) { return anime_info_loading(info); }
+static bool anime_update(void *info) { return anime_info_update(info); }
+static int manga_fd(const void *info) { return manga_info_fd(info); }
+static bool manga_loading(const void *info) { return manga_info_loading(info); }
+static bool manga_update(void *info) { return manga_info_update(info); }
+
+// Search, open a result with its episode list and race its streams
+static bool anime_flow(ProviderType provider, int pick) {
+    const ProviderAPI *api = get_provider_api(provider);
+
+    SearchResult *results = api->search("naruto");
+    if (!results || results->total_results == 0) {
+        if (results) api->free_search_results(results);
+        return false;
+    }
+
+    const char *id = results->results[pick % results->total_results].id;
+    AnimeInfo *info = api->open_anime_info ? api->open_anime_info(id) : api->get_anime_info(id);
+    api->free_search_results(results);
+    if (!info) {
+        return false;
+    }
+    wait_for_list(anime_fd, anime_loading, anime_update, info);
+
+    bool ok = info->total_episodes > 0;
+    if (ok) {
+        StreamInfo *stream = stream_race_resolve(provider, info->episodes[pick % info->total_episodes].id);
+        ok = stream && stream->sources_count > 0;
+        if (stream) api->free_stream_info(stream);
+    }
+    api->free_anime_info(info);
+    return ok;
+}
+
+// Search, open a result with its chapter list and list a chapter's pages
+static bool manga_flow(ProviderType provider, int pick) {
+    const ProviderAPI *api = get_provider_api(provider);
+
+    SearchResult *results = api->search("one piece");
+    if (!results || results->total_results == 0) {
+        if (results) api->free_search_results(results);
+        return false;
+    }
+
+    const char *id = results->results[pick % results->total_results].id;
+    MangaInfo *info = api->open_manga_info ? api->open_manga_info(id) : api->get_manga_info(id);
+    api->free_search_results(results);
+    if (!info) {
+        return false;
+    }
+    wait_for_list(manga_fd, manga_loading, manga_update, info);
+
+    bool ok = info->total_chapters > 0;
+    if (ok) {
+        ChapterPages *pages = api->get_chapter_pages(info->chapters[pick % info->total_chapters].id);
+        ok = pages && pages->page_count > 0;
+        if (pages) api->free_chapter_info(pages);
+    }
+    api->free_manga_info(info);
+    return ok;
+}
+
+static void* stress_thread(void *arg) {
+    StressThread *thread = arg;
+
+    for (int i = 0; i < thread->iterations; i++) {
+        // Threads start on different providers so every pair overlaps
+        for (int p = 0; p < PROVIDER_COUNT; p++) {
+            ProviderType provider = (thread->index + p) % PROVIDER_COUNT;
+            int pick = thread->index + i;
+            bool ok = provider_supports_content(provider, CONTENT_ANIME) ?
+                      anime_flow(provider, pick) : manga_flow(provider, pick);
+
+            thread->flows++;
+            if (!ok) {
+                thread->failures++;
+                fprintf(stderr, "thread %d: %s flow failed\n", thread->index,
+                        provider_type_to_string(provider));
+            }
+        }
+    }
+
+    http_thread_cleanup();
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : STRESS_DEFAULT_THREADS;
+    int iterations = argc > 2 ? atoi(argv[2]) : STRESS_DEFAULT_ITERATIONS;
+    if (threads <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [threads] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Every call must reach the server, not the response cache
+    config_init();
+    app_config.cache_enabled = false;
+    api_init();
+
+    if (!wait_for_server()) {
+        api_cleanup();
+        config_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    StressThread *states = calloc(threads, sizeof(StressThread));
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    if (!states || !ids) {
+        fprintf(stderr, "Failed to allocate stress threads\n");
+        free(states);
+        free(ids);
+        api_cleanup();
+        config_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    int started = 0;
+    for (; started < threads; started++) {
+        states[started].index = started;
+        states[started].iterations = iterations;
+        if (pthread_create(&ids[started], NULL, stress_thread, &states[started]) != 0) {
+            fprintf(stderr, "Failed to start stress thread %d\n", started);
+            break;
+        }
+    }
+
+    int flows = 0;
+    int failures = started < threads ? 1 : 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        flows += states[i].flows;
+        failures += states[i].failures;
+    }
+
+    printf("%d threads, %d flows, %d failed\n", started, flows, failures);
+
+    free(states);
+    free(ids);
+    api_cleanup();
+    config_cleanup();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}